@@ -0,0 +1,65 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include "cached_layer.h"
+
+#include <cinder/app/App.h>
+#include <cinder/gl/draw.h>
+#include <cinder/gl/gl.h>
+#include <cinder/gl/scoped.h>
+
+#include <sudoku/profiler.h>
+
+#include <functional>
+#include <string>
+
+namespace myapp {
+
+namespace {
+
+// Same multisampling as the window, so the cached layer looks the same as
+// drawing it directly
+const int kSamples = 8;
+
+}  // namespace
+
+CachedLayer::CachedLayer() : is_valid_{false} {}
+
+void CachedLayer::Draw(const std::string& key,
+                       const std::function<void()>& render) {
+  const ci::ivec2 window_size = ci::app::getWindowSize();
+  const ci::ivec2 pixel_size = ci::app::toPixels(window_size);
+
+  if (!fbo_ || fbo_->getSize() != pixel_size) {
+    fbo_ = ci::gl::Fbo::create(pixel_size.x, pixel_size.y,
+                               ci::gl::Fbo::Format().samples(kSamples));
+    is_valid_ = false;
+  }
+
+  if (!is_valid_ || key != key_ || window_size != window_size_) {
+    ci::gl::ScopedFramebuffer framebuffer(fbo_);
+    ci::gl::ScopedViewport viewport(ci::ivec2(0, 0), pixel_size);
+    ci::gl::ScopedMatrices matrices;
+    ci::gl::setMatricesWindow(window_size);
+
+    render();
+
+    key_ = key;
+    window_size_ = window_size;
+    is_valid_ = true;
+  }
+
+  // Leave the depth buffer alone so whatever is drawn over the layer
+  // isn't hidden behind it
+  ci::gl::ScopedDepthWrite depth_write(false);
+  ci::gl::color(ci::Color::white());
+  ci::gl::draw(fbo_->getColorTexture(),
+               ci::Rectf(0, 0, static_cast<float>(window_size.x),
+                         static_cast<float>(window_size.y)));
+  sudoku::CountDrawCall();
+}
+
+void CachedLayer::Invalidate() {
+  is_valid_ = false;
+}
+
+}  // namespace myapp
@@ -0,0 +1,38 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_CACHED_LAYER_H_
+#define FINALPROJECT_APPS_CACHED_LAYER_H_
+
+#include <cinder/Vector.h>
+#include <cinder/gl/Fbo.h>
+
+#include <functional>
+#include <string>
+
+namespace myapp {
+
+// Part of the screen drawn once into a window sized texture, then redrawn
+// from it as one textured quad. `key` describes everything the layer shows,
+// so it's only drawn again when the key or the window's size changes
+class CachedLayer {
+ public:
+  CachedLayer();
+
+  // Draw the layer, first rendering it with `render` if it's out of date.
+  // `render` draws in window coordinates, as if drawing straight to the
+  // window
+  void Draw(const std::string& key, const std::function<void()>& render);
+
+  // Render the layer again next time, whatever the key
+  void Invalidate();
+
+ private:
+  ci::gl::FboRef fbo_;
+  std::string key_;
+  ci::ivec2 window_size_;
+  bool is_valid_;
+};
+
+}  // namespace myapp
+
+#endif  // FINALPROJECT_APPS_CACHED_LAYER_H_
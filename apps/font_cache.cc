@@ -0,0 +1,45 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include "font_cache.h"
+
+#include <cmath>
+
+namespace myapp {
+
+ci::Font FontCache::Get(const std::string& face, float size) {
+  const Key key(face, static_cast<int>(std::lround(size)));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto font = fonts_.find(key);
+  if (font == fonts_.end()) {
+    font = fonts_.emplace(key, ci::Font(face,
+                                        static_cast<float>(key.second))).first;
+  }
+
+  // Fonts are handles to the loaded face, so copies are cheap
+  return font->second;
+}
+
+void FontCache::Preload(const std::string& face,
+                        const std::vector<float>& sizes) {
+  for (float size : sizes) {
+    Get(face, size);
+  }
+}
+
+void FontCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  fonts_.clear();
+}
+
+size_t FontCache::GetSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fonts_.size();
+}
+
+FontCache& GetFontCache() {
+  static FontCache font_cache;
+  return font_cache;
+}
+
+}  // namespace myapp
@@ -0,0 +1,45 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_FONT_CACHE_H_
+#define FINALPROJECT_APPS_FONT_CACHE_H_
+
+#include <cinder/Font.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace myapp {
+
+// Fonts already looked up, by face and size. Making a ci::Font goes through
+// the system's font lookup and loads the face, so the text drawing code gets
+// its fonts from here instead of making one for every string it prints
+class FontCache {
+ public:
+  // The font, loading it the first time it's asked for. Sizes are rounded
+  // to whole pixels, so sizes that would look the same share a font
+  ci::Font Get(const std::string& face, float size);
+
+  // Load fonts ahead of the first frame that needs them
+  void Preload(const std::string& face, const std::vector<float>& sizes);
+
+  // Drop every font, e.g. once the sizes in use have changed
+  void Clear();
+
+  size_t GetSize() const;
+
+ private:
+  using Key = std::pair<std::string, int>;
+
+  mutable std::mutex mutex_;
+  std::map<Key, ci::Font> fonts_;
+};
+
+// The font cache for the whole app
+FontCache& GetFontCache();
+
+}  // namespace myapp
+
+#endif  // FINALPROJECT_APPS_FONT_CACHE_H_
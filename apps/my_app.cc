@@ -5,20 +5,45 @@
 #include <cinder/Font.h>
 #include <cinder/ImageIo.h>
 #include <cinder/Path2d.h>
+#include <cinder/Surface.h>
 #include <cinder/Text.h>
 #include <cinder/Vector.h>
 #include <cinder/app/App.h>
 
+#include <cinder/gl/Fbo.h>
 #include <cinder/gl/Texture.h>
 #include <cinder/gl/draw.h>
 #include <cinder/gl/gl.h>
+#include <cinder/gl/scoped.h>
 
+#include <sudoku/board_bank.h>
+#include <sudoku/daily_challenge.h>
 #include <sudoku/engine.h>
+#include <sudoku/layout.h>
+#include <sudoku/leaderboard_client.h>
+#include <sudoku/profiler.h>
+#include <sudoku/sharded_leaderboard.h>
 #include <sudoku/utils.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
+#include <future>
+#include <memory>
+
+#include "font_cache.h"
 
 const char kDbPath[] = "leaderboard.db";
+const char kSnapshotName[] = "autosave.snapshot";
+const char kTraceName[] = "profile.json";
+
+// When the app was launched, for timing how long startup takes
+const auto kLaunchTime = sudoku::Profiler::Clock::now();
+
+// The board with the most empty boxes, so the most to pencil in
+const char kBenchmarkBoard[] = "hard_2.json";
 
 namespace myapp {
 
@@ -34,54 +59,144 @@ using sudoku::DrawBox;
 using sudoku::DrawLine;
 using sudoku::GetMiddleOfBox;
 using sudoku::IsMouseInBox;
+using sudoku::ScopedTimer;
+
+namespace {
+
+// Whether an asset loading on a worker thread is ready to be taken, waiting
+// for it if `wait` is true. False once it's been taken
+template <typename T>
+bool IsLoaded(std::future<T>* loading, bool wait) {
+  if (!loading->valid()) {
+    return false;
+  }
+
+  if (wait) {
+    loading->wait();
+    return true;
+  }
+
+  return loading->wait_for(std::chrono::seconds(0))
+         == std::future_status::ready;
+}
+
+// The address given with --leaderboard-server ADDRESS, if any
+bool GetLeaderBoardServer(const vector<string>& args,
+                          sudoku::LeaderBoardAddress* address) {
+  for (size_t i = 1; i + 1 < args.size(); i++) {
+    if (args[i] != "--leaderboard-server") {
+      continue;
+    }
+
+    if (sudoku::ParseLeaderBoardAddress(args[i + 1], address)) {
+      return true;
+    }
+    ci::app::console() << "Bad leaderboard server address " << args[i + 1]
+                       << ", using the local leaderboard" << std::endl;
+  }
+
+  return false;
+}
+
+}  // namespace
 
 const size_t kRegTextSize = 30;
 const size_t kBigTextSize = 50;
 
+const char kFontFace[] = "Arial";
+
+// Every size text is printed at other than pencil marks, which scale with
+// the board's boxes, so the fonts are loaded before they're drawn
+const float kTextSizes[] = {16, 20, kRegTextSize, 40, kBigTextSize, 60, 100};
+
 MyApp::MyApp()
     : state_{AppState::kMenu},
     mouse_pos_{ci::vec2(-1, -1)},
-    win_center_{getWindowCenter()},
+    win_center_{layout_.GetCenter()},
     sel_box_{-1, -1},
-    leaderboard_{cinder::app::getAssetPath(kDbPath).string()},
+    leaderboard_window_{sudoku::LeaderBoardWindow::kAllTime},
+    has_submitted_time_{false},
     want_instructions_{true},
     is_entering_name_{true},
     player_name_{""},
-    game_modes_{{"Standard", "Time Trial", "Time Attack"}}
+    snapshot_path_{(cinder::app::getAppPath() / kSnapshotName).string()},
+    want_profiler_overlay_{false},
+    trace_path_{(cinder::app::getAppPath() / kTraceName).string()},
+    game_modes_{{"Standard", "Time Trial", "Time Attack", "Daily Challenge"}},
+    is_first_frame_{true},
+    has_loaded_assets_{false}
     {}
 
 void MyApp::setup() {
   ci::gl::enableDepthWrite();
   ci::gl::enableDepthRead();
 
+  StartLoadingAssets();
+  resize();
+
   SetupMenu();
   SetupGameScreen();
   SetupGameOver();
+
+  RenderBenchmarkOptions benchmark_options;
+  if (ParseRenderBenchmarkArgs(getCommandLineArgs(), &benchmark_options)) {
+    StartRenderBenchmark(benchmark_options);
+    return;
+  }
+
+  // Pick up where the last session left off if a game was in progress
+  if (engine_.LoadSnapshot(snapshot_path_)) {
+    state_ = AppState::kPlaying;
+  }
 }
 
-void MyApp::update() {
-  mouse_pos_ = getMousePos() - getWindowPos();
+void MyApp::resize() {
+  const float old_scale = layout_.GetPixelScale();
+  layout_.Resize(getWindowSize(), getWindowContentScale());
 
-  if (state_ == AppState::kPlaying) {
-    engine_.UpdateGameTime();
+  // Text is rendered at the pixel scale, so the fonts it needs change with it
+  if (GetFontCache().GetSize() == 0 || layout_.GetPixelScale() != old_scale) {
+    PreloadFonts();
+  }
+}
+
+void MyApp::PreloadFonts() const {
+  ScopedTimer timer("PreloadFonts");
+
+  const float scale = layout_.GetPixelScale();
+  vector<float> sizes = {layout_.GetTileSize() / 3 * scale};
+  for (float size : kTextSizes) {
+    sizes.push_back(size * scale);
   }
 
-  if (engine_.IsGameOver()) {
+  GetFontCache().Clear();
+  GetFontCache().Preload(kFontFace, sizes);
+}
+
+void MyApp::update() {
+  if (render_benchmark_) {
+    if (render_benchmark_->IsStartingScenario()) {
+      SetUpScenario(render_benchmark_->GetScenario());
+    }
+    render_benchmark_->BeginFrame();
+  }
+
+  ScopedTimer timer("update");
+
+  CollectAssets(false);
+
+  mouse_pos_ = layout_.ToDesign(getMousePos() - getWindowPos());
+
+  if (state_ == AppState::kPlaying && engine_.IsGameOver()) {
     engine_.IncreaseGamesCompleted();
 
     // End the game or give a new board based on the mode and boards completed
-    if (engine_.GetGameMode() == GameMode::kStandard) {
-      state_ = AppState::kGameOver;
+    if (engine_.GetGamesCompleted() < engine_.GetBoardsPerGame()) {
+      engine_.StartNextBoard();
     } else {
-      if (engine_.GetGamesCompleted() < 3) {
-        if (engine_.GetGameMode() == GameMode::kTimeAttack) {
-          engine_.IncreaseDifficulty();
-        }
-
-        engine_.CreateGame();
-      } else {
-        state_ = AppState::kGameOver;
-      }
+      state_ = AppState::kGameOver;
+      engine_.PauseClock();
+      DeleteSavedGame();
     }
   }
 
@@ -91,26 +206,131 @@ void MyApp::update() {
 }
 
 void MyApp::draw() {
+  if (render_benchmark_) {
+    {
+      ci::gl::ScopedFramebuffer offscreen(benchmark_fbo_);
+      DrawScreen();
+    }
+
+    FinishBenchmarkFrame();
+    return;
+  }
+
+  DrawScreen();
+
+  // Drawn outside the timer so the overlay doesn't count its own cost
+  if (want_profiler_overlay_) {
+    DrawProfilerOverlay();
+  }
+
+  if (is_first_frame_) {
+    is_first_frame_ = false;
+    ReportStartupTime("first frame");
+  }
+}
+
+void MyApp::DrawScreen() {
+  ScopedTimer timer("draw");
+
   cinder::gl::enableAlphaBlending();
-  cinder::gl::clear(ci::Color((float) 188/256,
-                              (float) 188/256,
-                              (float) 188/256));
+  ClearBackground();
+
+  // Everything that only changes on a click or key press is drawn from the
+  // cached layer, so most frames only draw the timer and the board entries
+  screen_layer_.Draw(GetScreenLayerKey(), [this] {
+    ClearBackground();
+
+    ci::gl::ScopedModelMatrix model;
+    ApplyLayout();
+
+    if (state_ == AppState::kMenu) {
+      DrawMenu();
+    } else if (state_ == AppState::kPlaying) {
+      DrawGameBackdrop();
+    } else if (state_ == AppState::kGameOver) {
+      DrawGameOver();
+    }
+  });
+
+  if (state_ == AppState::kPlaying) {
+    ci::gl::ScopedModelMatrix model;
+    ApplyLayout();
 
-  if (state_ == AppState::kMenu) {
-    DrawMenu();
-  } else if (state_ == AppState::kPlaying) {
     // Highlight the box that the player has selected
     if (sel_box_.first != -1) {
       HighlightSelectedBox();
     }
 
     DrawGameScreen();
+  }
+}
+
+void MyApp::ClearBackground() const {
+  cinder::gl::clear(ci::Color((float) 188/256,
+                              (float) 188/256,
+                              (float) 188/256));
+}
+
+std::string MyApp::GetScreenLayerKey() const {
+  std::string key = std::to_string(static_cast<int>(state_))
+                    + (want_instructions_ ? "|instructions" : "|")
+                    + "|" + GetDifficultyAsString();
+
+  if (state_ == AppState::kPlaying) {
+    key += "|" + hint_text_;
+
+    // Each killer game has its own cages, drawn on the grid
+    for (const sudoku::Cage& cage : engine_.GetVariant().GetRules().cages) {
+      key += "|" + std::to_string(cage.sum);
+      for (size_t cell : cage.cells) {
+        key += "," + std::to_string(cell);
+      }
+    }
   } else if (state_ == AppState::kGameOver) {
-    DrawGameOver();
+    key += "|" + GetModeAsString()
+           + "|" + std::to_string(engine_.GetGameTime())
+           + "|" + std::to_string(engine_.GetSplitTimes().size())
+           + (is_entering_name_ ? "|entering|" : "|entered|") + player_name_
+           + "|" + std::to_string(static_cast<int>(leaderboard_window_))
+           + "|" + std::to_string(top_players_.size());
   }
+
+  return key;
 }
 
 void MyApp::keyDown(KeyEvent event) {
+  // Function keys so they can't clash with typing a name
+  if (event.getCode() == KeyEvent::KEY_F3) {
+    want_profiler_overlay_ = !want_profiler_overlay_;
+    return;
+  }
+  if (event.getCode() == KeyEvent::KEY_F4) {
+    sudoku::GetDefaultProfiler().ExportChromeTrace(trace_path_);
+    return;
+  }
+
+  if (state_ == AppState::kGameOver && !is_entering_name_
+      && event.getCode() == KeyEvent::KEY_w) {
+    CycleLeaderboardWindow();
+    return;
+  }
+
+  if (state_ == AppState::kPlaying && event.getCode() == KeyEvent::KEY_p) {
+    TogglePause();
+    SaveGame();
+    return;
+  }
+
+  // The board is hidden while paused, so don't let the player change it
+  if (state_ == AppState::kPlaying && engine_.IsClockPaused()) {
+    return;
+  }
+
+  // Pencil in every number that could still go in each empty box
+  if (state_ == AppState::kPlaying && event.getCode() == KeyEvent::KEY_a) {
+    engine_.AutoPencil();
+  }
+
   // Erase the current contents of a box
   if (event.getCode() == KeyEvent::KEY_BACKSPACE
       && sel_box_.first != -1
@@ -151,6 +371,10 @@ void MyApp::keyDown(KeyEvent event) {
   if (state_ == AppState::kGameOver && is_entering_name_) {
     UpdatePlayerName(event);
   }
+
+  if (state_ == AppState::kPlaying) {
+    SaveGame();
+  }
 }
 
 void MyApp::mouseDown(ci::app::MouseEvent event) {
@@ -186,6 +410,87 @@ void MyApp::mouseDown(ci::app::MouseEvent event) {
   if (event.isRight() && state_ == AppState::kPlaying) {
     engine_.SwitchEntryMode();
   }
+
+  if (state_ == AppState::kPlaying) {
+    SaveGame();
+  }
+}
+
+void MyApp::cleanup() {
+  // Benchmark games aren't real ones, so leave the player's autosave alone
+  if (state_ == AppState::kPlaying && !render_benchmark_) {
+    SaveGame();
+  }
+}
+
+void MyApp::StartLoadingAssets() {
+  // Assets are found here, since Cinder's asset lookup isn't safe to call
+  // from other threads, and the workers only read them. Images are only
+  // decoded there, since textures have to be made on the thread with the GL
+  // context
+  const array<ci::fs::path, 2> image_paths = {
+      {ci::app::getAssetPath("marker.png"),
+       ci::app::getAssetPath("pencil2.png")}};
+  entry_type_surfaces_ = std::async(std::launch::async, [image_paths] {
+    return array<ci::Surface, 2>{{ci::Surface(ci::loadImage(image_paths[0])),
+                                  ci::Surface(ci::loadImage(image_paths[1]))}};
+  });
+
+  const auto board_paths = sudoku::BoardBank::FindPaths(
+      engine_.GetBoardFiles());
+  board_bank_ = std::async(std::launch::async, [board_paths] {
+    return std::shared_ptr<const sudoku::BoardBank>(
+        std::make_shared<sudoku::BoardBank>(board_paths));
+  });
+
+  // Share a leaderboard server's rankings if one was given, instead of
+  // keeping them in this copy's own database
+  sudoku::LeaderBoardAddress server;
+  const bool use_server = GetLeaderBoardServer(getCommandLineArgs(), &server);
+  const string db_path = cinder::app::getAssetPath(kDbPath).string();
+  leaderboard_loading_ = std::async(std::launch::async,
+      [use_server, server, db_path]() -> std::unique_ptr<sudoku::LeaderBoard> {
+    if (use_server) {
+      return std::make_unique<sudoku::LeaderBoardClient>(server);
+    }
+    return std::make_unique<sudoku::ShardedLeaderBoard>(db_path);
+  });
+}
+
+void MyApp::CollectAssets(bool wait) {
+  if (IsLoaded(&entry_type_surfaces_, wait)) {
+    const auto surfaces = entry_type_surfaces_.get();
+    for (size_t i = 0; i < surfaces.size(); i++) {
+      entry_type_images_[i] = ci::gl::Texture2d::create(surfaces[i]);
+      sudoku::CountTextureUpload();
+    }
+  }
+
+  // Until the bank is in, new games read their board files directly
+  if (IsLoaded(&board_bank_, wait)) {
+    engine_.UseBoardBank(board_bank_.get());
+  }
+
+  if (IsLoaded(&leaderboard_loading_, wait)) {
+    leaderboard_ = leaderboard_loading_.get();
+  }
+
+  const bool is_loading = entry_type_surfaces_.valid() || board_bank_.valid()
+                          || leaderboard_loading_.valid();
+  if (!is_loading && !has_loaded_assets_) {
+    has_loaded_assets_ = true;
+    ReportStartupTime("assets loaded");
+  }
+}
+
+void MyApp::ReportStartupTime(const char* milestone) const {
+  const auto now = sudoku::Profiler::Clock::now();
+  sudoku::GetDefaultProfiler().Record(milestone, kLaunchTime, now);
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now - kLaunchTime);
+  ci::app::console() << "Startup: " << milestone << " after "
+                     << elapsed.count() << " ms" << std::endl;
 }
 
 void MyApp::SetupMenu() {
@@ -201,31 +506,21 @@ void MyApp::SetupMenu() {
   }
 
   // Record the position of the difficulty and instructions buttons
-  ci::vec2 diff_button_tl(getWindowBounds().x1 + 10,
-                          getWindowBounds().y2 - 60);
-  ci::vec2 diff_button_br(getWindowBounds().x1 + 135,
-                          getWindowBounds().y2 - 10);
+  ci::vec2 diff_button_tl(layout_.GetBounds().first.x + 10,
+                          layout_.GetBounds().second.y - 60);
+  ci::vec2 diff_button_br(layout_.GetBounds().first.x + 135,
+                          layout_.GetBounds().second.y - 10);
   difficulty_btn_ = {diff_button_tl, diff_button_br};
 
-  ci::vec2 instr_button_tl(getWindowBounds().x2 - 110,
-                           getWindowBounds().y2 - 60);
-  ci::vec2 instr_button_br(getWindowBounds().x2 - 10,
-                           getWindowBounds().y2 - 10);
+  ci::vec2 instr_button_tl(layout_.GetBounds().second.x - 110,
+                           layout_.GetBounds().second.y - 60);
+  ci::vec2 instr_button_br(layout_.GetBounds().second.x - 10,
+                           layout_.GetBounds().second.y - 10);
   instructions_btn_ = {instr_button_tl, instr_button_br};
 
 }
 
 void MyApp::SetupGameScreen() {
-  // Load entry mode images
-  ci::gl::Texture2dRef marker_image = ci::gl::Texture2d::create(
-      ci::loadImage(loadAsset("marker.png")));
-  entry_type_images_[0] = marker_image;
-
-  ci::gl::Texture2dRef pencil_image = ci::gl::Texture2d::create(
-      ci::loadImage(loadAsset(
-                                          "pencil2.png")));
-  entry_type_images_[1] = pencil_image;
-
   SetupGameBoard();
 
   // Record the positions of buttons and boxes on game screen
@@ -243,83 +538,121 @@ void MyApp::SetupGameScreen() {
                             game_grid_[kBoardSize - 1][0].second.y};
 
   entry_mode_indicator_.first = {win_center_.x - 50,
-                                 getWindowSize().y - 100};
+                                 layout_.GetBounds().second.y - 100};
   entry_mode_indicator_.second = {win_center_.x + 50,
-                                      getWindowSize().y};
+                                      layout_.GetBounds().second.y};
 }
 
 void MyApp::SetupGameBoard() {
-  float tile_size = std::floor(600 / kBoardSize);
-  float left_bound = win_center_.x - ((float) kBoardSize / 2) * tile_size;
-  float top_bound = win_center_.y - ((float) kBoardSize / 2) * tile_size;
-
   // Record the position of each box of the grid
   for (size_t row = 0; row < kBoardSize; row++) {
     for (size_t col = 0; col < kBoardSize; col++) {
-      ci::vec2 top_left(left_bound + col * tile_size,
-                        top_bound + row * tile_size);
-      ci::vec2 bottom_right(left_bound + (col + 1) * tile_size,
-                            top_bound + (row + 1) * tile_size);
-
-      game_grid_[row][col] = {top_left, bottom_right};
+      game_grid_[row][col] = layout_.GetCellBox(row, col);
     }
-
   }
 }
 
 void MyApp::SetupGameOver() {
   // Record position of play again button
   play_again_btn_.first = {win_center_.x - 50,
-                          getWindowBounds().y2 - 55};
+                          layout_.GetBounds().second.y - 55};
   play_again_btn_.second = {win_center_.x + 50,
-                           getWindowBounds().y2 - 5};
+                           layout_.GetBounds().second.y - 5};
 }
 
 void MyApp::UpdateLeaderboard() {
-  if (top_players_.empty() && !is_entering_name_) {
-    std::string mode = GetModeAsString();
-    std::string difficulty = GetDifficultyAsString();
+  ScopedTimer timer("UpdateLeaderboard");
+
+  if (!has_submitted_time_ && !is_entering_name_) {
+    has_submitted_time_ = true;
+    CollectAssets(true);
 
-    // This mode goes through all the difficulties, so I standardize it here
-    if (engine_.GetGameMode() == GameMode::kTimeAttack) {
-      difficulty = "Easy";
+    std::string mode = GetModeAsString();
+    std::string difficulty = GetLeaderboardDifficulty();
+    const int64_t now = sudoku::GetUnixTime();
+
+    // Everyone's daily challenge times are for the same puzzle only on the
+    // day, so that's the leaderboard to show, and a challenge finished
+    // after its day is over doesn't count
+    bool is_ranked = true;
+    if (engine_.GetGameMode() == GameMode::kDailyChallenge) {
+      leaderboard_window_ = sudoku::LeaderBoardWindow::kDaily;
+      is_ranked = engine_.GetChallengeDay() == sudoku::GetChallengeDay(now);
     }
 
-    leaderboard_.AddTimeToLeaderBoard({player_name_,
-                                       static_cast<size_t>(
-                                           engine_.GetGameTime())},
-                                      mode,
-                                      difficulty);
+    if (is_ranked) {
+      leaderboard_->AddTimeToLeaderBoard({player_name_, engine_.GetGameTime(),
+                                          now},
+                                        mode,
+                                        difficulty);
+    }
 
     // Update the list of top players in case the newest score is on it
-    top_players_ = leaderboard_.RetrieveBestTimes(10, mode, difficulty);
+    top_players_ = leaderboard_->RetrieveWindowBestTimes(leaderboard_window_,
+                                                         10, mode, difficulty);
+    player_stats_ = leaderboard_->RetrievePlayerStats(player_name_, mode,
+                                                      difficulty);
+  }
+}
+
+void MyApp::CycleLeaderboardWindow() {
+  switch (leaderboard_window_) {
+    case sudoku::LeaderBoardWindow::kAllTime :
+      leaderboard_window_ = sudoku::LeaderBoardWindow::kDaily;
+      break;
+    case sudoku::LeaderBoardWindow::kDaily :
+      leaderboard_window_ = sudoku::LeaderBoardWindow::kWeekly;
+      break;
+    case sudoku::LeaderBoardWindow::kWeekly :
+      leaderboard_window_ = sudoku::LeaderBoardWindow::kAllTime;
+      break;
   }
+
+  // The key can come in before update has collected the leaderboard
+  CollectAssets(true);
+  top_players_ = leaderboard_->RetrieveWindowBestTimes(
+      leaderboard_window_, 10, GetModeAsString(), GetLeaderboardDifficulty());
 }
 
 template <typename C>
-void PrintText(const std::string& text,
-               const C& color,
-               const cinder::ivec2& size,
-               const cinder::vec2& loc,
-               int font_size) {
+void MyApp::PrintText(const std::string& text,
+                      const C& color,
+                      const cinder::ivec2& size,
+                      const cinder::vec2& loc,
+                      int font_size) const {
   cinder::gl::enableAlphaBlending();
   cinder::gl::color(color);
-  const char font[] = "Arial";
+
+  // Render at the window's real resolution and draw it back at its design
+  // size, so the text stays sharp however much the layout scales it up
+  const float scale = layout_.GetPixelScale();
+  const ci::ivec2 pixel_size(static_cast<int>(std::ceil(size.x * scale)),
+                             static_cast<int>(std::ceil(size.y * scale)));
 
   auto box = ci::TextBox()
       .alignment(ci::TextBox::CENTER)
-      .font(cinder::Font(font, font_size))
-      .size(size)
+      .font(GetFontCache().Get(kFontFace,
+                               static_cast<float>(font_size) * scale))
+      .size(pixel_size)
       .color(color)
       .backgroundColor(ci::ColorA(0, 0, 0, 0))
       .text(text);
 
-  const auto box_size = box.getSize();
+  const ci::vec2 box_size(box.getSize().x / scale, box.getSize().y / scale);
   const cinder::vec2 locp = {loc.x - box_size.x / 2,
                              loc.y - box_size.y / 2};
   const auto surface = box.render();
   const auto texture = cinder::gl::Texture::create(surface);
-  cinder::gl::draw(texture, locp);
+  cinder::gl::draw(texture, ci::Rectf(locp.x, locp.y,
+                                      locp.x + box_size.x,
+                                      locp.y + box_size.y));
+  sudoku::CountTextureUpload();
+  sudoku::CountDrawCall();
+}
+
+void MyApp::ApplyLayout() const {
+  ci::gl::translate(layout_.GetOrigin());
+  ci::gl::scale(layout_.GetScale(), layout_.GetScale());
 }
 
 void MyApp::DrawMenu() const {
@@ -404,37 +737,49 @@ void MyApp::DrawSettings() const {
   DrawBox(instructions_btn_, ci::Color::black());
 }
 
-void MyApp::DrawGameScreen() {
-  // Draw timer
+void MyApp::DrawGameBackdrop() {
   PrintText("Time", ci::Color::black(),
             ci::vec2(100, 40),
             ci::vec2(game_grid_[0][kBoardSize - 1].second.x + 55,
                      game_grid_[0][kBoardSize - 1].first.y + 20),
             40);
-  PrintText(std::to_string(engine_.GetGameTime()),
+
+  DrawGameButtons();
+
+  DrawGrid();
+
+  if (want_instructions_) {
+    PrintGameInstructions();
+  }
+}
+
+void MyApp::DrawGameScreen() {
+  // Draw timer
+  PrintText(std::to_string(engine_.GetGameTime() / 1000),
             ci::Color::black(),
             ci::vec2(100, 30),
             ci::vec2(game_grid_[0][kBoardSize - 1].second.x + 55,
                      game_grid_[0][kBoardSize - 1].first.y + 60),
             kRegTextSize);
 
-  // Draw entry mode indicator
+  // Draw entry mode indicator, once the images have loaded
   ci::Area box(entry_mode_indicator_.first,
                entry_mode_indicator_.second);
-  if (engine_.IsPenciling()) {
-    ci::gl::draw(entry_type_images_[1], box);
-  } else {
-    ci::gl::draw(entry_type_images_[0], box);
+  const auto& image = entry_type_images_[engine_.IsPenciling() ? 1 : 0];
+  if (image) {
+    ci::gl::draw(image, box);
+    sudoku::CountDrawCall();
   }
 
-  DrawGameButtons();
-
-  DrawGrid();
-
-  PrintBoardEntries();
-
-  if (want_instructions_) {
-    PrintGameInstructions();
+  // Hide the board while paused so players can't think for free
+  if (engine_.IsClockPaused()) {
+    PrintText("Paused",
+              ci::Color(1, 0, 0),
+              ci::vec2(300, 100),
+              win_center_,
+              100);
+  } else {
+    PrintBoardEntries();
   }
 }
 
@@ -455,6 +800,15 @@ void MyApp::DrawGameButtons() {
             GetMiddleOfBox(hint_btn_),
             kRegTextSize);
 
+  // Explain the last hint above the button
+  if (!hint_text_.empty()) {
+    PrintText(hint_text_,
+              ci::Color(0, 0, 1),
+              ci::vec2(95, 120),
+              ci::vec2(GetMiddleOfBox(hint_btn_).x, hint_btn_.first.y - 70),
+              20);
+  }
+
   // Draw check board button
   DrawBox(check_board_btn_, ci::Color(0, 0, 1));
   PrintText("Check Board",
@@ -465,7 +819,9 @@ void MyApp::DrawGameButtons() {
 }
 
 void MyApp::DrawGrid() const {
-  float tile_size = std::floor(600 / kBoardSize);
+  ScopedTimer timer("DrawGrid");
+
+  float tile_size = layout_.GetTileSize();
 
   ci::Color color = ci::Color::black();
 
@@ -502,10 +858,70 @@ void MyApp::DrawGrid() const {
          game_grid_[0][0].first.y + i * tile_size + 1,
          color);
   }
+
+  DrawCages();
+}
+
+void MyApp::DrawCages() const {
+  const float tile_size = layout_.GetTileSize();
+  const float inset = tile_size / 10;
+  const ci::Color color(0.4f, 0.4f, 0.4f);
+
+  for (const sudoku::Cage& cage : engine_.GetVariant().GetRules().cages) {
+    auto is_in_cage = [&cage](int row, int col) {
+      const int size = static_cast<int>(kBoardSize);
+      return row >= 0 && row < size && col >= 0 && col < size
+             && std::find(cage.cells.begin(), cage.cells.end(),
+                          static_cast<size_t>(row * size + col))
+                != cage.cells.end();
+    };
+
+    for (size_t cell : cage.cells) {
+      const int row = static_cast<int>(cell / kBoardSize);
+      const int col = static_cast<int>(cell % kBoardSize);
+      const auto& box = game_grid_[cell / kBoardSize][cell % kBoardSize];
+
+      // Edges the cage carries on past run to the edge of the box, so
+      // neighbouring boxes' outlines meet
+      const float left = is_in_cage(row, col - 1) ? box.first.x
+                                                  : box.first.x + inset;
+      const float right = is_in_cage(row, col + 1) ? box.second.x
+                                                   : box.second.x - inset;
+      const float top = is_in_cage(row - 1, col) ? box.first.y
+                                                 : box.first.y + inset;
+      const float bottom = is_in_cage(row + 1, col) ? box.second.y
+                                                    : box.second.y - inset;
+      if (!is_in_cage(row - 1, col)) {
+        DrawLine(left, top, right, top, color);
+      }
+      if (!is_in_cage(row + 1, col)) {
+        DrawLine(left, bottom, right, bottom, color);
+      }
+      if (!is_in_cage(row, col - 1)) {
+        DrawLine(left, top, left, bottom, color);
+      }
+      if (!is_in_cage(row, col + 1)) {
+        DrawLine(right, top, right, bottom, color);
+      }
+    }
+
+    // Scales with the boxes, like pencil marks
+    const size_t first = *std::min_element(cage.cells.begin(),
+                                           cage.cells.end());
+    const auto& box = game_grid_[first / kBoardSize][first % kBoardSize];
+    PrintText(std::to_string(cage.sum),
+              color,
+              ci::vec2(tile_size / 3, tile_size / 4),
+              ci::vec2(box.first.x + tile_size / 5,
+                       box.first.y + tile_size / 6),
+              static_cast<int>(tile_size / 4));
+  }
 }
 
 void MyApp::PrintBoardEntries() const {
-  float tile_size = std::floor(600 / kBoardSize);
+  ScopedTimer timer("PrintBoardEntries");
+
+  float tile_size = layout_.GetTileSize();
 
   // Print pencil marks and board entries
   for (size_t row = 0; row < kBoardSize; row++) {
@@ -585,26 +1001,44 @@ void MyApp::HighlightSelectedBox() const {
 
 void MyApp::DrawGameOver() const {
   PrintText("You Win! \n Time: "
-                  + std::to_string(engine_.GetGameTime())
+                  + sudoku::FormatGameTime(engine_.GetGameTime())
                   + " seconds",
             ci::Color(0, 0, 1),
             ci::vec2(700, 120),
-            ci::vec2(win_center_.x, getWindowBounds().y1 + 60),
+            ci::vec2(win_center_.x, layout_.GetBounds().first.y + 60),
             60);
 
   // Print the type that the game was
   std::string game_type;
   if (engine_.GetGameMode() == GameMode::kTimeAttack) {
       game_type = GetModeAsString();
+  } else if (engine_.GetGameMode() == GameMode::kDailyChallenge) {
+      game_type = GetModeAsString() + " "
+                  + sudoku::FormatChallengeDay(engine_.GetChallengeDay());
   } else {
       game_type = GetDifficultyAsString() + " " + GetModeAsString();
   }
   PrintText("Mode: " + game_type,
            ci::Color(0, 0, 1),
            ci::vec2(700, 60),
-           ci::vec2(win_center_.x, getWindowBounds().y1 + 150),
+           ci::vec2(win_center_.x, layout_.GetBounds().first.y + 150),
            60);
 
+  // Show how long each board took in the multi-board modes
+  if (engine_.GetBoardsPerGame() > 1) {
+    std::string splits = "Boards:";
+    for (const auto& split : engine_.GetSplitTimes()) {
+      splits += " " + sudoku::FormatGameTime(
+          static_cast<size_t>(split.count()));
+    }
+
+    PrintText(splits,
+              ci::Color(0, 0, 1),
+              ci::vec2(700, 30),
+              ci::vec2(win_center_.x, layout_.GetBounds().first.y + 195),
+              kRegTextSize);
+  }
+
   if (is_entering_name_) {
     if (want_instructions_) {
       PrintEnterNameInstructions();
@@ -630,10 +1064,47 @@ void MyApp::DrawGameOver() const {
               ci::vec2(95, 45),
               ci::vec2(GetMiddleOfBox(play_again_btn_)),
               kRegTextSize);
+
+    DrawPlayerStats();
+  }
+}
+
+void MyApp::DrawPlayerStats() const {
+  if (player_stats_.games_played == 0) {
+    return;
   }
+
+  // Either side of the play again button
+  const float y = GetMiddleOfBox(play_again_btn_).y;
+  PrintText("Games: " + std::to_string(player_stats_.games_played)
+                + "  Best: "
+                + sudoku::FormatGameTime(player_stats_.best_time),
+            ci::Color::black(),
+            ci::vec2(320, 30),
+            ci::vec2(win_center_.x - 225, y),
+            20);
+  PrintText("Mean: " + sudoku::FormatGameTime(player_stats_.mean_time)
+                + "  Recent: "
+                + sudoku::FormatGameTime(player_stats_.recent_median_time),
+            ci::Color::black(),
+            ci::vec2(320, 30),
+            ci::vec2(win_center_.x + 225, y),
+            20);
 }
 
 void MyApp::DrawLeaderboard() const {
+  std::string window = "All time";
+  if (leaderboard_window_ == sudoku::LeaderBoardWindow::kDaily) {
+    window = "Today";
+  } else if (leaderboard_window_ == sudoku::LeaderBoardWindow::kWeekly) {
+    window = "This week";
+  }
+  PrintText(window + " (W to change)",
+            ci::Color::black(),
+            ci::vec2(300, 30),
+            ci::vec2(win_center_.x, win_center_.y - 225),
+            kRegTextSize);
+
   PrintText("Player",
             ci::Color::black(),
             ci::vec2(300, 50),
@@ -658,7 +1129,7 @@ void MyApp::DrawLeaderboard() const {
     PrintText(std::to_string(i + 1),
               color,
               ci::vec2(100, 50),
-              ci::vec2(getWindowBounds().x1 + 125,
+              ci::vec2(layout_.GetBounds().first.x + 125,
                            win_center_.y - 140 + i * 50),
               kBigTextSize);
 
@@ -669,7 +1140,7 @@ void MyApp::DrawLeaderboard() const {
                            win_center_.y - 140 + i * 50),
               kBigTextSize);
 
-    PrintText(std::to_string(top_players_[i].time),
+    PrintText(sudoku::FormatGameTime(top_players_[i].time),
               color,
               ci::vec2(300, 50),
               ci::vec2(win_center_.x + 250,
@@ -678,14 +1149,48 @@ void MyApp::DrawLeaderboard() const {
   }
 }
 
+void MyApp::DrawProfilerOverlay() const {
+  ci::gl::ScopedModelMatrix model;
+  ApplyLayout();
+
+  std::string text = "scope: p50 / p99 ms";
+  for (const auto& scope : sudoku::GetDefaultProfiler().GetStats()) {
+    char line[96];
+    std::snprintf(line, sizeof(line), "\n%s: %.2f / %.2f", scope.scope.c_str(),
+                  scope.p50_ms, scope.p99_ms);
+    text += line;
+  }
+
+  // Top left corner, clear of the board
+  PrintText(text,
+            ci::Color(1, 0, 0),
+            ci::vec2(260, 160),
+            ci::vec2(layout_.GetBounds().first.x + 130,
+                     layout_.GetBounds().first.y + 80),
+            16);
+}
+
 void MyApp::ExecuteGameClick() {
   if (IsMouseInBox(mouse_pos_, menu_return_btn_)) {
     ResetApp();
+    return;
+  }
+
+  // The board is hidden while paused, so don't let the player change it
+  if (engine_.IsClockPaused()) {
+    return;
   }
 
-  // Give a hint
-  if (IsMouseInBox(mouse_pos_, hint_btn_) && sel_box_.first != -1) {
-    engine_.FillInCorrectEntry(sel_box_);
+  // Fill in the next box the player could solve and explain how
+  if (IsMouseInBox(mouse_pos_, hint_btn_)) {
+    sudoku::Hint hint = engine_.GetHint();
+    if (hint.technique != sudoku::Technique::kNone) {
+      engine_.FillInCorrectEntry(hint.entry);
+      hint_text_ = std::to_string(hint.num) + ": "
+                   + sudoku::DescribeHint(hint);
+      sel_box_ = hint.entry;
+      return;
+    }
   }
 
   if (IsMouseInBox(mouse_pos_, check_board_btn_)) {
@@ -693,12 +1198,9 @@ void MyApp::ExecuteGameClick() {
   }
 
   // Updates the last box in the board the player clicked on
-  for (size_t row = 0; row < kBoardSize; row++) {
-    for (size_t col = 0; col < kBoardSize; col++) {
-      if (IsMouseInBox(mouse_pos_, game_grid_[row][col])) {
-        sel_box_ = {row, col};
-      }
-    }
+  std::pair<int, int> cell;
+  if (layout_.GetCellAt(mouse_pos_, &cell)) {
+    sel_box_ = cell;
   }
 }
 
@@ -756,6 +1258,7 @@ void MyApp::UpdatePlayerName(KeyEvent event) {
 }
 
 void MyApp::StartNewGame(int mode) {
+  has_submitted_time_ = false;
   switch (mode) {
     case 0:
       engine_.SetGameMode(GameMode::kStandard);
@@ -770,20 +1273,119 @@ void MyApp::StartNewGame(int mode) {
   }
 
   state_ = AppState::kPlaying;
-  engine_.CreateGame();
-  engine_.SetStartTime(std::chrono::system_clock::now());
+  if (mode == 3) {
+    engine_.CreateDailyChallenge(
+        sudoku::GetChallengeDay(sudoku::GetUnixTime()));
+  } else {
+    engine_.CreateGame();
+  }
+  engine_.StartClock();
+}
+
+void MyApp::TogglePause() {
+  if (engine_.IsClockPaused()) {
+    engine_.ResumeClock();
+  } else {
+    engine_.PauseClock();
+  }
 }
 
 void MyApp::ResetApp() {
   state_ = AppState::kMenu;
+  DeleteSavedGame();
   engine_.ResetGame();
   top_players_.clear();
+  has_submitted_time_ = false;
+  player_stats_ = {};
   sel_box_ = {-1, -1};
+  hint_text_.clear();
 
   is_entering_name_ = true;
   player_name_ = "";
 }
 
+void MyApp::SaveGame() const {
+  engine_.SaveSnapshot(snapshot_path_);
+}
+
+void MyApp::DeleteSavedGame() const {
+  std::remove(snapshot_path_.c_str());
+}
+
+void MyApp::StartRenderBenchmark(const RenderBenchmarkOptions& options) {
+  render_benchmark_ = std::make_unique<RenderBenchmark>(options);
+
+  // Draw into a framebuffer the size of the window, with the same
+  // multisampling, so a hidden window doesn't let the driver skip any work
+  const int samples = 8;
+  const ci::ivec2 size = toPixels(getWindowSize());
+  benchmark_fbo_ = ci::gl::Fbo::create(
+      size.x, size.y, ci::gl::Fbo::Format().samples(samples));
+
+  getWindow()->hide();
+  ci::gl::enableVerticalSync(false);
+  disableFrameRate();
+}
+
+void MyApp::SetUpScenario(RenderScenario scenario) {
+  // Every scenario should draw with everything loaded
+  CollectAssets(true);
+
+  switch (scenario) {
+    case RenderScenario::kEmptyBoard :
+    case RenderScenario::kPenciledBoard :
+      state_ = AppState::kPlaying;
+      engine_.SetGameMode(GameMode::kStandard);
+      engine_.CreateGame(kBenchmarkBoard);
+      engine_.StartClock();
+      sel_box_ = {0, 0};
+
+      if (scenario == RenderScenario::kPenciledBoard) {
+        for (int row = 0; row < static_cast<int>(kBoardSize); row++) {
+          for (int col = 0; col < static_cast<int>(kBoardSize); col++) {
+            if (engine_.GetEntry({row, col}) != 0) {
+              continue;
+            }
+
+            for (int num = 1; num <= static_cast<int>(kBoardSize); num++) {
+              engine_.ChangePencilMark({row, col}, num);
+            }
+          }
+        }
+      }
+      break;
+    case RenderScenario::kGameOver :
+      // A full leaderboard, without touching the real one
+      state_ = AppState::kGameOver;
+      engine_.PauseClock();
+      is_entering_name_ = false;
+      player_name_ = "Player 1";
+      has_submitted_time_ = true;
+      top_players_.clear();
+      for (size_t i = 0; i < 10; i++) {
+        top_players_.emplace_back("Player " + std::to_string(i + 1),
+                                  60000 + i * 7919);
+      }
+      player_stats_.games_played = 25;
+      player_stats_.best_time = 60000;
+      player_stats_.mean_time = 95000;
+      player_stats_.recent_median_time = 81000;
+      break;
+  }
+}
+
+void MyApp::FinishBenchmarkFrame() {
+  // Wait for the GPU, so the frame time includes drawing and not just
+  // queueing up the commands
+  glFinish();
+  render_benchmark_->EndFrame();
+
+  if (render_benchmark_->IsDone()) {
+    ci::app::console() << render_benchmark_->GetReport() << std::flush;
+    quit();
+  }
+}
+
 void MyApp::PrintMenuInstructions() const {
   // Print game mode explanations
   PrintText("Classic game of the desired difficulty",
@@ -804,6 +1406,12 @@ void MyApp::PrintMenuInstructions() const {
             ci::vec2(win_center_.x - 260,
                      GetMiddleOfBox(game_start_btns_[2]).y),
             kRegTextSize);
+  PrintText("Today's puzzle, the same for everyone",
+            ci::Color::black(),
+            ci::vec2(250, 60),
+            ci::vec2(win_center_.x - 250,
+                     GetMiddleOfBox(game_start_btns_[3]).y),
+            kRegTextSize);
 
   // Print settings instructions
   PrintText("Choose your difficulty before starting a game",
@@ -824,17 +1432,17 @@ void MyApp::PrintGameInstructions() const {
   PrintText("Welcome to Sudoku! To solve the puzzle,",
             ci::Color::black(),
             ci::vec2(600, 30),
-            ci::vec2(win_center_.x, getWindowBounds().y1 + 20),
+            ci::vec2(win_center_.x, layout_.GetBounds().first.y + 20),
             kRegTextSize);
   PrintText("fill every row, column, and box with the numbers 1 to 9.",
             ci::Color::black(),
             ci::vec2(600, 30),
-            ci::vec2(win_center_.x, getWindowBounds().y1 + 50),
+            ci::vec2(win_center_.x, layout_.GetBounds().first.y + 50),
             kRegTextSize);
   PrintText("Use your mouse and number pad to fill in the board.",
             ci::Color::black(),
             ci::vec2(600, 30),
-            ci::vec2(win_center_.x, getWindowBounds().y1 + 80),
+            ci::vec2(win_center_.x, layout_.GetBounds().first.y + 80),
             kRegTextSize);
 
   PrintText("This symbol shows what entry mode you're in.",
@@ -880,13 +1488,13 @@ void MyApp::PrintGameInstructions() const {
             ci::vec2(175,
                          game_grid_[kBoardSize - 1][0].second.y + 50),
             20);
-  PrintText("game. Click 'Hint' to fill in the box you have",
+  PrintText("game. Click 'Hint' to fill in the next box you",
             ci::Color::black(),
             ci::vec2(350, 20),
             ci::vec2(175,
                          game_grid_[kBoardSize - 1][0].second.y + 70),
             20);
-  PrintText("highlighted with the correct number.",
+  PrintText("could solve and see which technique finds it.",
             ci::Color::black(),
             ci::vec2(350, 20),
             ci::vec2(175,
@@ -911,6 +1519,8 @@ std::string MyApp::GetModeAsString() const {
     mode = "Time Trial";
   } else if (engine_.GetGameMode() == GameMode::kTimeAttack) {
     mode = "Time Attack";
+  } else if (engine_.GetGameMode() == GameMode::kDailyChallenge) {
+    mode = "Daily Challenge";
   }
 
   return mode;
@@ -929,4 +1539,13 @@ std::string MyApp::GetDifficultyAsString() const {
   return difficulty;
 }
 
+std::string MyApp::GetLeaderboardDifficulty() const {
+  if (engine_.GetGameMode() == GameMode::kTimeAttack
+      || engine_.GetGameMode() == GameMode::kDailyChallenge) {
+    return "Easy";
+  }
+
+  return GetDifficultyAsString();
+}
+
 }  // namespace myapp
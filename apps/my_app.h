@@ -5,14 +5,22 @@
 
 #include <cinder/app/App.h>
 #include <cinder/app/KeyEvent.h>
+#include <cinder/Surface.h>
+#include <cinder/gl/Fbo.h>
 #include <cinder/gl/Texture.h>
+#include <sudoku/layout.h>
 #include <sudoku/leaderboard.h>
 
 #include <array>
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "../include/sudoku/board_bank.h"
 #include "../include/sudoku/engine.h"
+#include "cached_layer.h"
+#include "render_benchmark.h"
 
 using sudoku::kBoardSize;
 using std::array;
@@ -34,10 +42,26 @@ class MyApp : public cinder::app::App {
   void setup() override;
   void update() override;
   void draw() override;
+  void resize() override;
   void keyDown(cinder::app::KeyEvent) override;
   void mouseDown(cinder::app::MouseEvent) override;
+  void cleanup() override;
 
  private:
+  // Read the images, puzzle bank and leaderboard on worker threads, so the
+  // first frame can be drawn straight away
+  void StartLoadingAssets();
+
+  // Take whatever has finished loading, or wait for everything if `wait` is
+  // true. Anything that needs an asset waits for it first
+  void CollectAssets(bool wait);
+
+  // Load the fonts text is printed in at the window's current scale
+  void PreloadFonts() const;
+
+  // Log and profile the time from launch to a point in startup
+  void ReportStartupTime(const char* milestone) const;
+
   // Record positions of buttons in the menu
   void SetupMenu();
 
@@ -51,15 +75,42 @@ class MyApp : public cinder::app::App {
   // Add the player's time to the leaderboard and get the new top 10 times
   void UpdateLeaderboard();
 
+  // Show the next of the all-time, daily and weekly top 10s
+  void CycleLeaderboardWindow();
+
+  // Draw whichever screen the app is on
+  void DrawScreen();
+  void ClearBackground() const;
+
+  // Everything the cached screen layer shows, see CachedLayer
+  string GetScreenLayerKey() const;
+
+  // Scale and center the design space in the window, for drawing in it
+  void ApplyLayout() const;
+
+  // Print text centered on `loc`, wrapped to fit in `size`
+  template <typename C>
+  void PrintText(const string& text,
+                 const C& color,
+                 const ci::ivec2& size,
+                 const ci::vec2& loc,
+                 int font_size) const;
+
   // Draw the parts of the menu
   void DrawMenu() const;
   void PrintGameModes() const;
   void DrawSettings() const;
 
-  // Draw the parts of the game screen
+  // Draw the parts of the game screen. The backdrop is the parts that don't
+  // change every frame, like the grid, buttons and instructions
+  void DrawGameBackdrop();
   void DrawGameScreen();
   void DrawGameButtons();
   void DrawGrid() const;
+
+  // Outline each killer cage just inside its boxes, with its sum in the
+  // corner of its first box
+  void DrawCages() const;
   void PrintBoardEntries() const;
   void HighlightSelectedBox() const;
 
@@ -67,6 +118,12 @@ class MyApp : public cinder::app::App {
   void DrawGameOver() const;
   void DrawLeaderboard() const;
 
+  // The player's games played, best, mean and recent median time
+  void DrawPlayerStats() const;
+
+  // Draw the p50/p99 time of each profiled scope in the corner
+  void DrawProfilerOverlay() const;
+
   // Check if the player clicked anything in the game screen and update the
   // game accordingly
   void ExecuteGameClick();
@@ -83,25 +140,47 @@ class MyApp : public cinder::app::App {
   // For the mode parameter, 0 = Standard, 1 = Time Trial, and 2 = Time Attack
   void StartNewGame(int mode);
 
+  // Stop or restart the game timer and hide or show the board
+  void TogglePause();
+
   // Reset instance variables and return to the menu
   void ResetApp();
 
+  // Save the game in progress so it can be resumed after the app restarts,
+  // or throw away the saved game once it's over
+  void SaveGame() const;
+  void DeleteSavedGame() const;
+
   // Print instructions for different parts of the app
   void PrintMenuInstructions() const;
   void PrintGameInstructions() const;
   void PrintEnterNameInstructions() const;
 
+  // Run hidden, drawing each scenario offscreen for a set number of frames,
+  // then print how long the frames took and quit
+  void StartRenderBenchmark(const RenderBenchmarkOptions& options);
+  void SetUpScenario(RenderScenario scenario);
+  void FinishBenchmarkFrame();
+
   // Translate game characteristics into strings for printing
   string GetModeAsString() const;
   string GetDifficultyAsString() const;
 
+  // The difficulty the game's times are ranked under. Modes that don't
+  // stick to one difficulty are all kept under Easy
+  string GetLeaderboardDifficulty() const;
+
   // The state of the app indicates what screen it is on
   AppState state_;
 
-  // x,y position of the mouse relative to the window
+  // Where everything goes in the window. The positions below are all in its
+  // design space, which is the same whatever the window's size
+  sudoku::Layout layout_;
+
+  // x,y position of the mouse in the design space
   ci::vec2 mouse_pos_;
 
-  // x,y point at the center of the window
+  // x,y point at the center of the design space
   ci::vec2 win_center_;
 
   // Row,Column coordinate of the selected box in the game board
@@ -109,14 +188,29 @@ class MyApp : public cinder::app::App {
   pair<int, int> sel_box_;
 
   sudoku::Engine engine_;
-  sudoku::LeaderBoard leaderboard_;
+
+  // Empty until it's been opened on a worker thread, see CollectAssets
+  std::unique_ptr<sudoku::LeaderBoard> leaderboard_;
 
   // Top players and their times, updated based on game's mode/difficulty
   vector<sudoku::Player> top_players_;
 
+  // Which times top_players_ is taken from
+  sudoku::LeaderBoardWindow leaderboard_window_;
+
+  // Whether this game's time has gone to the leaderboard. top_players_
+  // can't say, since the window shown can have no times in it
+  bool has_submitted_time_;
+
+  // The player's record in the game's mode/difficulty, including this game
+  sudoku::PlayerStats player_stats_;
+
   // Whether or not to print the instructions for each screen
   bool want_instructions_;
 
+  // Explanation of the last hint given, empty if there isn't one to show
+  string hint_text_;
+
   // For the game over screen, indicates if the player has confirmed their name
   bool is_entering_name_;
   string player_name_;
@@ -133,11 +227,35 @@ class MyApp : public cinder::app::App {
   pair<ci::vec2, ci::vec2> entry_mode_indicator_;
   array<array<pair<ci::vec2, ci::vec2>, kBoardSize>, kBoardSize> game_grid_;
 
+  // Where the game in progress is autosaved
+  string snapshot_path_;
+
+  // The menu, game over screen, or game screen backdrop, drawn once and
+  // reused until something on it changes
+  CachedLayer screen_layer_;
+
+  // Whether the profiler overlay is shown, and where its trace is exported
+  bool want_profiler_overlay_;
+  string trace_path_;
+
+  // Only set when running the render benchmark
+  std::unique_ptr<RenderBenchmark> render_benchmark_;
+  ci::gl::FboRef benchmark_fbo_;
+
   // Names of the game modes
   vector<string> game_modes_;
 
-  // Pen and pencil images
+  // Pen and pencil images, empty until they've loaded
   array<ci::gl::Texture2dRef, 2> entry_type_images_;
+
+  // Assets still loading on worker threads. Each is invalid once taken
+  std::future<array<ci::Surface, 2>> entry_type_surfaces_;
+  std::future<std::shared_ptr<const sudoku::BoardBank>> board_bank_;
+  std::future<std::unique_ptr<sudoku::LeaderBoard>> leaderboard_loading_;
+
+  // For reporting how long startup took
+  bool is_first_frame_;
+  bool has_loaded_assets_;
 };
 
 }  // namespace myapp
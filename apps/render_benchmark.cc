@@ -0,0 +1,178 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include "render_benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace myapp {
+
+namespace {
+
+bool ParseCount(const std::string& text, size_t* count) {
+  char* end = nullptr;
+  unsigned long value = std::strtoul(text.c_str(), &end, 10);
+  if (text.empty() || *end != '\0') {
+    return false;
+  }
+
+  *count = value;
+  return true;
+}
+
+bool ParseScenario(const std::string& name, RenderScenario* scenario) {
+  for (RenderScenario candidate : {RenderScenario::kEmptyBoard,
+                                   RenderScenario::kPenciledBoard,
+                                   RenderScenario::kGameOver}) {
+    if (name == GetScenarioName(candidate)) {
+      *scenario = candidate;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+bool ParseRenderBenchmarkArgs(const std::vector<std::string>& args,
+                              RenderBenchmarkOptions* options) {
+  bool is_benchmark = false;
+  bool has_scenario = false;
+
+  // The first argument is the program
+  for (size_t i = 1; i < args.size(); i++) {
+    if (args[i] == "--render-benchmark") {
+      is_benchmark = true;
+      continue;
+    }
+
+    // Every other option takes a value
+    if (i + 1 == args.size()) {
+      return false;
+    }
+    const std::string& value = args[++i];
+
+    if (args[i - 1] == "--frames") {
+      if (!ParseCount(value, &options->frames) || options->frames == 0) {
+        return false;
+      }
+    } else if (args[i - 1] == "--warmup") {
+      if (!ParseCount(value, &options->warmup_frames)) {
+        return false;
+      }
+    } else if (args[i - 1] == "--scenario") {
+      RenderScenario scenario;
+      if (!ParseScenario(value, &scenario)) {
+        return false;
+      }
+
+      // Naming scenarios replaces the default of running them all
+      if (!has_scenario) {
+        options->scenarios.clear();
+        has_scenario = true;
+      }
+      options->scenarios.push_back(scenario);
+    } else {
+      return false;
+    }
+  }
+
+  return is_benchmark;
+}
+
+const char* GetScenarioName(RenderScenario scenario) {
+  switch (scenario) {
+    case RenderScenario::kEmptyBoard :
+      return "empty";
+    case RenderScenario::kPenciledBoard :
+      return "penciled";
+    case RenderScenario::kGameOver :
+      return "gameover";
+  }
+
+  return "";
+}
+
+RenderBenchmark::RenderBenchmark(const RenderBenchmarkOptions& options)
+    : options_{options},
+      scenario_index_{0},
+      frame_{0},
+      counts_at_start_{0, 0},
+      frame_times_{options.frames * options.scenarios.size()},
+      totals_(options.scenarios.size()) {}
+
+RenderScenario RenderBenchmark::GetScenario() const {
+  return options_.scenarios[scenario_index_];
+}
+
+bool RenderBenchmark::IsStartingScenario() const {
+  return !IsDone() && frame_ == 0;
+}
+
+void RenderBenchmark::BeginFrame() {
+  counts_at_start_ = sudoku::GetRenderCounts();
+  frame_start_ = sudoku::Profiler::Clock::now();
+}
+
+void RenderBenchmark::EndFrame() {
+  if (IsDone()) {
+    return;
+  }
+
+  // Warmup frames fill caches and let the driver settle, so aren't counted
+  if (frame_ >= options_.warmup_frames) {
+    frame_times_.Record(GetScenarioName(GetScenario()), frame_start_,
+                        sudoku::Profiler::Clock::now());
+
+    sudoku::RenderCounts counts = sudoku::GetRenderCounts();
+    Totals& totals = totals_[scenario_index_];
+    totals.frames++;
+    totals.draw_calls += counts.draw_calls - counts_at_start_.draw_calls;
+    totals.texture_uploads += counts.texture_uploads
+                              - counts_at_start_.texture_uploads;
+  }
+
+  frame_++;
+  if (frame_ == options_.warmup_frames + options_.frames) {
+    scenario_index_++;
+    frame_ = 0;
+  }
+}
+
+bool RenderBenchmark::IsDone() const {
+  return scenario_index_ == options_.scenarios.size();
+}
+
+std::string RenderBenchmark::GetReport() const {
+  const auto stats = frame_times_.GetStats();
+
+  std::string report = "scenario     frames   p50 ms   p99 ms   max ms"
+                       "   draws/frame   uploads/frame\n";
+  for (size_t i = 0; i < options_.scenarios.size(); i++) {
+    const std::string name = GetScenarioName(options_.scenarios[i]);
+    const Totals& totals = totals_[i];
+
+    for (const auto& scope : stats) {
+      if (scope.scope != name) {
+        continue;
+      }
+
+      auto frames = static_cast<double>(totals.frames);
+      char line[160];
+      std::snprintf(line, sizeof(line),
+                    "%-10s %8zu %8.2f %8.2f %8.2f %13.1f %15.1f\n",
+                    name.c_str(), totals.frames, scope.p50_ms, scope.p99_ms,
+                    scope.max_ms,
+                    static_cast<double>(totals.draw_calls) / frames,
+                    static_cast<double>(totals.texture_uploads) / frames);
+      report += line;
+    }
+  }
+
+  return report;
+}
+
+}  // namespace myapp
@@ -0,0 +1,80 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#ifndef FINALPROJECT_APPS_RENDER_BENCHMARK_H_
+#define FINALPROJECT_APPS_RENDER_BENCHMARK_H_
+
+#include <sudoku/profiler.h>
+
+#include <string>
+#include <vector>
+
+namespace myapp {
+
+// Screens the render benchmark draws
+enum class RenderScenario {
+  kEmptyBoard,
+  kPenciledBoard,
+  kGameOver
+};
+
+// How the app was asked to run the render benchmark on the command line:
+//   --render-benchmark [--frames N] [--warmup N] [--scenario NAME]
+// where NAME is empty, penciled or gameover. Every scenario runs by default
+struct RenderBenchmarkOptions {
+  size_t frames = 300;
+  size_t warmup_frames = 30;
+  std::vector<RenderScenario> scenarios = {RenderScenario::kEmptyBoard,
+                                           RenderScenario::kPenciledBoard,
+                                           RenderScenario::kGameOver};
+};
+
+// Returns false if the benchmark wasn't asked for, or the arguments are bad
+bool ParseRenderBenchmarkArgs(const std::vector<std::string>& args,
+                              RenderBenchmarkOptions* options);
+
+const char* GetScenarioName(RenderScenario scenario);
+
+// Times a fixed number of frames of each scenario in turn, along with the
+// draw calls and texture uploads each frame made. The app sets up the
+// scenario, then brackets each frame with BeginFrame and EndFrame
+class RenderBenchmark {
+ public:
+  explicit RenderBenchmark(const RenderBenchmarkOptions& options);
+
+  RenderScenario GetScenario() const;
+
+  // True for the first frame of each scenario, which is when the app should
+  // set it up
+  bool IsStartingScenario() const;
+
+  void BeginFrame();
+  void EndFrame();
+
+  bool IsDone() const;
+
+  // Frame time percentiles and GL work per frame for each scenario
+  std::string GetReport() const;
+
+ private:
+  // What the measured frames of a scenario did in total
+  struct Totals {
+    size_t frames = 0;
+    size_t draw_calls = 0;
+    size_t texture_uploads = 0;
+  };
+
+  RenderBenchmarkOptions options_;
+  size_t scenario_index_;
+  size_t frame_;
+
+  sudoku::Profiler::Clock::time_point frame_start_;
+  sudoku::RenderCounts counts_at_start_;
+
+  // The frame times, with each scenario as its own scope
+  sudoku::Profiler frame_times_;
+  std::vector<Totals> totals_;
+};
+
+}  // namespace myapp
+
+#endif  // FINALPROJECT_APPS_RENDER_BENCHMARK_H_
@@ -17,7 +17,10 @@ const int kWidth = 800;
 const int kHeight = 800;
 
 void SetUp(App::Settings* settings) {
+  // Only the starting size, the layout scales to whatever the window becomes
   settings->setWindowSize(kWidth, kHeight);
+  settings->setResizable(true);
+  settings->setHighDensityDisplayEnabled();
   settings->setTitle("Sudoku");
 }
 
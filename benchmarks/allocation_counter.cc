@@ -0,0 +1,34 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> num_allocations{0};
+
+}  // namespace
+
+size_t GetAllocationCount() {
+  return num_allocations;
+}
+
+// The array and nothrow forms all call this one by default
+void* operator new(std::size_t size) {
+  num_allocations++;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
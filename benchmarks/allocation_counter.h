@@ -0,0 +1,11 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_BENCHMARKS_ALLOCATION_COUNTER_H_
+#define FINALPROJECT_BENCHMARKS_ALLOCATION_COUNTER_H_
+
+#include <cstddef>
+
+// Number of heap allocations the program has made so far. Counted by
+// replacing the global operator new, so it includes every library
+size_t GetAllocationCount();
+
+#endif  // FINALPROJECT_BENCHMARKS_ALLOCATION_COUNTER_H_
@@ -0,0 +1,606 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+// Benchmarks for the solver, generator, board import and leaderboard. Catch2
+// reports the time per board (or per leaderboard row) for each benchmark, and
+// the allocations per board are printed before each group.
+//
+// Run with --benchmark-samples to trade accuracy for time, and pass a tag
+// such as [hard] to run one corpus
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include <cinder/app/App.h>
+
+#include <sudoku/board.h>
+#include <sudoku/daily_challenge.h>
+#include <sudoku/engine.h>
+#include <sudoku/generator.h>
+#include <sudoku/hint.h>
+#include <sudoku/leaderboard.h>
+#include <sudoku/leaderboard_archive.h>
+#include <sudoku/leaderboard_client.h>
+#include <sudoku/leaderboard_server.h>
+#include <sudoku/log_leaderboard.h>
+#include <sudoku/player.h>
+#include <sudoku/random.h>
+#include <sudoku/sharded_leaderboard.h>
+#include <sudoku/solver.h>
+#include <sudoku/transform.h>
+#include <sudoku/variant.h>
+
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include "allocation_counter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using sudoku::Grid;
+
+const std::vector<std::string> kBankFiles = {
+    "easy_1.json", "easy_2.json", "easy_3.json",
+    "medium_1.json", "medium_2.json", "medium_3.json",
+    "hard_1.json", "hard_2.json", "hard_3.json"};
+
+struct Corpus {
+  std::vector<Grid> puzzles;
+  std::vector<Grid> solutions;
+};
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream infile(path, std::ios::binary);
+  std::stringstream contents;
+  contents << infile.rdbuf();
+  return contents.str();
+}
+
+// The boards bundled with the app
+Corpus LoadBank() {
+  Corpus corpus;
+  for (const auto& file : kBankFiles) {
+    auto board_data = nlohmann::json::parse(
+        ReadFile(ci::app::getAssetPath(file).string()));
+    corpus.puzzles.push_back(board_data.at("board").get<Grid>());
+    corpus.solutions.push_back(board_data.at("solution").get<Grid>());
+  }
+
+  return corpus;
+}
+
+// A corpus file from benchmarks/corpora, solved up front
+Corpus LoadCorpus(const std::string& name) {
+  Corpus corpus;
+  std::ifstream infile(std::string(CORPUS_DIR) + "/" + name);
+  std::string line;
+  while (std::getline(infile, line)) {
+    Grid board;
+    if (sudoku::ParseBoardLine(line, &board)) {
+      corpus.puzzles.push_back(board);
+      sudoku::Solve(&board);
+      corpus.solutions.push_back(board);
+    }
+  }
+
+  return corpus;
+}
+
+// Run `run_board` once for every board, and print how many heap
+// allocations that took per board
+template <typename RunBoard>
+void ReportAllocations(const std::string& name, size_t num_boards,
+                       RunBoard run_board) {
+  size_t before = GetAllocationCount();
+  for (size_t i = 0; i < num_boards; i++) {
+    run_board(i);
+  }
+  size_t allocations = GetAllocationCount() - before;
+
+  std::cout << name << ": "
+            << static_cast<double>(allocations)
+               / static_cast<double>(num_boards)
+            << " allocations/board" << std::endl;
+}
+
+// Benchmarks every corpus runs. Each measurement is one board, going round
+// the corpus in order
+void BenchmarkSolver(const std::string& corpus_name, const Corpus& corpus) {
+  const auto& puzzles = corpus.puzzles;
+  const size_t size = puzzles.size();
+
+  auto solve = [&](size_t i) {
+    Grid board = puzzles[i % size];
+    return sudoku::Solve(&board);
+  };
+  auto count_solutions = [&](size_t i) {
+    return sudoku::CountSolutions(puzzles[i % size], 2);
+  };
+  auto grade = [&](size_t i) {
+    return sudoku::GradePuzzle(puzzles[i % size], corpus.solutions[i % size]);
+  };
+  auto solve_batch = [&](size_t) {
+    std::vector<Grid> boards = puzzles;
+    return sudoku::SolveBatch(&boards);
+  };
+
+  ReportAllocations(corpus_name + " solve", size, solve);
+  ReportAllocations(corpus_name + " uniqueness check", size, count_solutions);
+  ReportAllocations(corpus_name + " grade", size, grade);
+
+  // One batch of the whole corpus, shared between its boards
+  ReportAllocations(corpus_name + " solve batch", size, [&](size_t i) {
+    if (i == 0) {
+      solve_batch(i);
+    }
+  });
+
+  BENCHMARK_ADVANCED(corpus_name + " solve")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return solve(static_cast<size_t>(i)); });
+  };
+
+  BENCHMARK_ADVANCED(corpus_name + " uniqueness check")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) {
+      return count_solutions(static_cast<size_t>(i));
+    });
+  };
+
+  BENCHMARK_ADVANCED(corpus_name + " grade")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return grade(static_cast<size_t>(i)); });
+  };
+
+  // The whole corpus at once, so divide by its size for the time per board
+  BENCHMARK_ADVANCED(corpus_name + " solve batch of "
+                     + std::to_string(size))(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return solve_batch(static_cast<size_t>(i)); });
+  };
+}
+
+}  // namespace
+
+TEST_CASE("Solve bundled boards", "[solver][bank]") {
+  BenchmarkSolver("bank", LoadBank());
+}
+
+TEST_CASE("Solve hard boards", "[solver][hard]") {
+  BenchmarkSolver("hard", LoadCorpus("hard.txt"));
+}
+
+TEST_CASE("Solve generated boards", "[solver][generated]") {
+  BenchmarkSolver("generated", LoadCorpus("generated.txt"));
+}
+
+TEST_CASE("Generate boards", "[generator]") {
+  std::mt19937 rng(126);
+  auto generate = [&](size_t) {
+    Grid solution = sudoku::GenerateSolution(&rng);
+    return sudoku::GeneratePuzzle(solution, &rng);
+  };
+
+  ReportAllocations("generate", 20, generate);
+
+  BENCHMARK_ADVANCED("generate solution")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] { return sudoku::GenerateSolution(&rng); });
+  };
+
+  BENCHMARK_ADVANCED("generate puzzle")(Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return generate(static_cast<size_t>(i)); });
+  };
+
+  // The engine's generator against the standard one it replaced
+  BENCHMARK_ADVANCED("random transform (mt19937)")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] { return sudoku::RandomTransform(&rng); });
+  };
+
+  sudoku::Random engine_rng(126);
+  BENCHMARK_ADVANCED("random transform (Random)")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] { return sudoku::RandomTransform(&engine_rng); });
+  };
+
+  // Days from 2020 on, as the app would make them on demand
+  BENCHMARK_ADVANCED("daily challenge")(Catch::Benchmark::Chronometer meter) {
+    meter.measure([](int i) {
+      Grid puzzle;
+      Grid solution;
+      sudoku::GenerateDailyChallenge(18262 + i, &puzzle, &solution);
+      return puzzle;
+    });
+  };
+}
+
+TEST_CASE("Solve variants", "[solver][variant]") {
+  const Corpus corpus = LoadCorpus("generated.txt");
+  const auto& puzzles = corpus.puzzles;
+  const size_t size = puzzles.size();
+
+  // Classic rules with a row repeated solve the same boards, but through
+  // the variant search, which shows what the classic fast path saves
+  sudoku::VariantRules rules = sudoku::ClassicRules();
+  rules.groups.push_back(rules.groups[0]);
+  const sudoku::Variant peer_table(rules);
+  const sudoku::Variant& classic = *sudoku::Variant::GetClassic();
+
+  auto solve = [&](const sudoku::Variant& variant, size_t i) {
+    Grid board = puzzles[i % size];
+    return sudoku::Solve(&board, variant);
+  };
+
+  ReportAllocations("peer table solve", size, [&](size_t i) {
+    return solve(peer_table, i);
+  });
+
+  BENCHMARK_ADVANCED("classic rules solve")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) {
+      return solve(classic, static_cast<size_t>(i));
+    });
+  };
+
+  BENCHMARK_ADVANCED("peer table solve")(Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) {
+      return solve(peer_table, static_cast<size_t>(i));
+    });
+  };
+
+  sudoku::Random rng(126);
+  const sudoku::Variant diagonal(sudoku::DiagonalRules());
+  BENCHMARK_ADVANCED("generate diagonal puzzle")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      Grid solution = sudoku::GenerateSolution(&rng, diagonal);
+      return sudoku::GeneratePuzzle(solution, &rng, diagonal);
+    });
+  };
+
+  BENCHMARK_ADVANCED("generate killer puzzle")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&] {
+      Grid solution = sudoku::GenerateSolution(&rng);
+      const sudoku::Variant killer(
+          sudoku::KillerRules(sudoku::RandomCages(solution, &rng)));
+      return sudoku::GeneratePuzzle(solution, &rng, killer);
+    });
+  };
+}
+
+TEST_CASE("Import boards", "[import]") {
+  std::vector<std::string> json_boards;
+  std::vector<std::string> snapshots;
+  for (const auto& file : kBankFiles) {
+    json_boards.push_back(ReadFile(ci::app::getAssetPath(file).string()));
+
+    sudoku::Engine engine;
+    engine.CreateGame(file);
+    snapshots.push_back(engine.SerializeSnapshot());
+  }
+  const size_t size = kBankFiles.size();
+
+  auto parse_json = [&](size_t i) {
+    auto board_data = nlohmann::json::parse(json_boards[i % size]);
+    return board_data.at("board").get<Grid>()[0][0]
+           + board_data.at("solution").get<Grid>()[0][0];
+  };
+
+  sudoku::Engine engine;
+  auto load_json = [&](size_t i) {
+    engine.CreateGame(kBankFiles[i % size]);
+    return engine.GetEntry({0, 0});
+  };
+  auto load_snapshot = [&](size_t i) {
+    return engine.DeserializeSnapshot(snapshots[i % size]);
+  };
+
+  ReportAllocations("parse JSON", size, parse_json);
+  ReportAllocations("load JSON file", size, load_json);
+  ReportAllocations("restore binary snapshot", size, load_snapshot);
+
+  BENCHMARK_ADVANCED("parse JSON")(Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return parse_json(static_cast<size_t>(i)); });
+  };
+
+  BENCHMARK_ADVANCED("load JSON file")(Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return load_json(static_cast<size_t>(i)); });
+  };
+
+  BENCHMARK_ADVANCED("restore binary snapshot")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) {
+      return load_snapshot(static_cast<size_t>(i));
+    });
+  };
+}
+
+TEST_CASE("Leaderboard", "[leaderboard]") {
+  const std::string db_path = "benchmark_leaderboard.db";
+  std::remove(db_path.c_str());
+  sudoku::SqliteLeaderBoard leaderboard(db_path);
+
+  // Enough existing rows for queries to have something to sort through
+  constexpr size_t kNumRows = 10000;
+  auto insert = [&](size_t i) {
+    leaderboard.AddTimeToLeaderBoard(
+        sudoku::Player("player" + std::to_string(i % 100), 60000 + i * 7919),
+        "Standard", "Easy");
+  };
+  auto query = [&](size_t) {
+    return leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size();
+  };
+
+  for (size_t i = 0; i < kNumRows; i++) {
+    insert(i);
+  }
+
+  ReportAllocations("leaderboard insert", 100, insert);
+  ReportAllocations("leaderboard top 10", 100, query);
+
+  BENCHMARK_ADVANCED("leaderboard insert")(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { insert(static_cast<size_t>(i)); });
+  };
+
+  BENCHMARK_ADVANCED("leaderboard top 10 of "
+                     + std::to_string(kNumRows))(
+      Catch::Benchmark::Chronometer meter) {
+    meter.measure([&](int i) { return query(static_cast<size_t>(i)); });
+  };
+
+  std::remove(db_path.c_str());
+}
+
+TEST_CASE("Sharded leaderboard", "[leaderboard][shard]") {
+  const std::string db_path = "benchmark_sharded.db";
+  auto remove_files = [&db_path] {
+    std::remove(db_path.c_str());
+    for (const char* mode : sudoku::kLeaderBoardModes) {
+      for (const char* difficulty : sudoku::kLeaderBoardDifficulties) {
+        std::remove(sudoku::ShardedLeaderBoard::GetShardPath(
+            db_path, mode, difficulty).c_str());
+      }
+    }
+  };
+
+  // One thread per mode adding times at once. Neither the app nor the
+  // leaderboard server does this today; it's what the shards' locks allow
+  constexpr size_t kInsertsPerThread = 200;
+  using AddTime = std::function<void(const sudoku::Player&, const char*)>;
+  auto insert_concurrently = [](const AddTime& add_time) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (const char* mode : sudoku::kLeaderBoardModes) {
+      threads.emplace_back([&add_time, mode] {
+        for (size_t i = 0; i < kInsertsPerThread; i++) {
+          add_time(sudoku::Player("player", 60000 + i), mode);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    const std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(kInsertsPerThread * threads.size())
+           / elapsed.count();
+  };
+
+  // A single SqliteLeaderBoard isn't safe to share between threads, so
+  // they take turns with it
+  remove_files();
+  {
+    sudoku::SqliteLeaderBoard single(db_path);
+    std::mutex mutex;
+    std::cout << "unsharded leaderboard, concurrent inserts: "
+              << insert_concurrently([&single, &mutex](
+                     const sudoku::Player& player, const char* mode) {
+                   std::lock_guard<std::mutex> lock(mutex);
+                   single.AddTimeToLeaderBoard(player, mode, "Easy");
+                 })
+              << " inserts/s" << std::endl;
+  }
+
+  remove_files();
+  {
+    sudoku::ShardedLeaderBoard sharded(db_path);
+    std::cout << "sharded leaderboard, concurrent inserts: "
+              << insert_concurrently([&sharded](const sudoku::Player& player,
+                                                const char* mode) {
+                   sharded.AddTimeToLeaderBoard(player, mode, "Easy");
+                 })
+              << " inserts/s" << std::endl;
+
+    BENCHMARK("sharded leaderboard top 10") {
+      return sharded.RetrieveBestTimes(10, "Standard", "Easy").size();
+    };
+  }
+  remove_files();
+}
+
+TEST_CASE("Leaderboard archive", "[leaderboard][archive]") {
+  const std::string db_path = "benchmark_archive.db";
+  const std::string other_path = "benchmark_archive_other.db";
+  std::remove(db_path.c_str());
+  std::remove(other_path.c_str());
+
+  constexpr size_t kTimes = 50000;
+  sudoku::SqliteLeaderBoard leaderboard(db_path);
+  leaderboard.BeginBatch();
+  for (size_t i = 0; i < kTimes; i++) {
+    leaderboard.AddTimeToLeaderBoard(
+        sudoku::Player("player" + std::to_string(i % 500), 60000 + i),
+        "Standard", "Easy");
+  }
+  leaderboard.EndBatch();
+
+  auto get_rate = [](size_t num_times,
+                     std::chrono::steady_clock::time_point start) {
+    const std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_times) / elapsed.count();
+  };
+
+  std::stringstream archive;
+  auto start = std::chrono::steady_clock::now();
+  const size_t num_exported = sudoku::ExportLeaderBoard(&leaderboard,
+                                                        &archive);
+  std::cout << "leaderboard export: " << get_rate(num_exported, start)
+            << " times/s, " << archive.str().size() / num_exported
+            << " bytes/time" << std::endl;
+
+  sudoku::SqliteLeaderBoard other(other_path);
+  start = std::chrono::steady_clock::now();
+  const size_t num_imported = sudoku::ImportLeaderBoard(&archive, &other);
+  std::cout << "leaderboard import: " << get_rate(num_imported, start)
+            << " times/s" << std::endl;
+
+  std::remove(db_path.c_str());
+  std::remove(other_path.c_str());
+}
+
+TEST_CASE("Log leaderboard", "[leaderboard][log]") {
+  const std::string db_path = "benchmark_log.db";
+  const std::string log_path = "benchmark_leaderboard.log";
+  std::remove(db_path.c_str());
+  std::remove(log_path.c_str());
+
+  constexpr size_t kInserts = 2000;
+  auto insert = [](sudoku::LeaderBoard* leaderboard) {
+    std::mt19937 rng(126);
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kInserts; i++) {
+      leaderboard->AddTimeToLeaderBoard(
+          sudoku::Player("player", 60000 + rng() % 60000), "Standard", "Easy");
+    }
+
+    const std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(kInserts) / elapsed.count();
+  };
+
+  {
+    sudoku::SqliteLeaderBoard sqlite(db_path);
+    std::cout << "SQLite leaderboard inserts: " << insert(&sqlite)
+              << " inserts/s" << std::endl;
+    BENCHMARK("SQLite leaderboard top 10") {
+      return sqlite.RetrieveBestTimes(10, "Standard", "Easy").size();
+    };
+  }
+
+  {
+    sudoku::LogLeaderBoardOptions options;
+    options.sync_every_write = true;
+    sudoku::LogLeaderBoard synced(log_path, options);
+    std::cout << "log leaderboard inserts, synced: " << insert(&synced)
+              << " inserts/s" << std::endl;
+  }
+  std::remove(log_path.c_str());
+
+  sudoku::LogLeaderBoard leaderboard(log_path);
+  std::cout << "log leaderboard inserts: " << insert(&leaderboard)
+            << " inserts/s" << std::endl;
+  BENCHMARK("log leaderboard top 10") {
+    return leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size();
+  };
+  BENCHMARK("log leaderboard reopen") {
+    return sudoku::LogLeaderBoard(log_path).GetLogSize();
+  };
+
+  std::remove(db_path.c_str());
+  std::remove(log_path.c_str());
+}
+
+#ifdef __linux__
+TEST_CASE("Leaderboard server", "[leaderboard][server]") {
+  const std::string db_path = "benchmark_server.db";
+  std::remove(db_path.c_str());
+  sudoku::SqliteLeaderBoard leaderboard(db_path);
+
+  sudoku::LeaderBoardAddress address;
+  REQUIRE(sudoku::ParseLeaderBoardAddress("unix:benchmark_server.sock",
+                                          &address));
+  sudoku::LeaderBoardServer server(&leaderboard);
+  REQUIRE(server.Listen(address));
+  std::thread server_thread([&server] { server.Run(); });
+
+  sudoku::LeaderBoardClient client(address);
+  auto make_request = [](sudoku::LeaderBoardOp op, size_t i) {
+    sudoku::LeaderBoardRequest request;
+    request.op = op;
+    request.mode = "Standard";
+    request.difficulty = "Easy";
+    request.name = "player" + std::to_string(i % 100);
+    request.time = 60000 + i * 7919;
+    request.limit = 10;
+    return request;
+  };
+
+  // Requests a client sends in one go
+  constexpr size_t kPipelineDepth = 1000;
+  auto make_pipeline = [&](sudoku::LeaderBoardOp op) {
+    std::vector<sudoku::LeaderBoardRequest> requests;
+    for (size_t i = 0; i < kPipelineDepth; i++) {
+      requests.push_back(make_request(op, i));
+    }
+    return requests;
+  };
+  const auto inserts = make_pipeline(sudoku::LeaderBoardOp::kAddTime);
+  const auto queries = make_pipeline(sudoku::LeaderBoardOp::kBestTimes);
+
+  std::vector<sudoku::LeaderBoardResponse> responses;
+  for (size_t i = 0; i < 10; i++) {
+    REQUIRE(client.SendPipelined(inserts, &responses));
+  }
+
+  // Sustained throughput of one client pipelining requests at one server
+  // thread
+  for (const auto& pipeline : {std::make_pair("insert", &inserts),
+                               std::make_pair("top 10", &queries)}) {
+    constexpr size_t kRounds = 20;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kRounds; i++) {
+      client.SendPipelined(*pipeline.second, &responses);
+    }
+    const std::chrono::duration<double> elapsed
+        = std::chrono::steady_clock::now() - start;
+
+    std::cout << "leaderboard server " << pipeline.first << ": "
+              << static_cast<double>(kRounds * kPipelineDepth)
+                 / elapsed.count()
+              << " requests/s" << std::endl;
+  }
+
+  BENCHMARK("leaderboard server rank round trip") {
+    return client.RetrieveRank(90000, "Standard", "Easy");
+  };
+
+  BENCHMARK("leaderboard server top 10 round trip") {
+    return client.RetrieveBestTimes(10, "Standard", "Easy").size();
+  };
+
+  BENCHMARK("leaderboard server " + std::to_string(kPipelineDepth)
+            + " pipelined inserts") {
+    return client.SendPipelined(inserts, &responses);
+  };
+
+  server.Stop();
+  server_thread.join();
+  std::remove(db_path.c_str());
+}
+#endif  // __linux__
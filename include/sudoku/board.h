@@ -0,0 +1,76 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_BOARD_H_
+#define FINALPROJECT_SUDOKU_BOARD_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace sudoku {
+
+constexpr size_t kBoardSize = 9;
+
+// Width and height of one of the 3x3 boxes
+constexpr size_t kBoxSize = 3;
+
+// Number of rows, columns and boxes on the board
+constexpr size_t kNumUnits = 3 * kBoardSize;
+
+// Numbers on the board, with 0 for an empty box
+using Grid = std::array<std::array<int, kBoardSize>, kBoardSize>;
+
+// A set of numbers 1-9, where bit (num - 1) is set if num is in the set
+using DigitMask = uint16_t;
+using CandidateGrid = std::array<std::array<DigitMask, kBoardSize>, kBoardSize>;
+
+constexpr DigitMask kAllDigits = (1u << kBoardSize) - 1;
+
+inline DigitMask DigitBit(int num) {
+  return static_cast<DigitMask>(1u << (num - 1));
+}
+
+inline size_t CountDigits(DigitMask mask) {
+  size_t count = 0;
+  for (; mask != 0; mask = static_cast<DigitMask>(mask & (mask - 1))) {
+    count++;
+  }
+
+  return count;
+}
+
+// The smallest number in the set, or 0 if it's empty
+inline int LowestDigit(DigitMask mask) {
+  for (int num = 1; num <= static_cast<int>(kBoardSize); num++) {
+    if ((mask & DigitBit(num)) != 0) {
+      return num;
+    }
+  }
+
+  return 0;
+}
+
+inline size_t BoxIndex(size_t row, size_t col) {
+  return (row / kBoxSize) * kBoxSize + col / kBoxSize;
+}
+
+// The (row, col) positions of the boxes in each unit. Units 0-8 are rows,
+// 9-17 are columns and 18-26 are 3x3 boxes
+using Unit = std::array<std::pair<size_t, size_t>, kBoardSize>;
+const std::array<Unit, kNumUnits>& GetUnits();
+
+// For each empty box, the numbers that don't already appear in its row,
+// column or 3x3 box. Filled boxes have no candidates
+CandidateGrid ComputeCandidates(const Grid& entries);
+
+// Read a board written as one line of 81 boxes, row by row, with 0 or '.'
+// for empty boxes. Returns false if the line isn't a board
+bool ParseBoardLine(const std::string& line, Grid* board);
+
+// Write a board as one line, with 0 for empty boxes
+std::string FormatBoardLine(const Grid& board);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_BOARD_H_
@@ -0,0 +1,47 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_BOARD_BANK_H_
+#define FINALPROJECT_SUDOKU_BOARD_BANK_H_
+
+#include <sudoku/board.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+// Read a board and its solution from a .json asset file. Returns false,
+// leaving both alone, if the file can't be read or parsed, or doesn't hold
+// a board of numbers from 0 to 9 and a full solution
+bool ReadBoardFile(const std::string& file, Grid* board, Grid* solution);
+
+// ReadBoardFile for a file already found on disk
+bool ReadBoardPath(const std::string& path, Grid* board, Grid* solution);
+
+// Boards read from their asset files up front, so starting a game doesn't
+// have to touch the disk
+class BoardBank {
+ public:
+  // Where each asset file is on disk, for the constructor. Cinder's asset
+  // lookup isn't safe to use from two threads, so call this on the main one
+  static std::map<std::string, std::string> FindPaths(
+      const std::vector<std::string>& files);
+
+  // Reads every file from its path. Nothing is shared, so this can run on a
+  // worker thread
+  explicit BoardBank(const std::map<std::string, std::string>& paths);
+
+  // Returns false if the file isn't in the bank
+  bool GetBoard(const std::string& file, Grid* board, Grid* solution) const;
+
+  size_t GetSize() const;
+
+ private:
+  // File name to board and solution
+  std::map<std::string, std::pair<Grid, Grid>> boards_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_BOARD_BANK_H_
@@ -0,0 +1,74 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_CANDIDATE_KERNEL_H_
+#define FINALPROJECT_SUDOKU_CANDIDATE_KERNEL_H_
+
+#include <sudoku/board.h>
+
+#include <array>
+
+namespace sudoku {
+
+// Each board row is padded to 16 masks so that it fills one 256-bit register
+constexpr size_t kMaskLanes = 16;
+
+// A DigitMask for every box of the board, one bit for a filled box.
+// Lanes past kBoardSize must always be 0
+struct alignas(32) MaskBoard {
+  std::array<std::array<DigitMask, kMaskLanes>, kBoardSize> cells;
+};
+
+struct CandidateScan {
+  // Numbers that could go in each empty box, 0 for filled boxes
+  MaskBoard candidates;
+
+  // The number an empty box is forced to hold because it's a naked or hidden
+  // single, or 0 if it isn't forced
+  MaskBoard singles;
+
+  // True if the board can't be solved: a number appears twice in a unit, an
+  // empty box has no candidates, a box is forced to hold two numbers, or a
+  // unit has nowhere left to put a missing number
+  bool is_contradiction;
+};
+
+// Instruction sets the kernel has implementations for
+enum class KernelIsa {
+  kScalar,
+  kSse41,
+  kAvx2,
+};
+
+// The fastest implementation this CPU supports, picked when first needed
+KernelIsa GetBestKernelIsa();
+
+// The implementation ScanCandidates uses. It can be lowered for testing and
+// benchmarking, but is never set higher than the CPU supports
+KernelIsa GetKernelIsa();
+void SetKernelIsa(KernelIsa isa);
+
+MaskBoard ToMaskBoard(const Grid& grid);
+
+// Compute the candidates and singles for every box of the board at once
+void ScanCandidates(const MaskBoard& placed, CandidateScan* scan);
+
+// Up to kMaskLanes separate boards, stored box by box so that one register
+// holds the same box of every board. Lane i of each box belongs to board i
+struct alignas(32) LaneBoards {
+  std::array<std::array<DigitMask, kMaskLanes>, kBoardSize * kBoardSize> cells;
+
+  // Set by PropagateLanes to the numbers that could go in each empty box
+  std::array<std::array<DigitMask, kMaskLanes>, kBoardSize * kBoardSize>
+      candidates;
+
+  // 0xFFFF in the lanes of boards that have no solution
+  std::array<DigitMask, kMaskLanes> contradictions;
+};
+
+// Place naked and hidden singles on all of the boards in lockstep until none
+// are left, marking any board that turns out to have no solution. Unused
+// lanes can be left empty
+void PropagateLanes(LaneBoards* boards);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_CANDIDATE_KERNEL_H_
@@ -0,0 +1,39 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_CANONICAL_H_
+#define FINALPROJECT_SUDOKU_CANONICAL_H_
+
+#include <sudoku/board.h>
+
+#include <string>
+#include <unordered_set>
+
+namespace sudoku {
+
+// Map a board to the one representative shared by all of its symmetric
+// variants (relabeled numbers, swapped bands/stacks, rows/columns swapped
+// within a band/stack, and transposition). Two boards are the same puzzle in
+// disguise exactly when their canonical forms are equal
+Grid GetCanonicalForm(const Grid& board);
+
+// Pack a board into a short string, two boxes per byte, for use as a key
+std::string PackBoard(const Grid& board);
+
+// Set of puzzles where symmetric variants count as the same puzzle
+class PuzzleIndex {
+ public:
+  // Add a puzzle to the index. Returns false if it, or a variant of it,
+  // was already there
+  bool Insert(const Grid& board);
+
+  bool Contains(const Grid& board) const;
+  size_t Size() const;
+  void Clear();
+
+ private:
+  // Packed canonical forms of the indexed puzzles
+  std::unordered_set<std::string> keys_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_CANONICAL_H_
@@ -0,0 +1,33 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_DAILY_CHALLENGE_H_
+#define FINALPROJECT_SUDOKU_DAILY_CHALLENGE_H_
+
+#include <sudoku/board.h>
+
+#include <cstdint>
+#include <string>
+
+namespace sudoku {
+
+// Days since 1970-01-01 in UTC, so every machine agrees which day it is and
+// days line up with the daily leaderboard
+int64_t GetChallengeDay(int64_t unix_time);
+
+// The day as YYYY-MM-DD
+std::string FormatChallengeDay(int64_t day);
+
+// The day's puzzle, generated from a seed made from the day. Every machine
+// gets the same puzzle for the same day without asking anyone, in a few
+// milliseconds
+void GenerateDailyChallenge(int64_t day, Grid* puzzle, Grid* solution);
+
+// The puzzle id a day's challenge is saved under in place of a board file,
+// e.g. "daily_18383"
+std::string GetChallengeId(int64_t day);
+
+// Returns false if the id isn't a daily challenge's
+bool ParseChallengeId(const std::string& id, int64_t* day);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_DAILY_CHALLENGE_H_
@@ -2,7 +2,20 @@
 #ifndef FINALPROJECT_SUDOKU_ENGINE_H_
 #define FINALPROJECT_SUDOKU_ENGINE_H_
 
+#include <sudoku/board.h>
+#include <sudoku/board_bank.h>
+#include <sudoku/canonical.h>
+#include <sudoku/game_clock.h>
+#include <sudoku/hint.h>
+#include <sudoku/random.h>
+#include <sudoku/transform.h>
+#include <sudoku/variant.h>
+
 #include <array>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <ratio>
@@ -13,8 +26,6 @@ using std::pair;
 
 namespace sudoku {
 
-constexpr size_t kBoardSize = 9;
-
 class Engine {
 
  public:
@@ -35,16 +46,70 @@ class Engine {
   enum class GameMode {
     kStandard,
     kTimeTrial,
-    kTimeAttack
+    kTimeAttack,
+    kDailyChallenge
   };
 
+  // Boards played in a row in Time Trial and Time Attack
+  static constexpr int kBoardsPerTimedGame = 3;
+
+  // Seeded from the OS, so each engine deals boards in its own order
   Engine();
 
-  // Loads a random board and fill out current_entries_ with starting numbers
+  // Seeded with `seed`, so the boards and their symmetries come out the
+  // same every time
+  explicit Engine(uint64_t seed);
+
+  // Loads a random board and fill out current_entries_ with starting numbers.
+  // Boards that are variants of one already served are skipped until every
+  // board of the difficulty has been played. The board is then shuffled with
+  // a random symmetry so each stored puzzle looks different every time.
+  // In Time Trial and Time Attack, the game's next board is prepared too
   void CreateGame();
 
-  // Create a game with a specific board, only used for testing
-  void CreateGame(std::string filepath);
+  // Create a game with a specific board, only used for testing. Returns
+  // false, leaving the game as it was, if the board can't be read
+  bool CreateGame(std::string filepath);
+
+  // Start the day's daily challenge (see daily_challenge.h), the same
+  // puzzle on every machine. How hard the puzzle grades is kept apart from
+  // the difficulty, which stays as the player picked it for other games
+  void CreateDailyChallenge(int64_t day);
+
+  // The day of the daily challenge being played, and how hard it grades
+  int64_t GetChallengeDay() const;
+  Difficulty GetChallengeDifficulty() const;
+
+  // Start a game generated under a variant's rules (see variant.h). Its
+  // puzzle has as few numbers as the rules allow, whatever the difficulty,
+  // which is only what the game is filed under. Returns false, leaving the
+  // game as it was, if the rules aren't well formed or have no solution.
+  // The rules can't depend on the solution, so killer puzzles come from
+  // CreateKillerGame instead
+  bool CreateVariantGame(std::shared_ptr<const Variant> variant);
+
+  // Start a killer puzzle, with cages drawn around a random solution
+  void CreateKillerGame();
+
+  // The rules the board is played by, classic unless a variant game was
+  // created
+  const Variant& GetVariant() const;
+
+  // Switch a Time Trial or Time Attack game to its next board, one
+  // difficulty up in Time Attack. The board is prepared on a worker thread
+  // while the last one is played, so switching is only a copy. Waiting for
+  // it, if it isn't ready yet, is kept off the clock
+  void StartNextBoard();
+
+  // Whether the next board of a timed game is being prepared, or is ready
+  bool HasNextBoard() const;
+
+  // Every board file CreateGame might pick from
+  std::vector<std::string> GetBoardFiles() const;
+
+  // Take boards from `bank` instead of reading their files when a game is
+  // created. Boards missing from the bank are still read from disk
+  void UseBoardBank(std::shared_ptr<const BoardBank> bank);
 
   int GetEntry(pair<int, int> entry) const;
   void SetEntry(pair<int, int> entry, int num);
@@ -59,6 +124,10 @@ class Engine {
   // Erase all pencil marks for a given board position
   void ClearPencilMarks(pair<int, int> entry);
 
+  // Replace the pencil marks of every empty box with the numbers that
+  // could still go there
+  void AutoPencil();
+
   // Whether the game is in pencil mode
   bool IsPenciling() const;
 
@@ -80,30 +149,96 @@ class Engine {
   // Put the number from the solution in current_entries_
   void FillInCorrectEntry(pair<int, int> entry);
 
-  // Update the EntryState's of the board's current entries
+  // Find the simplest next step from the current entries and pencil marks
+  Hint GetHint() const;
+
+  // Update the EntryState's of the board's current entries against the
+  // game's rules: an entry is wrong if it clashes with another, or breaks a
+  // cage or the numbers its box can hold
   void CheckBoard();
 
-  // Return true if the current entries exactly match the solution
+  // Return true if the board is full and breaks none of the game's rules
   bool IsGameOver() const;
 
-  int GetGameTime() const;
-  void SetStartTime(std::chrono::time_point<std::chrono::system_clock> time);
+  // Time played so far in milliseconds, not counting time spent paused
+  size_t GetGameTime() const;
+
+  // Start timing a new game from zero
+  void StartClock();
+
+  // Stop and restart the game timer, e.g. while the game is hidden
+  void PauseClock();
+  void ResumeClock();
+  bool IsClockPaused() const;
 
-  // Sets game time to the difference between the current and start times
-  void UpdateGameTime();
+  // Time taken for each finished board of the game, in order
+  const std::vector<GameClock::Milliseconds>& GetSplitTimes() const;
 
   GameMode GetGameMode() const;
   void SetGameMode(GameMode mode);
 
+  // Boards played in a row before the game is over
+  int GetBoardsPerGame() const;
+
   int GetGamesCompleted() const;
+
+  // Count a finished board and record its split time
   void IncreaseGamesCompleted();
 
   // Clear instance variables
   void ResetGame();
 
+  // Encode the game in progress as a compact, versioned binary snapshot
+  std::string SerializeSnapshot() const;
+
+  // Restore a game from SerializeSnapshot's output. If the data is corrupt or
+  // from an unsupported version, returns false and leaves the engine untouched
+  bool DeserializeSnapshot(const std::string& data);
+
+  // Write/read a snapshot to/from a file. Saving is a single write so it's
+  // cheap enough to do after every move, and replaces the old file whole,
+  // so a crash while saving leaves the last snapshot readable
+  bool SaveSnapshot(const std::string& filepath) const;
+  bool LoadSnapshot(const std::string& filepath);
+
  private:
-  // Gets data from a .json file about the starting board and solution
-  void ImportGameBoard();
+  // A board ready to be played, already disguised with a random symmetry
+  struct PreparedBoard {
+    std::string path;
+    Difficulty difficulty;
+    Grid entries;
+    Grid solution;
+    std::shared_ptr<const Variant> variant = Variant::GetClassic();
+  };
+
+  // Pick one of the board files that isn't in `served`, or any of them once
+  // they've all been served, and disguise it. Files missing from the bank
+  // are read from the paths they were found at. Only touches what it's
+  // given, so it can run on another thread
+  static std::unique_ptr<PreparedBoard> PrepareBoard(
+      Difficulty difficulty, const std::map<std::string, std::string>& paths,
+      const PuzzleIndex& served, const BoardBank* bank, Random* rng);
+
+  // The same with the engine's own boards
+  std::unique_ptr<PreparedBoard> PrepareBoard(Difficulty difficulty);
+  const std::vector<std::string>& GetBoardFiles(Difficulty difficulty) const;
+
+  // Make the board the one being played, with no entries checked or
+  // penciled in, and count it as served
+  void SetBoard(const PreparedBoard& board);
+
+  // The difficulty a puzzle's hardest step belongs to
+  static Difficulty GradeDifficulty(const Grid& puzzle, const Grid& solution);
+
+  // Start preparing the board after this one on a worker thread, if the
+  // game has one
+  void PrefetchNextBoard();
+  Difficulty GetNextBoardDifficulty() const;
+
+  // Gets data from a .json file about the starting board and solution.
+  // Returns false, leaving both alone, if the file can't be read
+  bool ImportGameBoard(const std::string& file, Grid* entries,
+                       Grid* solution) const;
 
   // File path to the game's .json file
   std::string board_path_;
@@ -111,10 +246,12 @@ class Engine {
   // General info about the game
   Difficulty difficulty_;
   GameMode game_mode_;
+  int64_t challenge_day_;
+  Difficulty challenge_difficulty_;
   bool is_penciling_;
-  int game_time_;
   int games_completed_;
-  std::chrono::time_point<std::chrono::system_clock> start_time_;
+  GameClock clock_;
+  std::shared_ptr<const Variant> variant_;
 
   // Info about each board position
   array<array<int, kBoardSize>, kBoardSize> current_entries_;
@@ -122,10 +259,23 @@ class Engine {
   array<array<int, kBoardSize>, kBoardSize> solution_;
   array<array<array<bool, kBoardSize>,kBoardSize>, kBoardSize> pencil_marks_;
 
+  // Puzzles played since the app started, so they aren't repeated
+  PuzzleIndex served_puzzles_;
+
   // File paths of possible games
   std::vector<std::string> easy_boards_;
   std::vector<std::string> medium_boards_;
   std::vector<std::string> hard_boards_;
+
+  // The next board of a timed game, if it's being prepared. Invalid
+  // otherwise. Shared so engines can still be copied
+  std::shared_future<std::shared_ptr<const PreparedBoard>> next_board_;
+
+  // Boards already read from disk, if they've been loaded yet
+  std::shared_ptr<const BoardBank> board_bank_;
+
+  // Picks each new board and the symmetry used to disguise it
+  Random rng_;
 };
 }  // namespace sudoku
 
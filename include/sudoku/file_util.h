@@ -0,0 +1,24 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_FILE_UTIL_H_
+#define FINALPROJECT_SUDOKU_FILE_UTIL_H_
+
+#include <string>
+
+namespace sudoku {
+
+// Replace `path` with `replacement`, which is in the same directory. Readers
+// see either the old file or the new one, never part of each
+bool ReplaceFile(const std::string& replacement, const std::string& path);
+
+// Make a rename in the directory holding `path` survive the machine going
+// down, not just the app
+bool SyncDirectory(const std::string& path);
+
+// Write `data` to a file beside `path`, wait for it to reach the disk, and
+// then replace `path` with it, so a crash part way leaves the old file
+// whole. Returns false, leaving `path` alone, if any step fails
+bool WriteFileAtomically(const std::string& path, const std::string& data);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_FILE_UTIL_H_
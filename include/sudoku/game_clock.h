@@ -0,0 +1,58 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_GAME_CLOCK_H_
+#define FINALPROJECT_SUDOKU_GAME_CLOCK_H_
+
+#include <chrono>
+#include <vector>
+
+namespace sudoku {
+
+// Measures how long a game has been played. Uses the monotonic steady_clock
+// so changes to the wall clock (NTP, DST) can't corrupt times
+class GameClock {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::milliseconds;
+
+  GameClock();
+
+  // Clear the elapsed time and splits and start running from zero
+  void Start();
+
+  // Stop counting time until Resume is called. Does nothing if already paused
+  void Pause();
+  void Resume();
+  bool IsPaused() const;
+
+  // Record the time since the previous split (or the start) as the time for
+  // one finished board
+  void Split();
+
+  Milliseconds GetElapsed() const;
+  const std::vector<Milliseconds>& GetSplits() const;
+
+  // Restart the clock as if `elapsed` had already passed with the given
+  // splits, e.g. when resuming a saved game
+  void Restore(Milliseconds elapsed,
+               const std::vector<Milliseconds>& splits,
+               bool paused);
+
+  // Stop the clock and clear the elapsed time and splits
+  void Reset();
+
+ private:
+  Clock::duration GetRawElapsed() const;
+
+  // Time accumulated before the clock was last resumed
+  Clock::duration accumulated_;
+  Clock::time_point resumed_at_;
+  bool is_paused_;
+
+  // Elapsed time when the last split was taken
+  Clock::duration last_split_;
+  std::vector<Milliseconds> splits_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_GAME_CLOCK_H_
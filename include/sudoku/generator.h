@@ -0,0 +1,169 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_GENERATOR_H_
+#define FINALPROJECT_SUDOKU_GENERATOR_H_
+
+#include <sudoku/board.h>
+#include <sudoku/random.h>
+#include <sudoku/solver.h>
+#include <sudoku/variant.h>
+
+#include <array>
+#include <numeric>
+#include <vector>
+
+namespace sudoku {
+
+// Most boxes a cage from RandomCages can have
+constexpr size_t kMaxCageSize = 4;
+
+// Number of random numbers placed before the solver fills in the rest of a
+// new solution. Few enough that they almost never clash, and enough that the
+// solver's preference for low numbers doesn't show
+constexpr size_t kSeedGivens = 11;
+
+// A random complete board. Rng is any standard random number engine, and
+// the same engine and seed give the same board on every machine
+template <typename Rng>
+Grid GenerateSolution(Rng* rng);
+
+// A puzzle with only one solution, `solution`, made by removing as many
+// numbers as possible, in a random order
+template <typename Rng>
+Grid GeneratePuzzle(const Grid& solution, Rng* rng);
+
+// Remove the numbers of `solution` one at a time, in the order of `cells`
+// (row * kBoardSize + col), skipping any whose removal would let the puzzle
+// have a second solution
+Grid RemoveGivens(const Grid& solution,
+                  const std::array<size_t, kBoardSize * kBoardSize>& cells);
+
+// The same under a variant's rules, which must have a solution or
+// GenerateSolution never returns. The puzzle's solution must follow them,
+// and it's the only one under them
+template <typename Rng>
+Grid GenerateSolution(Rng* rng, const Variant& variant);
+template <typename Rng>
+Grid GeneratePuzzle(const Grid& solution, Rng* rng, const Variant& variant);
+Grid RemoveGivens(const Grid& solution,
+                  const std::array<size_t, kBoardSize * kBoardSize>& cells,
+                  const Variant& variant);
+
+// Split the board into killer cages, each of 1 to kMaxCageSize boxes side by
+// side with no number repeated, adding up to what `solution` has in them
+template <typename Rng>
+std::vector<Cage> RandomCages(const Grid& solution, Rng* rng);
+
+namespace detail {
+
+template <typename Rng>
+std::array<size_t, kBoardSize * kBoardSize> RandomCellOrder(Rng* rng) {
+  std::array<size_t, kBoardSize * kBoardSize> cells;
+  std::iota(cells.begin(), cells.end(), 0);
+  RandomShuffle(cells.begin(), cells.end(), rng);
+
+  return cells;
+}
+
+}  // namespace detail
+
+template <typename Rng>
+Grid GenerateSolution(Rng* rng) {
+  return GenerateSolution(rng, *Variant::GetClassic());
+}
+
+template <typename Rng>
+Grid GeneratePuzzle(const Grid& solution, Rng* rng) {
+  return GeneratePuzzle(solution, rng, *Variant::GetClassic());
+}
+
+template <typename Rng>
+Grid GenerateSolution(Rng* rng, const Variant& variant) {
+  while (true) {
+    Grid board{};
+    const auto cells = detail::RandomCellOrder(rng);
+
+    bool is_stuck = false;
+    for (size_t i = 0; i < kSeedGivens && !is_stuck; i++) {
+      size_t row = cells[i] / kBoardSize;
+      size_t col = cells[i] % kBoardSize;
+      DigitMask candidates = ComputeCandidates(board, variant)[row][col];
+      if (candidates == 0) {
+        is_stuck = true;
+        continue;
+      }
+
+      // Pick one of the candidates, dropping the lower ones until it's next
+      auto pick = RandomIndex(CountDigits(candidates), rng);
+      for (; pick > 0; pick--) {
+        candidates = static_cast<DigitMask>(candidates & (candidates - 1));
+      }
+      board[row][col] = LowestDigit(candidates);
+    }
+
+    if (!is_stuck && Solve(&board, variant)) {
+      return board;
+    }
+  }
+}
+
+template <typename Rng>
+Grid GeneratePuzzle(const Grid& solution, Rng* rng, const Variant& variant) {
+  return RemoveGivens(solution, detail::RandomCellOrder(rng), variant);
+}
+
+template <typename Rng>
+std::vector<Cage> RandomCages(const Grid& solution, Rng* rng) {
+  constexpr size_t kNumCells = kBoardSize * kBoardSize;
+  std::array<bool, kNumCells> is_caged{};
+  std::vector<Cage> cages;
+
+  for (size_t start : detail::RandomCellOrder(rng)) {
+    if (is_caged[start]) {
+      continue;
+    }
+
+    Cage cage{{start}, 0};
+    is_caged[start] = true;
+    auto used = DigitBit(solution[start / kBoardSize][start % kBoardSize]);
+    const size_t size = 2 + RandomIndex(kMaxCageSize - 1, rng);
+
+    // Grow into a random free box next to the cage, if any can join it
+    while (cage.cells.size() < size) {
+      std::vector<size_t> options;
+      for (size_t cell : cage.cells) {
+        size_t row = cell / kBoardSize;
+        size_t col = cell % kBoardSize;
+        for (size_t next : {row > 0 ? cell - kBoardSize : kNumCells,
+                            row + 1 < kBoardSize ? cell + kBoardSize
+                                                 : kNumCells,
+                            col > 0 ? cell - 1 : kNumCells,
+                            col + 1 < kBoardSize ? cell + 1 : kNumCells}) {
+          if (next != kNumCells && !is_caged[next]
+              && (used & DigitBit(solution[next / kBoardSize]
+                                          [next % kBoardSize])) == 0) {
+            options.push_back(next);
+          }
+        }
+      }
+      if (options.empty()) {
+        break;
+      }
+
+      size_t next = options[RandomIndex(options.size(), rng)];
+      cage.cells.push_back(next);
+      is_caged[next] = true;
+      used |= DigitBit(solution[next / kBoardSize][next % kBoardSize]);
+    }
+
+    for (size_t cell : cage.cells) {
+      cage.sum += solution[cell / kBoardSize][cell % kBoardSize];
+    }
+    cages.push_back(cage);
+  }
+
+  return cages;
+}
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_GENERATOR_H_
@@ -0,0 +1,64 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_HINT_H_
+#define FINALPROJECT_SUDOKU_HINT_H_
+
+#include <sudoku/board.h>
+#include <sudoku/variant.h>
+
+#include <string>
+#include <utility>
+
+namespace sudoku {
+
+// Solving techniques, from simplest to hardest
+enum class Technique {
+  kNone,
+  kIncorrectEntry,    // A box was filled in with the wrong number
+  kFullHouse,         // The last empty box in a row, column or 3x3 box
+  kNakedSingle,       // Only one number can go in a box
+  kHiddenSingle,      // A number can only go in one box of a unit
+  kLockedCandidates,  // A number's spots in a unit all share another unit
+  kNakedPair,         // Two boxes in a unit can only hold the same two numbers
+  kSolution,          // No technique applies, so the answer is looked up
+};
+
+struct Hint {
+  // Technique that shows which number goes in the box
+  Technique technique;
+
+  // Technique needed first to rule out candidates, or kNone if the
+  // placement can be seen straight from the board
+  Technique elimination;
+
+  std::pair<int, int> entry;
+  int num;
+};
+
+// Find the simplest next step for the player. Wrong entries are pointed out
+// first. Pencil marks that still include the right number narrow down the
+// candidates for their box, the way the player would use them
+Hint FindHint(const Grid& entries,
+              const Grid& solution,
+              const CandidateGrid& pencil_marks);
+
+// FindHint under a variant's rules. Classic rules get every technique;
+// other variants get singles, with hidden ones only in groups holding every
+// number, before the answer is looked up
+Hint FindHint(const Grid& entries,
+              const Grid& solution,
+              const CandidateGrid& pencil_marks,
+              const Variant& variant);
+
+// The hardest technique needed to solve the puzzle by following hints from
+// the start, as a measure of its difficulty. kSolution means some step can't
+// be found with any of the techniques
+Technique GradePuzzle(const Grid& puzzle, const Grid& solution);
+
+// Short explanation of a hint for showing to the player,
+// e.g. "Hidden Single after Locked Candidates"
+std::string GetTechniqueName(Technique technique);
+std::string DescribeHint(const Hint& hint);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_HINT_H_
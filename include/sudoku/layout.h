@@ -0,0 +1,68 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_LAYOUT_H_
+#define FINALPROJECT_SUDOKU_LAYOUT_H_
+
+#include <cinder/Vector.h>
+
+#include <sudoku/board.h>
+
+#include <utility>
+
+namespace sudoku {
+
+// Top left and bottom right corners of a box
+using Box = std::pair<ci::vec2, ci::vec2>;
+
+// The screens are laid out in a fixed square design space, kDesignSize units
+// across. Layout fits that square in the middle of a window of any size and
+// pixel density, and maps points between the two. Everything is worked out
+// in Resize, so drawing and hit testing never redo the math
+class Layout {
+ public:
+  static constexpr float kDesignSize = 800;
+
+  // Size of the board in the middle of the game screen
+  static constexpr float kGridSize = 600;
+
+  // Laid out for a kDesignSize window at one pixel per point
+  Layout();
+
+  // `window_size` is in points, and `content_scale` is pixels per point
+  void Resize(const ci::ivec2& window_size, float content_scale);
+
+  // Window points per design unit, and where the design space's top left
+  // corner is in the window
+  float GetScale() const;
+  ci::vec2 GetOrigin() const;
+
+  // Framebuffer pixels per design unit, e.g. for rendering text at the
+  // screen's real resolution
+  float GetPixelScale() const;
+
+  ci::vec2 ToDesign(const ci::vec2& window_point) const;
+  ci::vec2 ToWindow(const ci::vec2& design_point) const;
+
+  // Corners and center of the design space
+  const Box& GetBounds() const;
+  ci::vec2 GetCenter() const;
+
+  // The game board, in design units
+  float GetTileSize() const;
+  Box GetCellBox(size_t row, size_t col) const;
+
+  // Which board box the design space point is in, if any
+  bool GetCellAt(const ci::vec2& design_point, std::pair<int, int>* cell) const;
+
+ private:
+  float scale_;
+  float content_scale_;
+  ci::vec2 origin_;
+
+  Box bounds_;
+  ci::vec2 grid_origin_;
+  float tile_size_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_LAYOUT_H_
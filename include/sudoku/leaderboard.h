@@ -1,34 +1,224 @@
 #ifndef FINALPROJECT_LEADERBOARD_H
 #define FINALPROJECT_LEADERBOARD_H
 
-#include "leaderboard.h"
 #include "player.h"
 
 #include <sqlite_modern_cpp.h>
 
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace sudoku {
 
+// The stretches of time a leaderboard ranks times over. Days and weeks are
+// in UTC, and weeks start on Monday
+enum class LeaderBoardWindow {
+  kAllTime = 0,
+  kDaily = 1,
+  kWeekly = 2,
+};
+
+// How many of the best times are kept for each day or week
+constexpr size_t kWindowBestTimes = 100;
+
+// The start of the window `unix_time` falls in, in seconds since the Unix
+// epoch. 0 for kAllTime
+int64_t GetWindowStart(LeaderBoardWindow window, int64_t unix_time);
+
+// Seconds since the Unix epoch
+int64_t GetUnixTime();
+
+// Called with each time on a leaderboard, and its mode and difficulty
+using TimeVisitor = std::function<void(const Player&, const std::string&,
+                                       const std::string&)>;
+
+// Where finished games' times are kept, one list per mode and difficulty
 class LeaderBoard {
  public:
-  // Creates a new leaderboard table if it doesn't already exist.
-  explicit LeaderBoard(const std::string& db_path);
+  virtual ~LeaderBoard() = default;
 
   // Adds a player to the leaderboard.
-  void AddTimeToLeaderBoard(const Player&,
-                            std::string mode,
-                            std::string difficulty);
+  virtual void AddTimeToLeaderBoard(const Player&,
+                                    std::string mode,
+                                    std::string difficulty) = 0;
 
   // Returns a list of the players with the highest scores, in decreasing order.
   // The size of the list should be no greater than `limit`.
+  virtual std::vector<Player> RetrieveBestTimes(const size_t limit,
+                                                std::string mode,
+                                                std::string difficulty) = 0;
+
+  // The best times submitted in the current day or week, fastest first, up
+  // to kWindowBestTimes of them. Leaderboards that only keep all-time bests
+  // return nothing for the other windows
+  virtual std::vector<Player> RetrieveWindowBestTimes(
+      LeaderBoardWindow window, const size_t limit, std::string mode,
+      std::string difficulty) {
+    if (window == LeaderBoardWindow::kAllTime) {
+      return RetrieveBestTimes(limit, mode, difficulty);
+    }
+    return {};
+  }
+
+  // The place `time` would take on the leaderboard, counting from 1. Ties go
+  // to the time already there
+  virtual size_t RetrieveRank(size_t time,
+                              std::string mode,
+                              std::string difficulty) = 0;
+
+  // The player's own best times, fastest first, and their most recent
+  // times, latest first. Leaderboards that don't keep players' profiles
+  // return nothing
+  virtual std::vector<Player> RetrievePlayerBestTimes(
+      const std::string& /* name */, size_t /* limit */,
+      std::string /* mode */, std::string /* difficulty */) {
+    return {};
+  }
+  virtual std::vector<Player> RetrievePlayerRecentTimes(
+      const std::string& /* name */, size_t /* limit */,
+      std::string /* mode */, std::string /* difficulty */) {
+    return {};
+  }
+
+  // The player's record, kept up to date as times are added so it can be
+  // read without going through their times
+  virtual PlayerStats RetrievePlayerStats(const std::string& /* name */,
+                                          std::string /* mode */,
+                                          std::string /* difficulty */) {
+    return {};
+  }
+
+  // Whether this exact time is already on the leaderboard: the same player,
+  // time and submission date, under the same mode and difficulty.
+  // Leaderboards that can't tell say it isn't, as by default
+  virtual bool HasTime(const Player& /* player */,
+                       const std::string& /* mode */,
+                       const std::string& /* difficulty */) {
+    return false;
+  }
+
+  // Group the writes made until EndBatch, e.g. into one transaction, for
+  // callers making lots of them at once. Does nothing by default. EndBatch
+  // returns false if the writes couldn't all be saved
+  virtual void BeginBatch() {}
+  virtual bool EndBatch() { return true; }
+
+  // End the batch, undoing its writes if the leaderboard can. Otherwise
+  // they're kept, as they are by default
+  virtual void CancelBatch() { EndBatch(); }
+
+  // Visit every time, in no particular order, without holding them all in
+  // memory at once. Returns false if the leaderboard can't list its times,
+  // as by default
+  virtual bool ForEachTime(const TimeVisitor& /* visit */) { return false; }
+};
+
+// A leaderboard kept in an SQLite database file. Each player's name is
+// stored once, in a profile with an id, and their times refer to it by id.
+// The current day's and week's best times are kept in a table of their own,
+// trimmed to kWindowBestTimes, and a window's rows are deleted as soon as a
+// time is submitted in the next one
+class SqliteLeaderBoard : public LeaderBoard {
+ public:
+  // Creates the players and leaderboard tables if they don't already exist,
+  // and brings older databases up to date
+  explicit SqliteLeaderBoard(const std::string& db_path);
+
+  void AddTimeToLeaderBoard(const Player&,
+                            std::string mode,
+                            std::string difficulty) override;
+
   std::vector<Player> RetrieveBestTimes(const size_t limit,
                                         std::string mode,
-                                        std::string difficulty);
+                                        std::string difficulty) override;
+
+  std::vector<Player> RetrieveWindowBestTimes(
+      LeaderBoardWindow window, const size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  size_t RetrieveRank(size_t time,
+                      std::string mode,
+                      std::string difficulty) override;
+
+  std::vector<Player> RetrievePlayerBestTimes(
+      const std::string& name, size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  std::vector<Player> RetrievePlayerRecentTimes(
+      const std::string& name, size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  PlayerStats RetrievePlayerStats(const std::string& name,
+                                  std::string mode,
+                                  std::string difficulty) override;
+
+  bool HasTime(const Player& player, const std::string& mode,
+               const std::string& difficulty) override;
+
+  void BeginBatch() override;
+  bool EndBatch() override;
+  void CancelBatch() override;
+
+  bool ForEachTime(const TimeVisitor& visit) override;
+
+  // The id of the player's profile, adding one if they don't have one yet.
+  // Returns 0 if the database can't be read or written
+  int64_t GetPlayerId(const std::string& name);
+
+  // The name on the profile, or "" if there's no such profile
+  std::string GetPlayerName(int64_t id);
+
+  // The last row id of `source` whose times have been copied in, or 0.
+  // Set in the same batch as the times themselves, so a copy that's cut
+  // short can carry on from where it stopped without adding any twice
+  int64_t GetCopiedRowId(const std::string& source);
+  void SetCopiedRowId(const std::string& source, int64_t rowid);
 
  private:
+  // The id of the player's profile, or 0 if they don't have one
+  int64_t FindPlayerId(const std::string& name);
+
+  // The name on the profile, shared with every time read out for it
+  PlayerName FindPlayerName(int64_t id);
+
+  // Remember a profile both ways, emptying the caches first if they're full
+  void CachePlayer(const std::string& name, int64_t id);
+
+  // Roll back the transaction a failed statement left open, if there is one
+  void RollBackOpenTransaction();
+
+  // Turns rows of player ids and times into players
+  std::vector<Player> GetPlayers(sqlite::database_binder* rows);
+
+  // Fold the time into the player's row in player_stats
+  void UpdatePlayerStats(int64_t player_id, size_t time,
+                         const std::string& mode,
+                         const std::string& difficulty);
+
+  // Add the time to the best times of its day and week, if it's among them
+  // and those windows haven't passed
+  void UpdateWindowBestTimes(int64_t player_id, size_t time,
+                             int64_t submitted_at, const std::string& mode,
+                             const std::string& difficulty);
+
   sqlite::database db_;
+
+  // Profiles already looked up, both ways, so names aren't read or copied
+  // again for every row. Profiles are never removed, so these don't go
+  // stale, but they're emptied at kMaxCachedPlayers so a bulk import
+  // doesn't keep every name in memory
+  std::unordered_map<std::string, int64_t> player_ids_;
+  std::unordered_map<int64_t, PlayerName> player_names_;
+
+  // The latest window each (window, mode, difficulty) has had a time in, so
+  // the previous one's rows are only deleted once, when it rolls over
+  std::map<std::tuple<int, std::string, std::string>, int64_t>
+      window_starts_;
 };
 
 }  // namespace sudoku
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_LEADERBOARD_ARCHIVE_H_
+#define FINALPROJECT_SUDOKU_LEADERBOARD_ARCHIVE_H_
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/player.h>
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+// Leaderboard archives hold every time on a leaderboard, for moving them
+// between machines in bulk. After a magic "SDKA" and u16 version, times come
+// in blocks of up to kArchiveBlockTimes, each
+//   u32 time count (0 ends the archive), u32 body length,
+//   u32 FNV-1a checksum of the body, body
+// The body is stored a column at a time: the block's distinct strings, then
+// the mode, difficulty and name of every time as indexes into them, then
+// the times themselves, then when each was submitted (from version 2).
+// Integers in the body are LEB128 varints, and strings a varint length and
+// their bytes. Only one block is ever held in memory, whatever the size of
+// the archive
+constexpr size_t kArchiveBlockTimes = 4096;
+
+struct ArchivedTime {
+  Player player;
+  std::string mode;
+  std::string difficulty;
+};
+
+class LeaderBoardArchiveWriter {
+ public:
+  explicit LeaderBoardArchiveWriter(std::ostream* out);
+
+  void Add(const Player& player, const std::string& mode,
+           const std::string& difficulty);
+
+  // Write the last block and the end of the archive. Returns false if the
+  // stream failed at any point
+  bool Finish();
+
+ private:
+  void WriteBlock();
+
+  std::ostream* out_;
+  std::vector<ArchivedTime> block_;
+};
+
+class LeaderBoardArchiveReader {
+ public:
+  explicit LeaderBoardArchiveReader(std::istream* in);
+
+  // Read the next time. Returns false at the end of the archive, or if it's
+  // truncated or corrupt, which HasFailed tells apart
+  bool Next(ArchivedTime* time);
+
+  bool HasFailed() const;
+
+ private:
+  bool ReadBlock();
+
+  std::istream* in_;
+  uint32_t version_;
+  std::vector<ArchivedTime> block_;
+  size_t next_;
+  bool is_done_;
+  bool has_failed_;
+};
+
+// Write every time on the leaderboard to `out`. Returns how many were
+// written, or 0 with an error printed if the leaderboard can't list them or
+// the stream fails
+size_t ExportLeaderBoard(LeaderBoard* leaderboard, std::ostream* out);
+
+// Add every time in the archive to the leaderboard in one batch, returning
+// how many were added. Times the leaderboard already has (see HasTime) are
+// skipped and counted in `num_skipped`, so importing an archive again adds
+// nothing, and finishes an import that stopped partway. If the archive
+// turns out to be corrupt, the batch is cancelled and 0 returned, so an
+// archive is added whole or not at all where the leaderboard can undo its
+// writes. 0 is returned too if the batch can't be saved
+size_t ImportLeaderBoard(std::istream* in, LeaderBoard* leaderboard,
+                         size_t* num_skipped = nullptr);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_LEADERBOARD_ARCHIVE_H_
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_LEADERBOARD_CLIENT_H_
+#define FINALPROJECT_SUDOKU_LEADERBOARD_CLIENT_H_
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/leaderboard_protocol.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+// A leaderboard kept by a LeaderBoardServer. If the server can't be reached,
+// the error is printed and the call does nothing, like SqliteLeaderBoard
+// does when the database fails, and the next call tries to connect again.
+// A server that takes longer than `timeout` to answer counts as gone
+class LeaderBoardClient : public LeaderBoard {
+ public:
+  explicit LeaderBoardClient(
+      const LeaderBoardAddress& address,
+      std::chrono::milliseconds timeout = std::chrono::seconds(2));
+  ~LeaderBoardClient() override;
+
+  LeaderBoardClient(const LeaderBoardClient&) = delete;
+  LeaderBoardClient& operator=(const LeaderBoardClient&) = delete;
+
+  void AddTimeToLeaderBoard(const Player&,
+                            std::string mode,
+                            std::string difficulty) override;
+
+  std::vector<Player> RetrieveBestTimes(const size_t limit,
+                                        std::string mode,
+                                        std::string difficulty) override;
+
+  std::vector<Player> RetrieveWindowBestTimes(
+      LeaderBoardWindow window, const size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  size_t RetrieveRank(size_t time,
+                      std::string mode,
+                      std::string difficulty) override;
+
+  PlayerStats RetrievePlayerStats(const std::string& name,
+                                  std::string mode,
+                                  std::string difficulty) override;
+
+  // Send every request before reading any of the responses, so there's one
+  // round trip for the lot. Returns false, with no responses, on failure or
+  // if a response doesn't match its request
+  bool SendPipelined(const std::vector<LeaderBoardRequest>& requests,
+                     std::vector<LeaderBoardResponse>* responses);
+
+  bool IsConnected() const;
+
+ private:
+  bool Connect();
+  void Disconnect();
+
+  LeaderBoardAddress address_;
+  std::chrono::milliseconds timeout_;
+  int fd_;
+
+  // Request frames being sent, and response bytes not yet decoded
+  std::string output_;
+  std::string input_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_LEADERBOARD_CLIENT_H_
@@ -0,0 +1,107 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_LEADERBOARD_PROTOCOL_H_
+#define FINALPROJECT_SUDOKU_LEADERBOARD_PROTOCOL_H_
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/player.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+// How leaderboard clients and the leaderboard server talk. Each message is a
+// frame of a u32 body length followed by the body, with integers little
+// endian and strings as a u16 length and their bytes:
+//   request:  u8 op, mode, difficulty, then
+//             kAddTime: name, u64 time | kBestTimes: u32 limit |
+//             kRank: u64 time | kPlayerStats: name |
+//             kWindowBestTimes: u8 window, u32 limit
+//   response: u8 op, u8 ok, then
+//             kBestTimes, kWindowBestTimes: u32 count +
+//                                           (name, u64 time) each |
+//             kRank: u64 rank |
+//             kPlayerStats: u64 games played, best, mean, recent median
+// A client can send any number of requests before reading the responses,
+// which come back in the same order
+enum class LeaderBoardOp : uint8_t {
+  kAddTime = 1,
+  kBestTimes = 2,
+  kRank = 3,
+  kPlayerStats = 4,
+  kWindowBestTimes = 5,
+};
+
+struct LeaderBoardRequest {
+  LeaderBoardOp op;
+  std::string mode;
+  std::string difficulty;
+
+  // kAddTime and kPlayerStats only
+  std::string name;
+
+  // The time to add, or to rank
+  uint64_t time;
+
+  // kBestTimes and kWindowBestTimes only
+  uint32_t limit;
+
+  // kWindowBestTimes only
+  LeaderBoardWindow window = LeaderBoardWindow::kAllTime;
+};
+
+struct LeaderBoardResponse {
+  LeaderBoardOp op;
+  bool ok;
+
+  // kBestTimes and kWindowBestTimes only
+  std::vector<Player> players;
+
+  // kRank only
+  uint64_t rank;
+
+  // kPlayerStats only
+  PlayerStats stats;
+};
+
+// Frames bigger than this are treated as garbage
+constexpr size_t kMaxLeaderBoardFrame = 64 * 1024;
+
+// The server refuses to add times for longer names
+constexpr size_t kMaxLeaderBoardName = 64;
+
+enum class FrameStatus {
+  kComplete,
+  kIncomplete,
+  kMalformed,
+};
+
+// Append a framed message to `out`. Players that would take a response
+// past kMaxLeaderBoardFrame are left off the end, so the slowest go first
+void EncodeRequest(const LeaderBoardRequest& request, std::string* out);
+void EncodeResponse(const LeaderBoardResponse& response, std::string* out);
+
+// Decode the frame starting at `*pos` in `data`, moving `*pos` past it if
+// it's complete. Partial frames are left for when more data arrives
+FrameStatus DecodeRequest(const std::string& data, size_t* pos,
+                          LeaderBoardRequest* request);
+FrameStatus DecodeResponse(const std::string& data, size_t* pos,
+                           LeaderBoardResponse* response);
+
+// Where a leaderboard server listens: "unix:PATH" for a Unix domain socket,
+// or "HOST:PORT" for TCP
+struct LeaderBoardAddress {
+  bool is_unix;
+  std::string path;
+  std::string host;
+  uint16_t port;
+};
+
+// Returns false if the address isn't in either form
+bool ParseLeaderBoardAddress(const std::string& text,
+                             LeaderBoardAddress* address);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_LEADERBOARD_PROTOCOL_H_
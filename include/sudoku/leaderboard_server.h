@@ -0,0 +1,111 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_LEADERBOARD_SERVER_H_
+#define FINALPROJECT_SUDOKU_LEADERBOARD_SERVER_H_
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/leaderboard_protocol.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sudoku {
+
+// Serves a leaderboard to any number of LeaderBoardClients over a socket,
+// so several copies of the app share one set of rankings. Runs on one
+// thread with an epoll event loop. Every request that arrives in one pass
+// of the loop is answered in one batch, so a client that pipelines its
+// requests gets them all handled together. Nothing is sent until the batch
+// has ended, and times from a batch that failed are answered as not
+// added. Linux only
+class LeaderBoardServer {
+ public:
+  // `leaderboard` must outlive the server, and is only used from Run's
+  // thread
+  explicit LeaderBoardServer(LeaderBoard* leaderboard);
+  ~LeaderBoardServer();
+
+  LeaderBoardServer(const LeaderBoardServer&) = delete;
+  LeaderBoardServer& operator=(const LeaderBoardServer&) = delete;
+
+  // Start listening. TCP servers only listen on loopback addresses, and a
+  // port of 0 picks a free one. Returns false, printing why, if the socket
+  // can't be set up
+  bool Listen(const LeaderBoardAddress& address);
+
+  // The TCP port being listened on
+  uint16_t GetPort() const;
+
+  // Handle requests until Stop is called
+  void Run();
+
+  // Make Run return. Safe to call from any thread or a signal handler
+  void Stop();
+
+  // Requests answered so far
+  uint64_t GetRequestCount() const;
+
+ private:
+  struct Connection {
+    std::string input;
+    std::string output;
+    size_t output_sent = 0;
+
+    // The last send didn't take everything
+    bool is_send_blocked = false;
+
+    // What epoll is waiting for
+    bool is_reading = true;
+    bool is_writing = false;
+
+    // The client has stopped sending, so hang up once it's been answered
+    bool is_closing = false;
+
+    // Where in output this pass's added times are answered, so they can be
+    // answered as not added if the batch fails
+    std::vector<size_t> added_times;
+  };
+
+  void Accept();
+
+  // Read what the client has sent and answer the complete requests in it.
+  // Returns false if the connection should be closed
+  bool ReadRequests(int fd, Connection* connection);
+  bool HandleRequests(int fd, Connection* connection);
+  bool WriteResponses(int fd, Connection* connection);
+
+  // Stop reading from a client with too many responses it hasn't taken yet,
+  // and only wait to write while there's something left that didn't fit
+  void UpdateEvents(int fd, Connection* connection);
+
+  LeaderBoardResponse Handle(const LeaderBoardRequest& request);
+
+  // Answer this pass's added times as not added
+  void RefuseAddedTimes();
+
+  void Close(int fd);
+
+  LeaderBoard* leaderboard_;
+  int listen_fd_;
+  int epoll_fd_;
+  int wake_fd_;
+  uint16_t port_;
+  std::string unix_path_;
+  uint64_t request_count_;
+
+  std::unordered_map<int, Connection> connections_;
+
+  // Connections with responses waiting to go out at the end of the pass
+  std::vector<int> pending_;
+
+  // Connections with requests held back until their client caught up
+  std::vector<int> backlogged_;
+
+  // Connections that added times this pass
+  std::vector<int> adding_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_LEADERBOARD_SERVER_H_
@@ -0,0 +1,126 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_LOG_LEADERBOARD_H_
+#define FINALPROJECT_SUDOKU_LOG_LEADERBOARD_H_
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/player.h>
+#include <sudoku/skiplist.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+struct LogLeaderBoardOptions {
+  // Wait for every added time to reach the disk, rather than only at the
+  // end of a batch. Otherwise a time is handed to the OS straight away, so
+  // it survives the app crashing but not the machine
+  bool sync_every_write = false;
+
+  // Keep only this many of the best times of each mode and difficulty when
+  // the log is compacted, or 0 to keep them all. Ranks past the limit then
+  // come out as the limit plus one
+  size_t max_times_per_bucket = 0;
+};
+
+// A leaderboard kept as an append-only log of checksummed records, with
+// each mode and difficulty's times in a TimeSkipList in memory. The log is
+// read back into the lists when it's opened, stopping at the first record
+// that's torn or corrupt, and is rewritten without the bad tail. Compaction
+// rewrites the log in time order, trimmed to the options' limit. It never
+// happens while adding a time: it's done when the log is opened with more
+// times than are kept, or when Compact is called
+//
+// Adding a time takes a lock, so one write happens at a time, but reads
+// never wait on writes. Times keep their submission dates, for export and
+// HasTime, but daily and weekly windows aren't kept
+class LogLeaderBoard : public LeaderBoard {
+ public:
+  explicit LogLeaderBoard(const std::string& log_path,
+                          const LogLeaderBoardOptions& options = {});
+  ~LogLeaderBoard() override;
+
+  LogLeaderBoard(const LogLeaderBoard&) = delete;
+  LogLeaderBoard& operator=(const LogLeaderBoard&) = delete;
+
+  void AddTimeToLeaderBoard(const Player&,
+                            std::string mode,
+                            std::string difficulty) override;
+
+  std::vector<Player> RetrieveBestTimes(const size_t limit,
+                                        std::string mode,
+                                        std::string difficulty) override;
+
+  size_t RetrieveRank(size_t time,
+                      std::string mode,
+                      std::string difficulty) override;
+
+  // Writes in a batch are synced to the disk together when it ends
+  void BeginBatch() override;
+  bool EndBatch() override;
+
+  bool HasTime(const Player& player, const std::string& mode,
+               const std::string& difficulty) override;
+
+  bool ForEachTime(const TimeVisitor& visit) override;
+
+  // Rewrite the log with only the times being kept, in order. Takes as long
+  // as writing out the whole log, so call it when the board is quiet
+  void Compact();
+
+  // Bytes in the log file, including the header
+  uint64_t GetLogSize() const;
+
+ private:
+  struct Bucket {
+    uint16_t id;
+    std::string mode;
+    std::string difficulty;
+
+    // Replaced whole when the log is compacted, so readers still walking
+    // the old one are left alone
+    std::shared_ptr<TimeSkipList> times;
+  };
+
+  // Read the log into the buckets. Returns false if it needs rewriting,
+  // because it ended in a bad record or is in an older version
+  bool Load();
+
+  // Whether any bucket holds more times than the options keep
+  bool HasTimesPastLimit() const;
+
+  // The bucket's times, or null if nothing's been added to it
+  std::shared_ptr<const TimeSkipList> GetTimes(const std::string& mode,
+                                               const std::string& difficulty);
+
+  // Called with write_mutex_ held
+  void Rewrite();
+  Bucket* GetOrAddBucket(const std::string& mode,
+                         const std::string& difficulty);
+  bool OpenForAppend();
+  void Append(const std::string& records);
+  void Sync();
+
+  std::string log_path_;
+  LogLeaderBoardOptions options_;
+
+  // Taken by writers, and by readers only to find their bucket
+  std::mutex write_mutex_;
+  mutable std::mutex buckets_mutex_;
+  std::map<std::pair<std::string, std::string>, std::unique_ptr<Bucket>>
+      buckets_;
+
+  std::FILE* log_;
+  uint64_t log_size_;
+  bool is_batching_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_LOG_LEADERBOARD_H_
@@ -1,14 +1,68 @@
 #ifndef FINALPROJECT_PLAYER_H
 #define FINALPROJECT_PLAYER_H
 
+#include <cstdint>
+#include <memory>
+#include <ostream>
 #include <string>
+#include <utility>
 
 namespace sudoku {
 
+// A player's name, shared between its copies rather than copied, so a
+// leaderboard can hand out each name once however many of the player's
+// times are read. Reads like the const std::string it holds
+class PlayerName {
+ public:
+  // Implicit, so names can be given as strings
+  PlayerName(const std::string& name);
+  PlayerName(const char* name);
+
+  operator const std::string&() const;
+  const std::string& str() const;
+  size_t size() const;
+  bool empty() const;
+
+  // Whether the two are the same copy of the name, not only equal
+  bool IsShared(const PlayerName& other) const;
+
+ private:
+  std::shared_ptr<const std::string> name_;
+};
+
+bool operator==(const PlayerName& lhs, const PlayerName& rhs);
+bool operator==(const PlayerName& lhs, const std::string& rhs);
+bool operator==(const std::string& lhs, const PlayerName& rhs);
+bool operator==(const PlayerName& lhs, const char* rhs);
+bool operator==(const char* lhs, const PlayerName& rhs);
+std::ostream& operator<<(std::ostream& out, const PlayerName& name);
+
 struct Player {
-  Player(const std::string& name, size_t time) : name(name), time(time) {}
-  std::string name;
+  Player(PlayerName name, size_t time, int64_t submitted_at = 0)
+      : name(std::move(name)), time(time), submitted_at(submitted_at) {}
+  PlayerName name;
+
+  // Time taken to finish the game, in milliseconds
   size_t time;
+
+  // When the game was submitted, in seconds since the Unix epoch, or 0 if
+  // that's not known. Only times with one count towards daily and weekly
+  // leaderboards
+  int64_t submitted_at;
+};
+
+// How many of a player's latest games their recent median is taken over
+constexpr size_t kRecentGames = 10;
+
+// A player's record in one mode and difficulty, with times in milliseconds.
+// Everything is 0 if they haven't finished a game there
+struct PlayerStats {
+  size_t games_played = 0;
+  size_t best_time = 0;
+  size_t mean_time = 0;
+
+  // The median of their last kRecentGames times
+  size_t recent_median_time = 0;
 };
 
 }  // namespace sudoku
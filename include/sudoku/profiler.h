@@ -0,0 +1,114 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_PROFILER_H_
+#define FINALPROJECT_SUDOKU_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+// One timed run of a scope. Times are in nanoseconds since the profiler was
+// created
+struct ProfileSample {
+  const char* scope;
+  int64_t start_ns;
+  int64_t duration_ns;
+  uint32_t thread_id;
+};
+
+// Summary of the recorded runs of one scope
+struct ScopeStats {
+  std::string scope;
+  size_t count;
+  double p50_ms;
+  double p99_ms;
+  double max_ms;
+};
+
+// Keeps the most recent samples in a fixed size ring buffer. Recording never
+// locks or allocates, so it's cheap enough to leave on in every frame, and
+// can be done from any thread while another one reads the samples
+class Profiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kDefaultCapacity = 4096;
+
+  explicit Profiler(size_t capacity = kDefaultCapacity);
+
+  // `scope` must outlive the profiler, e.g. a string literal
+  void Record(const char* scope, Clock::time_point start,
+              Clock::time_point end);
+
+  // The samples still in the buffer, oldest first. Samples being written
+  // while this runs are left out
+  std::vector<ProfileSample> GetSamples() const;
+
+  // Percentiles for each scope over the samples still in the buffer, sorted
+  // by scope name
+  std::vector<ScopeStats> GetStats() const;
+
+  // Write the samples in the Chrome trace event format, which can be opened
+  // in chrome://tracing or Perfetto. Returns false if the file can't be
+  // written
+  bool ExportChromeTrace(const std::string& path) const;
+
+  void Clear();
+
+  size_t GetCapacity() const;
+
+ private:
+  // Each field is atomic so a reader racing with a writer sees a torn slot
+  // rather than undefined behaviour. The sequence number says which sample
+  // is in the slot and whether it's finished, and is checked before and
+  // after reading the rest
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> scope{nullptr};
+    std::atomic<int64_t> start_ns{0};
+    std::atomic<int64_t> duration_ns{0};
+    std::atomic<uint32_t> thread_id{0};
+  };
+
+  Clock::time_point epoch_;
+  std::vector<Slot> slots_;
+  std::atomic<uint64_t> next_index_;
+};
+
+// The profiler the app and engine record into
+Profiler& GetDefaultProfiler();
+
+// How many draw calls and texture uploads the drawing helpers have made
+struct RenderCounts {
+  size_t draw_calls;
+  size_t texture_uploads;
+};
+
+// Called by the drawing helpers, so a frame's GL work can be compared
+// between versions of the drawing code
+void CountDrawCall();
+void CountTextureUpload();
+RenderCounts GetRenderCounts();
+
+// Records the time from construction to destruction as one run of `scope`
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(const char* scope,
+                       Profiler* profiler = &GetDefaultProfiler());
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  const char* scope_;
+  Profiler* profiler_;
+  Profiler::Clock::time_point start_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_PROFILER_H_
@@ -0,0 +1,103 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_RANDOM_H_
+#define FINALPROJECT_SUDOKU_RANDOM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace sudoku {
+
+// xoshiro256**, a small and fast generator with 256 bits of state. It's a
+// standard uniform random bit generator, so it works with anything that
+// takes an Rng, and gives the same numbers on every machine for a seed.
+// Each one belongs to a single thread; Split hands out generators for
+// others
+class Random {
+ public:
+  using result_type = uint64_t;
+
+  // The state is filled from the seed with SplitMix64, so nearby seeds
+  // still start far apart
+  explicit Random(uint64_t seed);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT64_MAX; }
+
+  result_type operator()() {
+    const uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+    const uint64_t shifted = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= shifted;
+    state_[3] = RotateLeft(state_[3], 45);
+
+    return result;
+  }
+
+  // A generator for another thread. It carries on from where this one is,
+  // and this one jumps 2^128 numbers ahead, so no two generators split off
+  // one seed ever hand out the same stretch of numbers
+  Random Split();
+
+ private:
+  static uint64_t RotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  void Jump();
+
+  uint64_t state_[4];
+};
+
+// The standard engines give the same numbers on every machine, but the
+// standard distributions and std::shuffle are up to each library. Boards
+// drawn through these instead come out the same everywhere for the same
+// engine and seed, which the daily challenge relies on
+
+// A number from 0 to n - 1, each equally likely. n can't be 0 or more than
+// the engine can make
+template <typename Rng>
+uint64_t RandomIndex(uint64_t n, Rng* rng);
+
+// The same for Random, without a division unless a draw has to be thrown
+// away (Lemire's method)
+uint64_t RandomIndex(uint64_t n, Random* rng);
+
+// Put the range in a random order, each equally likely
+template <typename RandomIt, typename Rng>
+void RandomShuffle(RandomIt first, RandomIt last, Rng* rng);
+
+template <typename Rng>
+uint64_t RandomIndex(uint64_t n, Rng* rng) {
+  const auto range = static_cast<uint64_t>(Rng::max() - Rng::min());
+
+  // The engine makes range + 1 different numbers. Those past the last whole
+  // multiple of n are drawn again, so no index comes up more than another.
+  // Written so range + 1 can't overflow
+  const uint64_t leftover = (range % n + 1) % n;
+  while (true) {
+    const auto value = static_cast<uint64_t>((*rng)() - Rng::min());
+    if (value <= range - leftover) {
+      return value % n;
+    }
+  }
+}
+
+template <typename RandomIt, typename Rng>
+void RandomShuffle(RandomIt first, RandomIt last, Rng* rng) {
+  using std::swap;
+  const auto size = static_cast<uint64_t>(std::distance(first, last));
+  for (uint64_t i = size; i > 1; i--) {
+    const uint64_t pick = RandomIndex(i, rng);
+    swap(first[static_cast<std::ptrdiff_t>(i - 1)],
+         first[static_cast<std::ptrdiff_t>(pick)]);
+  }
+}
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_RANDOM_H_
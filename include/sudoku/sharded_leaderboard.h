@@ -0,0 +1,109 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_SHARDED_LEADERBOARD_H_
+#define FINALPROJECT_SUDOKU_SHARDED_LEADERBOARD_H_
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/player.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+// The modes and difficulties leaderboards are kept for, as the app names
+// them
+constexpr std::array<const char*, 4> kLeaderBoardModes = {
+    "Standard", "Time Trial", "Time Attack", "Daily Challenge"};
+constexpr std::array<const char*, 3> kLeaderBoardDifficulties = {
+    "Easy", "Medium", "Hard"};
+
+// A leaderboard split into one SQLite database file per mode and
+// difficulty, each with its own connection and lock. Times for different
+// modes or difficulties can be added at the same time without waiting on
+// each other, and each file's index only holds its own times
+class ShardedLeaderBoard : public LeaderBoard {
+ public:
+  // Opens a shard next to `db_path` for every mode and difficulty, e.g.
+  // leaderboard.time_trial.easy.db for leaderboard.db. Times already in an
+  // unsharded leaderboard at `db_path` are moved into the shards
+  explicit ShardedLeaderBoard(const std::string& db_path);
+
+  // Unknown modes and difficulties print an error and are otherwise ignored,
+  // like database errors
+  void AddTimeToLeaderBoard(const Player&,
+                            std::string mode,
+                            std::string difficulty) override;
+
+  std::vector<Player> RetrieveBestTimes(const size_t limit,
+                                        std::string mode,
+                                        std::string difficulty) override;
+
+  std::vector<Player> RetrieveWindowBestTimes(
+      LeaderBoardWindow window, const size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  size_t RetrieveRank(size_t time,
+                      std::string mode,
+                      std::string difficulty) override;
+
+  // A player's times are all in the shard for the mode and difficulty
+  std::vector<Player> RetrievePlayerBestTimes(
+      const std::string& name, size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  std::vector<Player> RetrievePlayerRecentTimes(
+      const std::string& name, size_t limit, std::string mode,
+      std::string difficulty) override;
+
+  PlayerStats RetrievePlayerStats(const std::string& name,
+                                  std::string mode,
+                                  std::string difficulty) override;
+
+  bool HasTime(const Player& player, const std::string& mode,
+               const std::string& difficulty) override;
+
+  // Each shard written to during the batch gets a transaction of its own,
+  // so if one fails to commit, the others may already have
+  void BeginBatch() override;
+  bool EndBatch() override;
+  void CancelBatch() override;
+
+  bool ForEachTime(const TimeVisitor& visit) override;
+
+  // Where the shard for the mode and difficulty is kept
+  static std::string GetShardPath(const std::string& db_path,
+                                  const std::string& mode,
+                                  const std::string& difficulty);
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    std::unique_ptr<SqliteLeaderBoard> leaderboard;
+    bool is_batching = false;
+  };
+
+  // The shard for the mode and difficulty, or null if there isn't one.
+  // GetShard prints an error too
+  Shard* FindShard(const std::string& mode, const std::string& difficulty);
+  Shard* GetShard(const std::string& mode, const std::string& difficulty);
+
+  // Move the rows of an unsharded leaderboard into the shards. Rows are
+  // only deleted once their shard has committed them, and rows of modes
+  // and difficulties without a shard are left where they are
+  void MoveUnshardedTimes(const std::string& db_path);
+
+  std::array<Shard, kLeaderBoardModes.size()
+                    * kLeaderBoardDifficulties.size()> shards_;
+
+  // Set between BeginBatch and EndBatch. Batches are for a single caller
+  // like the leaderboard server, but other threads adding times read it
+  std::atomic<bool> is_batching_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_SHARDED_LEADERBOARD_H_
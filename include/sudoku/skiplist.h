@@ -0,0 +1,80 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_SKIPLIST_H_
+#define FINALPROJECT_SUDOKU_SKIPLIST_H_
+
+#include <sudoku/player.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+// Players' times kept sorted fastest first, with equal times in the order
+// they were added. One thread at a time may Insert, while any number of
+// others read: nodes are fully built before they're linked in, and are
+// never unlinked or freed until the list is destroyed
+class TimeSkipList {
+ public:
+  TimeSkipList();
+  ~TimeSkipList();
+
+  TimeSkipList(const TimeSkipList&) = delete;
+  TimeSkipList& operator=(const TimeSkipList&) = delete;
+
+  // Not safe to call from two threads at once
+  void Insert(uint64_t time, const PlayerName& name, int64_t submitted_at = 0);
+
+  // The fastest `limit` times
+  std::vector<Player> GetFirst(size_t limit) const;
+
+  // Call `visit` with every player, fastest first
+  template <typename Visit>
+  void ForEach(Visit visit) const {
+    const Node* node = head_.next[0].load(std::memory_order_acquire);
+    while (node != nullptr) {
+      visit(Player(node->name, static_cast<size_t>(node->time),
+                   node->submitted_at));
+      node = node->next[0].load(std::memory_order_acquire);
+    }
+  }
+
+  // How many times are no slower than `time`
+  size_t CountUpTo(uint64_t time) const;
+
+  // Whether the list has the player's name, time and submission date
+  bool Contains(const Player& player) const;
+
+  size_t GetSize() const;
+
+ private:
+  static constexpr int kMaxHeight = 16;
+
+  struct Node {
+    Node(uint64_t time, const PlayerName& name, int64_t submitted_at,
+         int height);
+
+    const uint64_t time;
+    const PlayerName name;
+    const int64_t submitted_at;
+    std::unique_ptr<std::atomic<Node*>[]> next;
+  };
+
+  // Each level up holds about a quarter of the nodes of the one below
+  int RandomHeight();
+
+  Node head_;
+  std::atomic<int> height_;
+  std::atomic<size_t> size_;
+
+  // Only touched by Insert
+  std::vector<std::unique_ptr<Node>> nodes_;
+  std::minstd_rand rng_;
+};
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_SKIPLIST_H_
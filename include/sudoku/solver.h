@@ -0,0 +1,34 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_SOLVER_H_
+#define FINALPROJECT_SUDOKU_SOLVER_H_
+
+#include <sudoku/board.h>
+#include <sudoku/variant.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace sudoku {
+
+// Fill in the board with a solution. Returns false, leaving the board
+// unchanged, if it has none
+bool Solve(Grid* board);
+
+// Number of solutions the board has, counting no further than `limit`
+size_t CountSolutions(const Grid& board, size_t limit);
+
+// Solve and CountSolutions under a variant's rules. Classic rules go to the
+// functions above; others are searched a box at a time through the
+// variant's peer table. Rules that aren't well formed have no solutions
+bool Solve(Grid* board, const Variant& variant);
+size_t CountSolutions(const Grid& board, size_t limit, const Variant& variant);
+
+// Solve many boards at once, each searched in its own vector lane so that
+// all of their singles are placed in lockstep. Only choosing where to guess is
+// done one board at a time. Finds the same solutions as Solve, and leaves
+// boards without one unchanged. Returns how many were solved
+size_t SolveBatch(std::vector<Grid>* boards);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_SOLVER_H_
@@ -0,0 +1,79 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_TRANSFORM_H_
+#define FINALPROJECT_SUDOKU_TRANSFORM_H_
+
+#include <sudoku/board.h>
+#include <sudoku/random.h>
+
+#include <array>
+#include <numeric>
+
+namespace sudoku {
+
+// A rearrangement of the board that turns any valid puzzle into another
+// valid puzzle. Rotations and reflections are combinations of these, e.g.
+// a quarter turn is a transpose followed by reversing the columns
+struct BoardTransform {
+  // New number for each number, with num_map[0] == 0 so empty boxes stay empty
+  std::array<int, kBoardSize + 1> num_map;
+
+  // Row i of the new board is row row_order[i] of the old one (and the same
+  // for columns). Rows only move within their band, and bands move as a whole
+  std::array<size_t, kBoardSize> row_order;
+  std::array<size_t, kBoardSize> col_order;
+
+  // Swap rows and columns after reordering them
+  bool transpose;
+};
+
+BoardTransform IdentityTransform();
+
+// Pick one of the 9! * 2 * 6^8 (about 1.2 * 10^12) transforms uniformly.
+// Rng is any standard random number engine
+template <typename Rng>
+BoardTransform RandomTransform(Rng* rng);
+
+Grid ApplyTransform(const Grid& board, const BoardTransform& transform);
+
+namespace detail {
+
+// Shuffle the bands (or stacks) and the lines within each of them
+template <typename Rng>
+std::array<size_t, kBoardSize> RandomLineOrder(Rng* rng) {
+  std::array<size_t, kBoxSize> bands;
+  std::iota(bands.begin(), bands.end(), 0);
+  RandomShuffle(bands.begin(), bands.end(), rng);
+
+  std::array<size_t, kBoardSize> order;
+  for (size_t band = 0; band < kBoxSize; band++) {
+    std::array<size_t, kBoxSize> lines;
+    std::iota(lines.begin(), lines.end(), 0);
+    RandomShuffle(lines.begin(), lines.end(), rng);
+
+    for (size_t i = 0; i < kBoxSize; i++) {
+      order[band * kBoxSize + i] = bands[band] * kBoxSize + lines[i];
+    }
+  }
+
+  return order;
+}
+
+}  // namespace detail
+
+template <typename Rng>
+BoardTransform RandomTransform(Rng* rng) {
+  BoardTransform transform;
+
+  std::iota(transform.num_map.begin(), transform.num_map.end(), 0);
+  RandomShuffle(transform.num_map.begin() + 1, transform.num_map.end(), rng);
+
+  transform.row_order = detail::RandomLineOrder(rng);
+  transform.col_order = detail::RandomLineOrder(rng);
+  transform.transpose = RandomIndex(2, rng) == 1;
+
+  return transform;
+}
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_TRANSFORM_H_
@@ -28,6 +28,9 @@ ci::vec2 GetMiddleOfBox(std::pair<ci::vec2, ci::vec2> box);
 
 bool IsMouseInBox(const ci::vec2& mouse_pos,
                   const std::pair<ci::vec2, ci::vec2>& box_bounds);
+
+// Format a time in milliseconds as seconds with three decimals, e.g. "61.025"
+std::string FormatGameTime(size_t milliseconds);
 }
 
 #endif  // FINALPROJECT_UTILS_H
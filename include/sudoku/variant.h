@@ -0,0 +1,118 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SUDOKU_VARIANT_H_
+#define FINALPROJECT_SUDOKU_VARIANT_H_
+
+#include <sudoku/board.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sudoku {
+
+// One DigitMask per box, numbered row * kBoardSize + col, with one bit set
+// for a filled box and none for an empty one
+using CellMasks = std::array<DigitMask, kBoardSize * kBoardSize>;
+
+// Numbers an even or odd box may hold
+constexpr DigitMask kEvenDigits = 0xAA;
+constexpr DigitMask kOddDigits = 0x155;
+
+// A killer cage: its boxes add up to `sum`, and no number repeats in it.
+// Boxes are numbered row * kBoardSize + col
+struct Cage {
+  std::vector<size_t> cells;
+  int sum;
+};
+
+// The rules a puzzle is played by. A group of kBoardSize boxes holds every
+// number once, like a row; smaller groups only can't repeat a number.
+// Even/odd puzzles narrow some boxes' `allowed` numbers
+struct VariantRules {
+  std::vector<std::vector<size_t>> groups;
+  std::vector<Cage> cages;
+  std::array<DigitMask, kBoardSize * kBoardSize> allowed;
+};
+
+// Rows, columns and 3x3 boxes
+VariantRules ClassicRules();
+
+// Classic, with both long diagonals as groups too
+VariantRules DiagonalRules();
+
+// Rows and columns, with the 3x3 boxes replaced by irregular regions.
+// regions[cell] is the region of each box, 0 to kBoardSize - 1
+VariantRules JigsawRules(
+    const std::array<size_t, kBoardSize * kBoardSize>& regions);
+
+// Classic, plus the cages
+VariantRules KillerRules(std::vector<Cage> cages);
+
+// Rules with the tables solving them needs worked out up front: each box's
+// peers (the boxes sharing a group or cage with it), and the cages it's in.
+// Classic rules are recognised and left to the classic solver and its
+// vector kernel, so they cost nothing extra
+class Variant {
+ public:
+  explicit Variant(VariantRules rules);
+
+  // Shared by every classic game
+  static std::shared_ptr<const Variant> GetClassic();
+
+  const VariantRules& GetRules() const;
+  bool IsClassic() const;
+
+  // Returns false if the rules can't describe a puzzle: a box off the
+  // board or in a group twice, a group bigger than kBoardSize, a cage sum
+  // its boxes can't make, or a box that can't hold any number. Rules like
+  // that conflict with every board, and leave every box without candidates
+  bool IsWellFormed() const;
+
+  const std::vector<uint8_t>& GetPeers(size_t cell) const;
+
+  // Indexes into the rules' groups of those that hold every number
+  const std::vector<size_t>& GetFullGroups() const;
+
+  // Indexes into the rules' cages of those the box is in
+  const std::vector<size_t>& GetCellCages(size_t cell) const;
+
+  // Whether any filled boxes break a rule: a number repeated among peers,
+  // a number the box can't hold, or a cage over its sum, or not on it once
+  // full
+  bool HasConflict(const Grid& entries) const;
+
+  // Whether the box is filled and breaks one of those rules, with a peer or
+  // with a cage it's in
+  bool IsInConflict(const Grid& entries, size_t cell) const;
+
+  // Whether the board is full and breaks no rule
+  bool IsSolution(const Grid& board) const;
+
+ private:
+  VariantRules rules_;
+  bool is_classic_;
+  bool is_well_formed_;
+  std::array<std::vector<uint8_t>, kBoardSize * kBoardSize> peers_;
+  std::vector<size_t> full_groups_;
+  std::array<std::vector<size_t>, kBoardSize * kBoardSize> cell_cages_;
+};
+
+// The numbers that could still go in each empty box under the variant's
+// rules, including what's left of each cage's sum. Filled boxes have none
+CandidateGrid ComputeCandidates(const Grid& entries, const Variant& variant);
+
+// ComputeCandidates for a board kept as masks, the way the solver keeps
+// it. Returns false if the board can't be finished: an empty box has no
+// candidates, or a cage can't reach its sum
+bool ComputeMaskCandidates(const CellMasks& placed, const Variant& variant,
+                           CellMasks* candidates);
+
+// Numbers that can finish a cage: the union of every set of `count`
+// different numbers out of `available` that add up to `sum`
+DigitMask GetCageDigits(size_t count, int sum, DigitMask available);
+
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SUDOKU_VARIANT_H_
@@ -0,0 +1,84 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/board.h>
+
+#include <sudoku/candidate_kernel.h>
+
+#include <array>
+#include <string>
+
+namespace sudoku {
+
+namespace {
+
+std::array<Unit, kNumUnits> MakeUnits() {
+  std::array<Unit, kNumUnits> units;
+
+  for (size_t i = 0; i < kBoardSize; i++) {
+    for (size_t j = 0; j < kBoardSize; j++) {
+      units[i][j] = {i, j};
+      units[kBoardSize + i][j] = {j, i};
+      units[2 * kBoardSize + i][j] = {(i / kBoxSize) * kBoxSize + j / kBoxSize,
+                                      (i % kBoxSize) * kBoxSize + j % kBoxSize};
+    }
+  }
+
+  return units;
+}
+
+}  // namespace
+
+const std::array<Unit, kNumUnits>& GetUnits() {
+  static const std::array<Unit, kNumUnits> units = MakeUnits();
+  return units;
+}
+
+CandidateGrid ComputeCandidates(const Grid& entries) {
+  CandidateScan scan;
+  ScanCandidates(ToMaskBoard(entries), &scan);
+
+  CandidateGrid candidates;
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      candidates[row][col] = scan.candidates.cells[row][col];
+    }
+  }
+
+  return candidates;
+}
+
+bool ParseBoardLine(const std::string& line, Grid* board) {
+  if (line.size() < kBoardSize * kBoardSize) {
+    return false;
+  }
+
+  Grid parsed;
+  for (size_t cell = 0; cell < kBoardSize * kBoardSize; cell++) {
+    char box = line[cell];
+    if (box == '.') {
+      box = '0';
+    }
+    if (box < '0' || box > '9') {
+      return false;
+    }
+
+    parsed[cell / kBoardSize][cell % kBoardSize] = box - '0';
+  }
+
+  *board = parsed;
+  return true;
+}
+
+std::string FormatBoardLine(const Grid& board) {
+  std::string line;
+  line.reserve(kBoardSize * kBoardSize);
+  for (const auto& row : board) {
+    for (int num : row) {
+      line += static_cast<char>('0' + num);
+    }
+  }
+
+  return line;
+}
+
+}  // namespace sudoku
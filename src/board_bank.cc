@@ -0,0 +1,93 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/board_bank.h>
+
+#include <cinder/app/App.h>
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+bool ReadBoardFile(const std::string& file, Grid* board, Grid* solution) {
+  return ReadBoardPath(ci::app::getAssetPath(file).string(), board, solution);
+}
+
+bool ReadBoardPath(const std::string& path, Grid* board, Grid* solution) {
+  std::ifstream infile(path);
+  if (!infile) {
+    return false;
+  }
+
+  // Load the file data into a JSON object
+  auto board_data = nlohmann::json::parse(infile, nullptr, false);
+  if (board_data.is_discarded()) {
+    return false;
+  }
+
+  Grid read_board;
+  Grid read_solution;
+  try {
+    board_data.at("board").get_to(read_board);
+    board_data.at("solution").get_to(read_solution);
+  } catch (const nlohmann::json::exception&) {
+    return false;
+  }
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (read_board[row][col] < 0
+          || read_board[row][col] > static_cast<int>(kBoardSize)
+          || read_solution[row][col] < 1
+          || read_solution[row][col] > static_cast<int>(kBoardSize)) {
+        return false;
+      }
+    }
+  }
+
+  *board = read_board;
+  *solution = read_solution;
+  return true;
+}
+
+std::map<std::string, std::string> BoardBank::FindPaths(
+    const std::vector<std::string>& files) {
+  std::map<std::string, std::string> paths;
+  for (const auto& file : files) {
+    paths[file] = ci::app::getAssetPath(file).string();
+  }
+
+  return paths;
+}
+
+BoardBank::BoardBank(const std::map<std::string, std::string>& paths) {
+  for (const auto& path : paths) {
+    Grid board;
+    Grid solution;
+    if (ReadBoardPath(path.second, &board, &solution)) {
+      boards_[path.first] = {board, solution};
+    }
+  }
+}
+
+bool BoardBank::GetBoard(const std::string& file, Grid* board,
+                         Grid* solution) const {
+  auto found = boards_.find(file);
+  if (found == boards_.end()) {
+    return false;
+  }
+
+  *board = found->second.first;
+  *solution = found->second.second;
+  return true;
+}
+
+size_t BoardBank::GetSize() const {
+  return boards_.size();
+}
+
+}  // namespace sudoku
@@ -0,0 +1,304 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/candidate_kernel.h>
+
+#include <sudoku/board.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+#include "candidate_kernel_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) \
+    || defined(_M_IX86)
+#define SUDOKU_KERNEL_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace sudoku {
+
+namespace {
+
+// Numbers found in at least one/two of the masks added
+struct SeenCount {
+  DigitMask once = 0;
+  DigitMask twice = 0;
+
+  void Add(DigitMask mask) {
+    twice |= static_cast<DigitMask>(once & mask);
+    once |= mask;
+  }
+
+  DigitMask Unique() const {
+    return static_cast<DigitMask>(once & ~twice);
+  }
+};
+
+// Reference implementation, and the one used where there's no vector unit
+void ScanScalar(const MaskBoard& placed, CandidateScan* scan) {
+  const auto& cells = placed.cells;
+  std::array<SeenCount, kBoardSize> row_used;
+  std::array<SeenCount, kBoardSize> col_used;
+  std::array<SeenCount, kBoardSize> box_used;
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      row_used[row].Add(cells[row][col]);
+      col_used[col].Add(cells[row][col]);
+      box_used[BoxIndex(row, col)].Add(cells[row][col]);
+    }
+  }
+
+  bool is_contradiction = false;
+  for (size_t i = 0; i < kBoardSize; i++) {
+    is_contradiction |= (row_used[i].twice | col_used[i].twice
+                         | box_used[i].twice) != 0;
+  }
+
+  std::array<SeenCount, kBoardSize> row_cands;
+  std::array<SeenCount, kBoardSize> col_cands;
+  std::array<SeenCount, kBoardSize> box_cands;
+  scan->candidates = MaskBoard{};
+  scan->singles = MaskBoard{};
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (cells[row][col] != 0) {
+        continue;
+      }
+
+      size_t box = BoxIndex(row, col);
+      auto cands = static_cast<DigitMask>(
+          kAllDigits & ~(row_used[row].once | col_used[col].once
+                         | box_used[box].once));
+      is_contradiction |= cands == 0;
+
+      scan->candidates.cells[row][col] = cands;
+      row_cands[row].Add(cands);
+      col_cands[col].Add(cands);
+      box_cands[box].Add(cands);
+    }
+  }
+
+  for (size_t i = 0; i < kBoardSize; i++) {
+    is_contradiction |= (row_cands[i].once | row_used[i].once) != kAllDigits
+                        || (col_cands[i].once | col_used[i].once) != kAllDigits
+                        || (box_cands[i].once | box_used[i].once) != kAllDigits;
+  }
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      DigitMask cands = scan->candidates.cells[row][col];
+      DigitMask single = cands;
+      if (CountDigits(cands) != 1) {
+        single = static_cast<DigitMask>(
+            cands & (row_cands[row].Unique() | col_cands[col].Unique()
+                     | box_cands[BoxIndex(row, col)].Unique()));
+      }
+
+      is_contradiction |= CountDigits(single) > 1;
+      scan->singles.cells[row][col] = single;
+    }
+  }
+
+  scan->is_contradiction = is_contradiction;
+}
+
+// Lane by lane version of the vector operations, for PropagateLanes on CPUs
+// without a vector unit the kernels support
+struct ScalarOps {
+  struct Vec {
+    DigitMask lanes[kMaskLanes];
+  };
+
+  template <typename Op>
+  static Vec Map(const Vec& a, const Vec& b, Op op) {
+    Vec result;
+    for (size_t lane = 0; lane < kMaskLanes; lane++) {
+      result.lanes[lane] = static_cast<DigitMask>(op(a.lanes[lane],
+                                                     b.lanes[lane]));
+    }
+    return result;
+  }
+
+  static Vec Zero() {
+    return Set1(0);
+  }
+
+  static Vec Set1(DigitMask mask) {
+    Vec v;
+    for (auto& lane : v.lanes) {
+      lane = mask;
+    }
+    return v;
+  }
+
+  static Vec Load(const DigitMask* masks) {
+    Vec v;
+    std::copy(masks, masks + kMaskLanes, v.lanes);
+    return v;
+  }
+
+  static void Store(DigitMask* masks, const Vec& v) {
+    std::copy(v.lanes, v.lanes + kMaskLanes, masks);
+  }
+
+  static Vec Or(const Vec& a, const Vec& b) {
+    return Map(a, b, [](DigitMask x, DigitMask y) { return x | y; });
+  }
+
+  static Vec And(const Vec& a, const Vec& b) {
+    return Map(a, b, [](DigitMask x, DigitMask y) { return x & y; });
+  }
+
+  static Vec AndNot(const Vec& a, const Vec& b) {
+    return Map(a, b, [](DigitMask x, DigitMask y) { return ~x & y; });
+  }
+
+  static Vec IsZero(const Vec& v) {
+    return Map(v, v, [](DigitMask x, DigitMask) {
+      return x == 0 ? 0xFFFF : 0;
+    });
+  }
+
+  static Vec IsSingleBit(const Vec& v) {
+    return Map(v, v, [](DigitMask x, DigitMask) {
+      return x != 0 && (x & (x - 1)) == 0 ? 0xFFFF : 0;
+    });
+  }
+
+  static bool Any(const Vec& v) {
+    for (DigitMask lane : v.lanes) {
+      if (lane != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+#ifdef SUDOKU_KERNEL_X86
+bool CpuSupports(KernelIsa isa) {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  int max_leaf = info[0];
+
+  __cpuid(info, 1);
+  bool has_sse41 = (info[2] & (1 << 19)) != 0;
+  if (isa == KernelIsa::kSse41) {
+    return has_sse41;
+  }
+
+  // AVX2 also needs the OS to save the 256-bit registers
+  bool has_os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0
+                    && (_xgetbv(0) & 0x6) == 0x6;
+  if (!has_sse41 || !has_os_avx || max_leaf < 7) {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  if (isa == KernelIsa::kSse41) {
+    return __builtin_cpu_supports("sse4.1") != 0;
+  }
+
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+KernelIsa DetectBestIsa() {
+#ifdef SUDOKU_KERNEL_X86
+  if (CpuSupports(KernelIsa::kAvx2)) {
+    return KernelIsa::kAvx2;
+  }
+  if (CpuSupports(KernelIsa::kSse41)) {
+    return KernelIsa::kSse41;
+  }
+#endif
+
+  return KernelIsa::kScalar;
+}
+
+std::atomic<KernelIsa>& CurrentIsa() {
+  static std::atomic<KernelIsa> isa(GetBestKernelIsa());
+  return isa;
+}
+
+}  // namespace
+
+KernelIsa GetBestKernelIsa() {
+  static const KernelIsa best = DetectBestIsa();
+  return best;
+}
+
+KernelIsa GetKernelIsa() {
+  return CurrentIsa().load(std::memory_order_relaxed);
+}
+
+void SetKernelIsa(KernelIsa isa) {
+  if (static_cast<int>(isa) > static_cast<int>(GetBestKernelIsa())) {
+    isa = GetBestKernelIsa();
+  }
+
+  CurrentIsa().store(isa, std::memory_order_relaxed);
+}
+
+MaskBoard ToMaskBoard(const Grid& grid) {
+  MaskBoard board{};
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (grid[row][col] != 0) {
+        board.cells[row][col] = DigitBit(grid[row][col]);
+      }
+    }
+  }
+
+  return board;
+}
+
+void ScanCandidates(const MaskBoard& placed, CandidateScan* scan) {
+  switch (GetKernelIsa()) {
+#ifdef SUDOKU_KERNEL_X86
+    case KernelIsa::kAvx2 :
+      kernel::ScanAvx2(placed.cells[0].data(), scan->candidates.cells[0].data(),
+                       scan->singles.cells[0].data(), &scan->is_contradiction);
+      return;
+    case KernelIsa::kSse41 :
+      kernel::ScanSse41(placed.cells[0].data(),
+                        scan->candidates.cells[0].data(),
+                        scan->singles.cells[0].data(),
+                        &scan->is_contradiction);
+      return;
+#endif
+    default :
+      ScanScalar(placed, scan);
+  }
+}
+
+void PropagateLanes(LaneBoards* boards) {
+  DigitMask* cells = boards->cells[0].data();
+  DigitMask* candidates = boards->candidates[0].data();
+  DigitMask* contradictions = boards->contradictions.data();
+
+  switch (GetKernelIsa()) {
+#ifdef SUDOKU_KERNEL_X86
+    case KernelIsa::kAvx2 :
+      kernel::PropagateAvx2(cells, candidates, contradictions);
+      return;
+    case KernelIsa::kSse41 :
+      kernel::PropagateSse41(cells, candidates, contradictions);
+      return;
+#endif
+    default :
+      kernel::PropagateBoxes<ScalarOps>(cells, candidates, contradictions);
+  }
+}
+
+}  // namespace sudoku
@@ -0,0 +1,111 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+// Compiled with AVX2 enabled, see src/CMakeLists.txt. Only called once
+// the CPU is known to support it
+
+#include "candidate_kernel_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) \
+    || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace sudoku {
+namespace kernel {
+
+namespace {
+
+// A whole board row of 16 masks fits in one 256-bit register
+struct Avx2Ops {
+  using Vec = __m256i;
+
+  static Vec Zero() {
+    return _mm256_setzero_si256();
+  }
+
+  static Vec Set1(DigitMask mask) {
+    return _mm256_set1_epi16(static_cast<short>(mask));
+  }
+
+  static Vec Load(const DigitMask* masks) {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(masks));
+  }
+
+  static void Store(DigitMask* masks, Vec v) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(masks), v);
+  }
+
+  static Vec Or(Vec a, Vec b) {
+    return _mm256_or_si256(a, b);
+  }
+
+  static Vec And(Vec a, Vec b) {
+    return _mm256_and_si256(a, b);
+  }
+
+  static Vec AndNot(Vec a, Vec b) {
+    return _mm256_andnot_si256(a, b);
+  }
+
+  static Vec IsZero(Vec v) {
+    return _mm256_cmpeq_epi16(v, _mm256_setzero_si256());
+  }
+
+  static Vec IsSingleBit(Vec v) {
+    Vec lowest_cleared = _mm256_and_si256(
+        v, _mm256_sub_epi16(v, _mm256_set1_epi16(1)));
+    return _mm256_andnot_si256(IsZero(v), IsZero(lowest_cleared));
+  }
+
+  static bool Any(Vec v) {
+    return _mm256_testz_si256(v, v) == 0;
+  }
+
+  // Fold the lanes together in halves, swapping ever smaller groups, so
+  // every lane ends up with the result
+  static void ReduceLanes(Vec v, Vec* once, Vec* twice) {
+    Vec seen_once = v;
+    Vec seen_twice = _mm256_setzero_si256();
+
+    Combine(_mm256_permute2x128_si256(seen_once, seen_once, 0x01),
+            _mm256_permute2x128_si256(seen_twice, seen_twice, 0x01),
+            &seen_once, &seen_twice);
+    Combine(_mm256_shuffle_epi32(seen_once, 0x4E),
+            _mm256_shuffle_epi32(seen_twice, 0x4E), &seen_once, &seen_twice);
+    Combine(_mm256_shuffle_epi32(seen_once, 0xB1),
+            _mm256_shuffle_epi32(seen_twice, 0xB1), &seen_once, &seen_twice);
+    Combine(_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(seen_once, 0xB1),
+                                   0xB1),
+            _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(seen_twice, 0xB1),
+                                   0xB1),
+            &seen_once, &seen_twice);
+
+    *once = seen_once;
+    *twice = seen_twice;
+  }
+
+  static void Combine(Vec other_once, Vec other_twice, Vec* once, Vec* twice) {
+    *twice = _mm256_or_si256(_mm256_or_si256(*twice, other_twice),
+                             _mm256_and_si256(*once, other_once));
+    *once = _mm256_or_si256(*once, other_once);
+  }
+};
+
+}  // namespace
+
+void ScanAvx2(const DigitMask* placed,
+              DigitMask* candidates,
+              DigitMask* singles,
+              bool* is_contradiction) {
+  ScanRows<Avx2Ops>(placed, candidates, singles, is_contradiction);
+}
+
+void PropagateAvx2(DigitMask* cells, DigitMask* candidates,
+                   DigitMask* contradictions) {
+  PropagateBoxes<Avx2Ops>(cells, candidates, contradictions);
+}
+
+}  // namespace kernel
+}  // namespace sudoku
+
+#endif
@@ -0,0 +1,314 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+#ifndef FINALPROJECT_SRC_CANDIDATE_KERNEL_SIMD_H_
+#define FINALPROJECT_SRC_CANDIDATE_KERNEL_SIMD_H_
+
+// Shared body of the vectorized candidate kernels. Only included by the
+// per-instruction-set source files, which are each compiled with the flags
+// for their instruction set, and by the portable fallback in
+// candidate_kernel.cc, so nothing here may be used by other code
+
+#include <sudoku/board.h>
+#include <sudoku/candidate_kernel.h>
+
+namespace sudoku {
+namespace kernel {
+
+constexpr size_t kNumCells = kBoardSize * kBoardSize;
+
+// The unit number (as in GetUnits) of the 3x3 box holding a box. Everything
+// the kernels call has to be static or a template on the instruction set, so
+// that the linker never swaps in a copy compiled for an instruction set the
+// CPU doesn't have
+static size_t GetBoxUnit(size_t row, size_t col) {
+  return 2 * kBoardSize + (row / kBoxSize) * kBoxSize + col / kBoxSize;
+}
+
+// Entry points for each instruction set. The arrays hold kBoardSize rows of
+// kMaskLanes masks and are 32-byte aligned
+void ScanSse41(const DigitMask* placed,
+               DigitMask* candidates,
+               DigitMask* singles,
+               bool* is_contradiction);
+void ScanAvx2(const DigitMask* placed,
+              DigitMask* candidates,
+              DigitMask* singles,
+              bool* is_contradiction);
+
+// `cells` and `candidates` hold kNumCells boxes of kMaskLanes masks and
+// `contradictions` one mask per lane, all 32-byte aligned
+void PropagateSse41(DigitMask* cells, DigitMask* candidates,
+                    DigitMask* contradictions);
+void PropagateAvx2(DigitMask* cells, DigitMask* candidates,
+                   DigitMask* contradictions);
+
+// The kernel works on whole board rows at once. `Ops` wraps the vector type
+// holding one row and the handful of operations the kernel needs:
+//   Vec, Zero(), Set1(mask), Load(ptr), Store(ptr, v), Or, And,
+//   AndNot(a, b) = ~a & b, IsZero(v) (all ones in lanes that are 0),
+//   IsSingleBit(v) (all ones in lanes with exactly one bit set),
+//   Any(v) (true if any lane is nonzero), and
+//   ReduceLanes(v, &once, &twice), which sets every lane of `once` to the
+//   numbers found in any lane of v and `twice` to those found in two or more
+template <typename Ops>
+void ScanRows(const DigitMask* placed,
+              DigitMask* candidates,
+              DigitMask* singles,
+              bool* is_contradiction) {
+  using Vec = typename Ops::Vec;
+
+  // Only the first kBoardSize lanes of a row are real boxes
+  alignas(32) DigitMask lane_bits[kMaskLanes] = {};
+  for (size_t lane = 0; lane < kBoardSize; lane++) {
+    lane_bits[lane] = 0xFFFF;
+  }
+  const Vec real_lanes = Ops::Load(lane_bits);
+  const Vec all_digits = Ops::And(Ops::Set1(kAllDigits), real_lanes);
+
+  Vec rows[kBoardSize];
+  for (size_t row = 0; row < kBoardSize; row++) {
+    rows[row] = Ops::Load(placed + row * kMaskLanes);
+  }
+
+  // Numbers placed in each column, and any placed twice
+  Vec col_used = Ops::Zero();
+  Vec conflicts = Ops::Zero();
+  for (size_t row = 0; row < kBoardSize; row++) {
+    conflicts = Ops::Or(conflicts, Ops::And(col_used, rows[row]));
+    col_used = Ops::Or(col_used, rows[row]);
+  }
+
+  // Numbers placed in each row, already spread across the row's lanes
+  Vec row_used[kBoardSize];
+  for (size_t row = 0; row < kBoardSize; row++) {
+    Vec twice;
+    Ops::ReduceLanes(rows[row], &row_used[row], &twice);
+    conflicts = Ops::Or(conflicts, twice);
+  }
+
+  // Numbers placed in each 3x3 box, spread across the box's lanes. Only the
+  // three boxes of a band need combining across lanes, so that's done per box
+  Vec box_used[kBoxSize];
+  bool box_conflict = false;
+  for (size_t band = 0; band < kBoxSize; band++) {
+    alignas(32) DigitMask once[kMaskLanes];
+    alignas(32) DigitMask twice[kMaskLanes];
+    Vec band_once = Ops::Zero();
+    Vec band_twice = Ops::Zero();
+    for (size_t i = 0; i < kBoxSize; i++) {
+      const Vec& row = rows[band * kBoxSize + i];
+      band_twice = Ops::Or(band_twice, Ops::And(band_once, row));
+      band_once = Ops::Or(band_once, row);
+    }
+    Ops::Store(once, band_once);
+    Ops::Store(twice, band_twice);
+
+    alignas(32) DigitMask spread[kMaskLanes] = {};
+    for (size_t box = 0; box < kBoxSize; box++) {
+      DigitMask box_once = 0;
+      DigitMask box_twice = 0;
+      for (size_t lane = box * kBoxSize; lane < (box + 1) * kBoxSize; lane++) {
+        box_twice |= static_cast<DigitMask>(twice[lane]
+                                            | (box_once & once[lane]));
+        box_once |= once[lane];
+      }
+
+      box_conflict |= box_twice != 0;
+      for (size_t lane = box * kBoxSize; lane < (box + 1) * kBoxSize; lane++) {
+        spread[lane] = box_once;
+      }
+    }
+    box_used[band] = Ops::Load(spread);
+  }
+
+  // Candidates are the numbers not used by the box's row, column or 3x3 box
+  Vec cands[kBoardSize];
+  for (size_t row = 0; row < kBoardSize; row++) {
+    Vec empty = Ops::And(Ops::IsZero(rows[row]), real_lanes);
+    Vec used = Ops::Or(Ops::Or(row_used[row], col_used),
+                       box_used[row / kBoxSize]);
+    cands[row] = Ops::And(Ops::AndNot(used, all_digits), empty);
+
+    // An empty box with nowhere to go
+    conflicts = Ops::Or(conflicts, Ops::And(Ops::IsZero(cands[row]), empty));
+  }
+
+  // Hidden singles in columns: numbers that are a candidate exactly once
+  Vec col_once = Ops::Zero();
+  Vec col_twice = Ops::Zero();
+  for (size_t row = 0; row < kBoardSize; row++) {
+    col_twice = Ops::Or(col_twice, Ops::And(col_once, cands[row]));
+    col_once = Ops::Or(col_once, cands[row]);
+  }
+  Vec col_unique = Ops::AndNot(col_twice, col_once);
+
+  // A number missing from a column with no place left to go
+  conflicts = Ops::Or(conflicts,
+                      Ops::AndNot(Ops::Or(col_once, col_used), all_digits));
+
+  // The same for each 3x3 box
+  Vec box_unique[kBoxSize];
+  for (size_t band = 0; band < kBoxSize; band++) {
+    alignas(32) DigitMask once[kMaskLanes];
+    alignas(32) DigitMask twice[kMaskLanes];
+    alignas(32) DigitMask used[kMaskLanes];
+    Vec band_once = Ops::Zero();
+    Vec band_twice = Ops::Zero();
+    for (size_t i = 0; i < kBoxSize; i++) {
+      const Vec& row = cands[band * kBoxSize + i];
+      band_twice = Ops::Or(band_twice, Ops::And(band_once, row));
+      band_once = Ops::Or(band_once, row);
+    }
+    Ops::Store(once, band_once);
+    Ops::Store(twice, band_twice);
+    Ops::Store(used, box_used[band]);
+
+    alignas(32) DigitMask spread[kMaskLanes] = {};
+    for (size_t box = 0; box < kBoxSize; box++) {
+      DigitMask box_once = 0;
+      DigitMask box_twice = 0;
+      for (size_t lane = box * kBoxSize; lane < (box + 1) * kBoxSize; lane++) {
+        box_twice |= static_cast<DigitMask>(twice[lane]
+                                            | (box_once & once[lane]));
+        box_once |= once[lane];
+      }
+
+      box_conflict |= (box_once | used[box * kBoxSize]) != kAllDigits;
+      for (size_t lane = box * kBoxSize; lane < (box + 1) * kBoxSize; lane++) {
+        spread[lane] = static_cast<DigitMask>(box_once & ~box_twice);
+      }
+    }
+    box_unique[band] = Ops::Load(spread);
+  }
+
+  // Rows, then put the singles together
+  for (size_t row = 0; row < kBoardSize; row++) {
+    Vec once;
+    Vec twice;
+    Ops::ReduceLanes(cands[row], &once, &twice);
+    conflicts = Ops::Or(conflicts, Ops::AndNot(Ops::Or(once, row_used[row]),
+                                               all_digits));
+
+    Vec unique = Ops::Or(Ops::Or(Ops::AndNot(twice, once), col_unique),
+                         box_unique[row / kBoxSize]);
+    Vec naked = Ops::IsSingleBit(cands[row]);
+    Vec single = Ops::And(cands[row], Ops::Or(naked, unique));
+
+    // A box can't be forced to hold two different numbers
+    conflicts = Ops::Or(conflicts,
+                        Ops::AndNot(Ops::IsSingleBit(single),
+                                    Ops::AndNot(Ops::IsZero(single),
+                                                real_lanes)));
+
+    Ops::Store(candidates + row * kMaskLanes, cands[row]);
+    Ops::Store(singles + row * kMaskLanes, single);
+  }
+
+  *is_contradiction = box_conflict || Ops::Any(conflicts);
+}
+
+// The same checks as ScanRows, but with a different board in each lane, so
+// no lanes ever need combining. Places singles on every board until none are
+// left, and marks the lanes of boards that turn out to be unsolvable
+template <typename Ops>
+void PropagateBoxes(DigitMask* cells, DigitMask* candidates,
+                    DigitMask* contradictions) {
+  using Vec = typename Ops::Vec;
+
+  const Vec all_digits = Ops::Set1(kAllDigits);
+  const Vec all_lanes = Ops::Set1(0xFFFF);
+  Vec dead = Ops::Load(contradictions);
+
+  // Numbers placed in each unit, numbers that are candidates in at least one
+  // or two of its boxes, and candidates for each box
+  Vec used[kNumUnits];
+  Vec cands_once[kNumUnits];
+  Vec cands_twice[kNumUnits];
+  Vec cands[kNumCells];
+
+  bool placed = true;
+  while (placed) {
+    Vec conflicts = Ops::Zero();
+    for (size_t unit = 0; unit < kNumUnits; unit++) {
+      used[unit] = Ops::Zero();
+      cands_once[unit] = Ops::Zero();
+      cands_twice[unit] = Ops::Zero();
+    }
+
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        const Vec v = Ops::Load(cells + (row * kBoardSize + col) * kMaskLanes);
+        for (size_t unit : {row, kBoardSize + col, GetBoxUnit(row, col)}) {
+          conflicts = Ops::Or(conflicts, Ops::And(used[unit], v));
+          used[unit] = Ops::Or(used[unit], v);
+        }
+      }
+    }
+
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        size_t cell = row * kBoardSize + col;
+        size_t box = GetBoxUnit(row, col);
+        Vec empty = Ops::IsZero(Ops::Load(cells + cell * kMaskLanes));
+        Vec cell_used = Ops::Or(Ops::Or(used[row], used[kBoardSize + col]),
+                                used[box]);
+        cands[cell] = Ops::And(Ops::AndNot(cell_used, all_digits), empty);
+        conflicts = Ops::Or(conflicts, Ops::And(Ops::IsZero(cands[cell]),
+                                                empty));
+
+        for (size_t unit : {row, kBoardSize + col, box}) {
+          cands_twice[unit] = Ops::Or(cands_twice[unit],
+                                      Ops::And(cands_once[unit], cands[cell]));
+          cands_once[unit] = Ops::Or(cands_once[unit], cands[cell]);
+        }
+      }
+    }
+
+    // Numbers with only one place left in the unit
+    Vec unique[kNumUnits];
+    for (size_t unit = 0; unit < kNumUnits; unit++) {
+      conflicts = Ops::Or(conflicts, Ops::AndNot(
+          Ops::Or(cands_once[unit], used[unit]), all_digits));
+      unique[unit] = Ops::AndNot(cands_twice[unit], cands_once[unit]);
+    }
+
+    Vec singles[kNumCells];
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        size_t cell = row * kBoardSize + col;
+        Vec cell_unique = Ops::Or(
+            Ops::Or(unique[row], unique[kBoardSize + col]),
+            unique[GetBoxUnit(row, col)]);
+
+        singles[cell] = Ops::And(cands[cell], Ops::Or(
+            Ops::IsSingleBit(cands[cell]), cell_unique));
+        conflicts = Ops::Or(conflicts, Ops::AndNot(
+            Ops::IsSingleBit(singles[cell]),
+            Ops::AndNot(Ops::IsZero(singles[cell]), all_lanes)));
+      }
+    }
+
+    // Stop working on boards with no solution
+    dead = Ops::Or(dead, Ops::AndNot(Ops::IsZero(conflicts), all_lanes));
+
+    placed = false;
+    for (size_t cell = 0; cell < kNumCells; cell++) {
+      Vec single = Ops::AndNot(dead, singles[cell]);
+      if (Ops::Any(single)) {
+        DigitMask* box = cells + cell * kMaskLanes;
+        Ops::Store(box, Ops::Or(Ops::Load(box), single));
+        placed = true;
+      }
+    }
+  }
+
+  // Nothing was placed in the last pass, so its candidates are current
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    Ops::Store(candidates + cell * kMaskLanes, cands[cell]);
+  }
+  Ops::Store(contradictions, dead);
+}
+
+}  // namespace kernel
+}  // namespace sudoku
+
+#endif  // FINALPROJECT_SRC_CANDIDATE_KERNEL_SIMD_H_
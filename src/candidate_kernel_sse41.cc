@@ -0,0 +1,123 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+// Compiled with SSE4.1 enabled, see src/CMakeLists.txt. Only called once
+// the CPU is known to support it
+
+#include "candidate_kernel_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) \
+    || defined(_M_IX86)
+
+#include <smmintrin.h>
+
+namespace sudoku {
+namespace kernel {
+
+namespace {
+
+// A board row of 16 masks doesn't fit in one 128-bit register, so each
+// operation is done on both halves
+struct Sse41Ops {
+  struct Vec {
+    __m128i lo;
+    __m128i hi;
+  };
+
+  static Vec Zero() {
+    return {_mm_setzero_si128(), _mm_setzero_si128()};
+  }
+
+  static Vec Set1(DigitMask mask) {
+    __m128i v = _mm_set1_epi16(static_cast<short>(mask));
+    return {v, v};
+  }
+
+  static Vec Load(const DigitMask* masks) {
+    auto ptr = reinterpret_cast<const __m128i*>(masks);
+    return {_mm_load_si128(ptr), _mm_load_si128(ptr + 1)};
+  }
+
+  static void Store(DigitMask* masks, const Vec& v) {
+    auto ptr = reinterpret_cast<__m128i*>(masks);
+    _mm_store_si128(ptr, v.lo);
+    _mm_store_si128(ptr + 1, v.hi);
+  }
+
+  static Vec Or(const Vec& a, const Vec& b) {
+    return {_mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi)};
+  }
+
+  static Vec And(const Vec& a, const Vec& b) {
+    return {_mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi)};
+  }
+
+  static Vec AndNot(const Vec& a, const Vec& b) {
+    return {_mm_andnot_si128(a.lo, b.lo), _mm_andnot_si128(a.hi, b.hi)};
+  }
+
+  static Vec IsZero(const Vec& v) {
+    __m128i zero = _mm_setzero_si128();
+    return {_mm_cmpeq_epi16(v.lo, zero), _mm_cmpeq_epi16(v.hi, zero)};
+  }
+
+  static __m128i IsSingleBit(__m128i v) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i lowest_cleared = _mm_and_si128(
+        v, _mm_sub_epi16(v, _mm_set1_epi16(1)));
+    return _mm_andnot_si128(_mm_cmpeq_epi16(v, zero),
+                            _mm_cmpeq_epi16(lowest_cleared, zero));
+  }
+
+  static Vec IsSingleBit(const Vec& v) {
+    return {IsSingleBit(v.lo), IsSingleBit(v.hi)};
+  }
+
+  static bool Any(const Vec& v) {
+    __m128i both = _mm_or_si128(v.lo, v.hi);
+    return _mm_testz_si128(both, both) == 0;
+  }
+
+  // Fold the lanes together in halves, swapping ever smaller groups, so
+  // every lane ends up with the result
+  static void ReduceLanes(const Vec& v, Vec* once, Vec* twice) {
+    __m128i seen_once = _mm_or_si128(v.lo, v.hi);
+    __m128i seen_twice = _mm_and_si128(v.lo, v.hi);
+
+    Combine(_mm_shuffle_epi32(seen_once, 0x4E),
+            _mm_shuffle_epi32(seen_twice, 0x4E), &seen_once, &seen_twice);
+    Combine(_mm_shuffle_epi32(seen_once, 0xB1),
+            _mm_shuffle_epi32(seen_twice, 0xB1), &seen_once, &seen_twice);
+    Combine(_mm_shufflehi_epi16(_mm_shufflelo_epi16(seen_once, 0xB1), 0xB1),
+            _mm_shufflehi_epi16(_mm_shufflelo_epi16(seen_twice, 0xB1), 0xB1),
+            &seen_once, &seen_twice);
+
+    *once = {seen_once, seen_once};
+    *twice = {seen_twice, seen_twice};
+  }
+
+  static void Combine(__m128i other_once, __m128i other_twice,
+                      __m128i* once, __m128i* twice) {
+    *twice = _mm_or_si128(_mm_or_si128(*twice, other_twice),
+                          _mm_and_si128(*once, other_once));
+    *once = _mm_or_si128(*once, other_once);
+  }
+};
+
+}  // namespace
+
+void ScanSse41(const DigitMask* placed,
+               DigitMask* candidates,
+               DigitMask* singles,
+               bool* is_contradiction) {
+  ScanRows<Sse41Ops>(placed, candidates, singles, is_contradiction);
+}
+
+void PropagateSse41(DigitMask* cells, DigitMask* candidates,
+                    DigitMask* contradictions) {
+  PropagateBoxes<Sse41Ops>(cells, candidates, contradictions);
+}
+
+}  // namespace kernel
+}  // namespace sudoku
+
+#endif
@@ -0,0 +1,298 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/canonical.h>
+
+#include <sudoku/board.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace sudoku {
+
+namespace {
+
+constexpr size_t kNumCells = kBoardSize * kBoardSize;
+
+// Numbers are relabeled in the order they're first seen, so this maps the
+// board's numbers to new ones. 0 means the number hasn't been seen yet
+using Labels = std::array<int, kBoardSize + 1>;
+
+// Empty boxes compare after every number. Putting the givens first means a
+// few boxes are usually enough to tell two arrangements apart, which lets the
+// search give up on bad ones much sooner
+constexpr int kEmptyLabel = kBoardSize + 1;
+
+Labels NewLabels() {
+  Labels labels{};
+  labels[0] = kEmptyLabel;
+  return labels;
+}
+
+// Finds the canonical form by trying every row arrangement, and for each one
+// building the columns left to right, abandoning any arrangement as soon as
+// its columns compare worse than the best found so far. Boards are compared
+// column by column, so each chosen column is a finished part of the answer,
+// and rows are dropped as soon as they can't start the first column well
+class Canonicalizer {
+ public:
+  explicit Canonicalizer(const Grid& board) : board_(board), best_{},
+                                              valid_columns_{0} {}
+
+  Grid Run() {
+    for (bool transpose : {false, true}) {
+      Grid source = board_;
+      if (transpose) {
+        for (size_t row = 0; row < kBoardSize; row++) {
+          for (size_t col = 0; col < kBoardSize; col++) {
+            source[row][col] = board_[col][row];
+          }
+        }
+      }
+
+      FindMatchingColumns(source);
+      SearchRows(source, 0, 0);
+    }
+
+    Grid canonical;
+    for (size_t col = 0; col < kBoardSize; col++) {
+      for (size_t row = 0; row < kBoardSize; row++) {
+        int label = best_[col * kBoardSize + row];
+        canonical[row][col] = label == kEmptyLabel ? 0 : label;
+      }
+    }
+
+    return canonical;
+  }
+
+ private:
+  // Choose the board row that goes in position `pos`, the same way columns
+  // are chosen. `used` has bit r set for every row already placed
+  void SearchRows(const Grid& source, size_t pos, unsigned used) {
+    if (pos == kBoardSize) {
+      SearchColumns(0, NewLabels(), 1, 0);
+      return;
+    }
+
+    size_t first_band = 0;
+    size_t last_band = kBoxSize;
+    if (pos % kBoxSize != 0) {
+      first_band = row_order_[pos - 1] / kBoxSize;
+      last_band = first_band + 1;
+    }
+
+    for (size_t band = first_band; band < last_band; band++) {
+      if (pos % kBoxSize == 0 && (used >> (band * kBoxSize) & 1u) != 0) {
+        continue;
+      }
+
+      for (size_t i = 0; i < kBoxSize; i++) {
+        size_t row = band * kBoxSize + i;
+        if ((used >> row & 1u) != 0) {
+          continue;
+        }
+
+        rows_[pos] = source[row];
+        row_order_[pos] = row;
+        if (CanMatchFirstColumn(pos + 1)) {
+          SearchRows(source, pos + 1, used | 1u << row);
+        }
+      }
+    }
+  }
+
+  // Numbers are relabeled starting from the first column, so the top `rows`
+  // boxes of the first column only depend on the top `rows` rows. If no
+  // column can start as small as the best board, no arrangement of the
+  // remaining rows can beat it
+  bool CanMatchFirstColumn(size_t rows) const {
+    if (valid_columns_ == 0) {
+      return true;
+    }
+
+    for (size_t col = 0; col < kBoardSize; col++) {
+      Labels labels = NewLabels();
+      int next_label = 1;
+      int comparison = 0;
+
+      for (size_t row = 0; row < rows && comparison == 0; row++) {
+        int num = rows_[row][col];
+        if (labels[num] == 0) {
+          labels[num] = next_label++;
+        }
+        comparison = labels[num] - best_[row];
+      }
+
+      if (comparison <= 0) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Reordering rows can't make two columns equal or different, so which
+  // columns/stacks match only needs to be worked out once per source board
+  void FindMatchingColumns(const Grid& source) {
+    for (size_t first = 0; first < kBoardSize; first++) {
+      for (size_t second = 0; second < kBoardSize; second++) {
+        bool match = true;
+        for (size_t row = 0; row < kBoardSize && match; row++) {
+          match = source[row][first] == source[row][second];
+        }
+        columns_match_[first][second] = match;
+      }
+    }
+
+    for (size_t first = 0; first < kBoxSize; first++) {
+      for (size_t second = 0; second < kBoxSize; second++) {
+        bool match = true;
+        for (size_t i = 0; i < kBoxSize && match; i++) {
+          match = columns_match_[first * kBoxSize + i][second * kBoxSize + i];
+        }
+        stacks_match_[first][second] = match;
+      }
+    }
+  }
+
+  // Choose the board column that goes in position `pos`. `used` has bit c set
+  // for every column already placed
+  void SearchColumns(size_t pos, const Labels& labels, int next_label,
+                     unsigned used) {
+    if (pos == kBoardSize) {
+      return;
+    }
+
+    if (pos % kBoxSize == 0) {
+      // Start a new stack. Stacks identical to one already tried would lead
+      // to exactly the same boards, so skip them
+      for (size_t stack = 0; stack < kBoxSize; stack++) {
+        bool is_repeat = (used >> (stack * kBoxSize) & 1u) != 0;
+        for (size_t other = 0; other < stack && !is_repeat; other++) {
+          is_repeat = (used >> (other * kBoxSize) & 1u) == 0
+                      && stacks_match_[stack][other];
+        }
+
+        if (!is_repeat) {
+          TryStackColumns(pos, stack, labels, next_label, used);
+        }
+      }
+    } else {
+      TryStackColumns(pos, col_order_[pos - 1] / kBoxSize, labels, next_label,
+                      used);
+    }
+  }
+
+  void TryStackColumns(size_t pos, size_t stack, const Labels& labels,
+                       int next_label, unsigned used) {
+    for (size_t i = 0; i < kBoxSize; i++) {
+      size_t col = stack * kBoxSize + i;
+      if ((used >> col & 1u) != 0) {
+        continue;
+      }
+
+      bool is_repeat = false;
+      for (size_t j = 0; j < i && !is_repeat; j++) {
+        size_t other = stack * kBoxSize + j;
+        is_repeat = (used >> other & 1u) == 0 && columns_match_[col][other];
+      }
+
+      if (!is_repeat) {
+        TryColumn(pos, col, labels, next_label, used);
+      }
+    }
+  }
+
+  void TryColumn(size_t pos, size_t col, Labels labels, int next_label,
+                 unsigned used) {
+    std::array<int, kBoardSize> values;
+    for (size_t row = 0; row < kBoardSize; row++) {
+      int num = rows_[row][col];
+      if (labels[num] == 0) {
+        labels[num] = next_label++;
+      }
+      values[row] = labels[num];
+    }
+
+    int* best_column = &best_[pos * kBoardSize];
+    if (pos < valid_columns_) {
+      int comparison = 0;
+      for (size_t row = 0; row < kBoardSize && comparison == 0; row++) {
+        comparison = values[row] - best_column[row];
+      }
+
+      if (comparison > 0) {
+        return;
+      }
+      if (comparison < 0) {
+        valid_columns_ = pos;
+      }
+    }
+
+    // Either this column ties with the best, or it starts a new best
+    if (pos >= valid_columns_) {
+      std::copy(values.begin(), values.end(), best_column);
+      valid_columns_ = pos + 1;
+    }
+
+    col_order_[pos] = col;
+    SearchColumns(pos + 1, labels, next_label, used | 1u << col);
+  }
+
+  const Grid& board_;
+
+  // Rows of the board in the arrangement being tried
+  Grid rows_;
+
+  std::array<std::array<bool, kBoardSize>, kBoardSize> columns_match_;
+  std::array<std::array<bool, kBoxSize>, kBoxSize> stacks_match_;
+
+  // The smallest board found so far, column by column, after relabeling.
+  // Columns past valid_columns_ are left over from an older best
+  std::array<int, kNumCells> best_;
+  size_t valid_columns_;
+
+  // Which board row/column was chosen for each position
+  std::array<size_t, kBoardSize> row_order_;
+  std::array<size_t, kBoardSize> col_order_;
+};
+
+std::string PackCanonical(const Grid& board) {
+  return PackBoard(GetCanonicalForm(board));
+}
+
+}  // namespace
+
+Grid GetCanonicalForm(const Grid& board) {
+  return Canonicalizer(board).Run();
+}
+
+std::string PackBoard(const Grid& board) {
+  std::string packed((kNumCells + 1) / 2, '\0');
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    auto num = static_cast<unsigned>(
+        board[cell / kBoardSize][cell % kBoardSize]);
+    packed[cell / 2] = static_cast<char>(
+        static_cast<unsigned char>(packed[cell / 2]) | num << (cell % 2 * 4));
+  }
+
+  return packed;
+}
+
+bool PuzzleIndex::Insert(const Grid& board) {
+  return keys_.insert(PackCanonical(board)).second;
+}
+
+bool PuzzleIndex::Contains(const Grid& board) const {
+  return keys_.count(PackCanonical(board)) != 0;
+}
+
+size_t PuzzleIndex::Size() const {
+  return keys_.size();
+}
+
+void PuzzleIndex::Clear() {
+  keys_.clear();
+}
+
+}  // namespace sudoku
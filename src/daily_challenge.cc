@@ -0,0 +1,88 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/daily_challenge.h>
+
+#include <sudoku/generator.h>
+#include <sudoku/random.h>
+
+#include <cstdio>
+#include <string>
+
+namespace sudoku {
+
+namespace {
+
+constexpr int64_t kSecondsPerDay = 24 * 60 * 60;
+const char kChallengeIdPrefix[] = "daily_";
+
+}  // namespace
+
+int64_t GetChallengeDay(int64_t unix_time) {
+  // Round down, for the rare time before 1970
+  int64_t day = unix_time / kSecondsPerDay;
+  if (unix_time % kSecondsPerDay < 0) {
+    day--;
+  }
+
+  return day;
+}
+
+std::string FormatChallengeDay(int64_t day) {
+  // Howard Hinnant's civil_from_days, counting in 400-year eras from
+  // 0000-03-01 so leap days fall at the end of each year
+  const int64_t shifted = day + 719468;
+  const int64_t era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+  const int64_t day_of_era = shifted - era * 146097;
+  const int64_t year_of_era = (day_of_era - day_of_era / 1460
+                               + day_of_era / 36524 - day_of_era / 146096)
+                              / 365;
+  const int64_t day_of_year = day_of_era
+                              - (365 * year_of_era + year_of_era / 4
+                                 - year_of_era / 100);
+  const int64_t month_index = (5 * day_of_year + 2) / 153;
+  const int64_t day_of_month = day_of_year - (153 * month_index + 2) / 5 + 1;
+  const int64_t month = month_index < 10 ? month_index + 3 : month_index - 9;
+  const int64_t year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+  char text[64];
+  std::snprintf(text, sizeof(text), "%04lld-%02lld-%02lld",
+                static_cast<long long>(year), static_cast<long long>(month),
+                static_cast<long long>(day_of_month));
+  return text;
+}
+
+void GenerateDailyChallenge(int64_t day, Grid* puzzle, Grid* solution) {
+  Random rng(static_cast<uint64_t>(day));
+  *solution = GenerateSolution(&rng);
+  *puzzle = GeneratePuzzle(*solution, &rng);
+}
+
+std::string GetChallengeId(int64_t day) {
+  return kChallengeIdPrefix + std::to_string(day);
+}
+
+bool ParseChallengeId(const std::string& id, int64_t* day) {
+  const std::string prefix = kChallengeIdPrefix;
+  if (id.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+
+  // The id is written by GetChallengeId, so anything else in it is garbage
+  size_t pos = prefix.size();
+  if (pos < id.size() && id[pos] == '-') {
+    pos++;
+  }
+  if (pos == id.size() || id.size() - pos > 18) {
+    return false;
+  }
+  for (size_t i = pos; i < id.size(); i++) {
+    if (id[i] < '0' || id[i] > '9') {
+      return false;
+    }
+  }
+
+  *day = std::stoll(id.substr(prefix.size()));
+  return true;
+}
+
+}  // namespace sudoku
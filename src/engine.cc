@@ -2,8 +2,13 @@
 
 #include <sudoku/engine.h>
 
+#include <sudoku/daily_challenge.h>
+#include <sudoku/generator.h>
+#include <sudoku/profiler.h>
+
 #include <chrono>
 #include <fstream>
+#include <random>
 
 #include <nlohmann/json.hpp>
 
@@ -19,34 +24,235 @@ using std::pair;
 
 namespace sudoku {
 
-Engine::Engine() : difficulty_{Difficulty::kEasy},
+constexpr int Engine::kBoardsPerTimedGame;
+
+namespace {
+
+uint64_t GetRandomSeed() {
+  std::random_device device;
+  return static_cast<uint64_t>(device()) << 32 | device();
+}
+
+
+}  // namespace
+
+Engine::Engine() : Engine(GetRandomSeed()) {}
+
+Engine::Engine(uint64_t seed) : difficulty_{Difficulty::kEasy},
               game_mode_{GameMode::kStandard},
+              challenge_day_{0},
+              challenge_difficulty_{Difficulty::kEasy},
               is_penciling_{false},
-              game_time_{0},
               games_completed_{0},
+              variant_{Variant::GetClassic()},
               easy_boards_{"easy_1.json", "easy_2.json", "easy_3.json"},
               medium_boards_{"medium_1.json", "medium_2.json", "medium_3.json"},
-              hard_boards_{"hard_1.json", "hard_2.json", "hard_3.json"}
+              hard_boards_{"hard_1.json", "hard_2.json", "hard_3.json"},
+              rng_{seed}
               {}
 
 void Engine::CreateGame() {
-  unsigned seed = time(nullptr);
-  std::srand(seed);
+  ScopedTimer timer("CreateGame");
 
-  // Get a board of the right difficulty
-  switch (difficulty_) {
-    case Difficulty::kEasy :
-      board_path_ = easy_boards_[std::rand() % 3];
+  SetBoard(*PrepareBoard(difficulty_));
+  PrefetchNextBoard();
+}
+
+bool Engine::CreateGame(std::string filepath) {
+  ScopedTimer timer("CreateGame");
+
+  PreparedBoard board;
+  board.path = filepath;
+  board.difficulty = difficulty_;
+  if (!ImportGameBoard(filepath, &board.entries, &board.solution)) {
+    return false;
+  }
+
+  SetBoard(board);
+  next_board_ = {};
+  return true;
+}
+
+void Engine::CreateDailyChallenge(int64_t day) {
+  ScopedTimer timer("CreateGame");
+
+  PreparedBoard board;
+  board.path = GetChallengeId(day);
+  board.difficulty = difficulty_;
+  GenerateDailyChallenge(day, &board.entries, &board.solution);
+
+  game_mode_ = GameMode::kDailyChallenge;
+  challenge_day_ = day;
+  challenge_difficulty_ = GradeDifficulty(board.entries, board.solution);
+  SetBoard(board);
+  next_board_ = {};
+}
+
+int64_t Engine::GetChallengeDay() const {
+  return challenge_day_;
+}
+
+Engine::Difficulty Engine::GetChallengeDifficulty() const {
+  return challenge_difficulty_;
+}
+
+Engine::Difficulty Engine::GradeDifficulty(const Grid& puzzle,
+                                           const Grid& solution) {
+  switch (GradePuzzle(puzzle, solution)) {
+    case Technique::kLockedCandidates :
+    case Technique::kNakedPair :
+      return Difficulty::kMedium;
+    case Technique::kSolution :
+      return Difficulty::kHard;
+    default :
+      return Difficulty::kEasy;
+  }
+}
+
+bool Engine::CreateVariantGame(std::shared_ptr<const Variant> variant) {
+  ScopedTimer timer("CreateGame");
+
+  // Generating a solution would never finish
+  if (!variant->IsWellFormed() || CountSolutions(Grid{}, 1, *variant) == 0) {
+    return false;
+  }
+
+  PreparedBoard board;
+  board.path = "variant";
+  board.difficulty = difficulty_;
+  board.solution = GenerateSolution(&rng_, *variant);
+  board.entries = GeneratePuzzle(board.solution, &rng_, *variant);
+  board.variant = std::move(variant);
+
+  SetBoard(board);
+  next_board_ = {};
+  return true;
+}
+
+void Engine::CreateKillerGame() {
+  ScopedTimer timer("CreateGame");
+
+  PreparedBoard board;
+  board.path = "killer";
+  board.difficulty = difficulty_;
+  board.solution = GenerateSolution(&rng_);
+  board.variant = std::make_shared<const Variant>(
+      KillerRules(RandomCages(board.solution, &rng_)));
+  board.entries = GeneratePuzzle(board.solution, &rng_, *board.variant);
+
+  SetBoard(board);
+  next_board_ = {};
+}
+
+const Variant& Engine::GetVariant() const {
+  return *variant_;
+}
+
+void Engine::StartNextBoard() {
+  ScopedTimer timer("StartNextBoard");
+
+  // Preparing boards isn't part of solving them
+  const bool was_paused = clock_.IsPaused();
+  clock_.Pause();
+
+  // Only missing if the game was restored from a snapshot
+  const std::shared_ptr<const PreparedBoard> board
+      = next_board_.valid() ? next_board_.get()
+                            : PrepareBoard(GetNextBoardDifficulty());
+  SetBoard(*board);
+  PrefetchNextBoard();
+
+  if (!was_paused) {
+    clock_.Resume();
+  }
+}
+
+bool Engine::HasNextBoard() const {
+  return next_board_.valid();
+}
+
+std::unique_ptr<Engine::PreparedBoard> Engine::PrepareBoard(
+    Difficulty difficulty, const std::map<std::string, std::string>& paths,
+    const PuzzleIndex& served, const BoardBank* bank, Random* rng) {
+  // Try the boards in a random order until one hasn't been served yet
+  std::vector<std::string> files;
+  for (const auto& path : paths) {
+    files.push_back(path.first);
+  }
+  RandomShuffle(files.begin(), files.end(), rng);
+
+  auto board = std::make_unique<PreparedBoard>();
+  board->difficulty = difficulty;
+
+  bool is_read = false;
+  for (const auto& file : files) {
+    // Boards that can't be read are passed over
+    const bool is_banked = bank != nullptr
+                           && bank->GetBoard(file, &board->entries,
+                                             &board->solution);
+    if (!is_banked && !ReadBoardPath(paths.at(file), &board->entries,
+                                     &board->solution)) {
+      continue;
+    }
+    board->path = file;
+    is_read = true;
+
+    if (!served.Contains(board->entries)) {
       break;
+    }
+  }
+
+  if (!is_read) {
+    // None of the difficulty's boards could be read, so make one up rather
+    // than serve an empty board
+    board->path = "generated";
+    board->solution = GenerateSolution(rng);
+    board->entries = GeneratePuzzle(board->solution, rng);
+  }
+
+  // Disguise the board, keeping the solution in step with it
+  const BoardTransform transform = RandomTransform(rng);
+  board->entries = ApplyTransform(board->entries, transform);
+  board->solution = ApplyTransform(board->solution, transform);
+
+  return board;
+}
+
+std::unique_ptr<Engine::PreparedBoard> Engine::PrepareBoard(
+    Difficulty difficulty) {
+  return PrepareBoard(difficulty,
+                      BoardBank::FindPaths(GetBoardFiles(difficulty)),
+                      served_puzzles_, board_bank_.get(), &rng_);
+}
+
+const std::vector<std::string>& Engine::GetBoardFiles(
+    Difficulty difficulty) const {
+  switch (difficulty) {
+    case Difficulty::kEasy :
+      return easy_boards_;
     case Difficulty::kMedium :
-      board_path_ = medium_boards_[std::rand() % 3];
-      break;
+      return medium_boards_;
     case Difficulty::kHard :
-      board_path_ = hard_boards_[std::rand() % 3];
-      break;
+      return hard_boards_;
+  }
+
+  return easy_boards_;
+}
+
+void Engine::SetBoard(const PreparedBoard& board) {
+  // Counted only once it's played, so a prepared board that's thrown away
+  // can still come up. A repeat means every board has been played, so the
+  // count starts over
+  if (!served_puzzles_.Insert(board.entries)) {
+    served_puzzles_.Clear();
+    served_puzzles_.Insert(board.entries);
   }
 
-  ImportGameBoard();
+  board_path_ = board.path;
+  difficulty_ = board.difficulty;
+  current_entries_ = board.entries;
+  solution_ = board.solution;
+  variant_ = board.variant;
 
   // Mark the starting entries as correct
   for (size_t row = 0; row < kBoardSize; row++) {
@@ -67,40 +273,65 @@ void Engine::CreateGame() {
   is_penciling_ = false;
 }
 
-void Engine::CreateGame(std::string filepath) {
-  board_path_ = filepath;
+void Engine::PrefetchNextBoard() {
+  next_board_ = {};
 
-  ImportGameBoard();
+  // The board being set is the (games_completed_ + 1)th of the game
+  if (games_completed_ + 1 >= GetBoardsPerGame()) {
+    return;
+  }
 
-  // Mark the starting entries as correct
-  for (size_t row = 0; row < kBoardSize; row++) {
-    for (size_t col = 0; col < kBoardSize; col++) {
-      if (current_entries_[row][col] != 0) {
-        entry_states_[row][col] = EntryState::kCorrect;
-      } else {
-        entry_states_[row][col] = EntryState::kUnknown;
-      }
+  // The worker gets its own copies, and a stream of numbers split off the
+  // engine's so seeded engines still deal the same boards. Asset lookup
+  // isn't safe off the main thread, so the files are found here
+  const Difficulty difficulty = GetNextBoardDifficulty();
+  next_board_ = std::async(
+      std::launch::async,
+      [difficulty, paths = BoardBank::FindPaths(GetBoardFiles(difficulty)),
+       served = served_puzzles_, bank = board_bank_,
+       rng = rng_.Split()]() mutable {
+        ScopedTimer timer("PrepareBoard");
+        return std::shared_ptr<const PreparedBoard>(
+            PrepareBoard(difficulty, paths, served, bank.get(), &rng));
+      }).share();
+}
 
-      // Start with no numbers penciled in
-      for (size_t num = 0; num < kBoardSize; num++) {
-        pencil_marks_[row][col][num] = false;
-      }
-    }
+Engine::Difficulty Engine::GetNextBoardDifficulty() const {
+  if (game_mode_ != GameMode::kTimeAttack) {
+    return difficulty_;
   }
 
-  is_penciling_ = false;
+  switch (difficulty_) {
+    case Difficulty::kEasy :
+      return Difficulty::kMedium;
+    case Difficulty::kMedium :
+      return Difficulty::kHard;
+    case Difficulty::kHard :
+      return Difficulty::kEasy;
+  }
+
+  return difficulty_;
 }
 
-void Engine::ImportGameBoard() {
-  std::ifstream infile;
-  infile.open(ci::app::getAssetPath(board_path_));
+std::vector<std::string> Engine::GetBoardFiles() const {
+  std::vector<std::string> files = easy_boards_;
+  files.insert(files.end(), medium_boards_.begin(), medium_boards_.end());
+  files.insert(files.end(), hard_boards_.begin(), hard_boards_.end());
 
-  // Load the file data into a JSON object
-  nlohmann::json board_data;
-  infile >> board_data;
+  return files;
+}
 
-  board_data.at("board").get_to(current_entries_);
-  board_data.at("solution").get_to(solution_);
+void Engine::UseBoardBank(std::shared_ptr<const BoardBank> bank) {
+  board_bank_ = std::move(bank);
+}
+
+bool Engine::ImportGameBoard(const std::string& file, Grid* entries,
+                             Grid* solution) const {
+  if (board_bank_ && board_bank_->GetBoard(file, entries, solution)) {
+    return true;
+  }
+
+  return ReadBoardFile(file, entries, solution);
 }
 
 int Engine::GetEntry(pair<int, int> entry) const {
@@ -125,6 +356,18 @@ void Engine::ClearPencilMarks(pair<int, int> entry) {
     pencil_marks_[entry.first][entry.second][num] = false;
   }
 }
+
+void Engine::AutoPencil() {
+  CandidateGrid candidates = ComputeCandidates(current_entries_, *variant_);
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      for (size_t num = 0; num < kBoardSize; num++) {
+        pencil_marks_[row][col][num]
+            = (candidates[row][col] & DigitBit(static_cast<int>(num) + 1)) != 0;
+      }
+    }
+  }
+}
 bool Engine::IsPenciling() const {
   return is_penciling_;
 }
@@ -162,67 +405,97 @@ void Engine::FillInCorrectEntry(pair<int, int> entry) {
   entry_states_[entry.first][entry.second] = EntryState::kCorrect;
 }
 
-void Engine::CheckBoard() {
+Hint Engine::GetHint() const {
+  CandidateGrid marks{};
   for (size_t row = 0; row < kBoardSize; row++) {
     for (size_t col = 0; col < kBoardSize; col++) {
-      if (current_entries_[row][col] == 0) {
-        entry_states_[row][col] = EntryState::kUnknown;
-      } else if (current_entries_[row][col] == solution_[row][col]) {
-        entry_states_[row][col] = EntryState::kCorrect;
-      } else {
-        entry_states_[row][col] = EntryState::kWrong;
+      for (size_t num = 0; num < kBoardSize; num++) {
+        if (pencil_marks_[row][col][num]) {
+          marks[row][col] |= DigitBit(static_cast<int>(num) + 1);
+        }
       }
     }
   }
+
+  return FindHint(current_entries_, solution_, marks, *variant_);
 }
 
-bool Engine::IsGameOver() const {
+void Engine::CheckBoard() {
   for (size_t row = 0; row < kBoardSize; row++) {
     for (size_t col = 0; col < kBoardSize; col++) {
-      if (GetEntryState({row, col}) != sudoku::Engine::EntryState::kCorrect) {
-        return false;
+      if (current_entries_[row][col] == 0) {
+        entry_states_[row][col] = EntryState::kUnknown;
+      } else if (variant_->IsInConflict(current_entries_,
+                                        row * kBoardSize + col)) {
+        entry_states_[row][col] = EntryState::kWrong;
+      } else {
+        entry_states_[row][col] = EntryState::kCorrect;
       }
     }
   }
+}
 
-  return true;
+bool Engine::IsGameOver() const {
+  return variant_->IsSolution(current_entries_);
 }
 
-int Engine::GetGameTime() const {
-  return game_time_;
+size_t Engine::GetGameTime() const {
+  return static_cast<size_t>(clock_.GetElapsed().count());
 }
 
-void Engine::SetGameMode(GameMode mode) {
-  game_mode_ = mode;
+void Engine::StartClock() {
+  clock_.Start();
+}
+
+void Engine::PauseClock() {
+  clock_.Pause();
+}
+
+void Engine::ResumeClock() {
+  clock_.Resume();
 }
 
-void Engine::UpdateGameTime() {
-  game_time_ = (int) std::chrono::duration_cast<std::chrono::seconds>
-      (std::chrono::system_clock::now() - start_time_).count();
+bool Engine::IsClockPaused() const {
+  return clock_.IsPaused();
+}
+
+const std::vector<GameClock::Milliseconds>& Engine::GetSplitTimes() const {
+  return clock_.GetSplits();
+}
+
+void Engine::SetGameMode(GameMode mode) {
+  game_mode_ = mode;
 }
 
 Engine::GameMode Engine::GetGameMode() const {
   return game_mode_;
 }
 
+int Engine::GetBoardsPerGame() const {
+  if (game_mode_ == GameMode::kTimeTrial
+      || game_mode_ == GameMode::kTimeAttack) {
+    return kBoardsPerTimedGame;
+  }
+
+  return 1;
+}
+
 int Engine::GetGamesCompleted() const {
   return games_completed_;
 }
 
 void Engine::IncreaseGamesCompleted() {
   games_completed_++;
-}
-
-void Engine::SetStartTime(std::chrono::time_point
-                                       <std::chrono::system_clock> time) {
-  start_time_ = time;
+  clock_.Split();
 }
 
 void Engine::ResetGame() {
   is_penciling_ = false;
-  game_time_ = 0;
+  clock_.Reset();
   game_mode_ = GameMode::kStandard;
+  challenge_day_ = 0;
   games_completed_ = 0;
+  next_board_ = {};
 
   for (size_t row = 0; row < kBoardSize; row++) {
     for (size_t col = 0; col < kBoardSize; col++) {
@@ -0,0 +1,72 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/file_util.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace sudoku {
+
+bool ReplaceFile(const std::string& replacement, const std::string& path) {
+#ifdef _WIN32
+  // Windows won't rename over a file that's there
+  std::remove(path.c_str());
+#endif
+  return std::rename(replacement.c_str(), path.c_str()) == 0;
+}
+
+bool SyncDirectory(const std::string& path) {
+#ifdef _WIN32
+  // Renames are written through on Windows
+  static_cast<void>(path);
+  return true;
+#else
+  const size_t slash = path.find_last_of('/');
+  const std::string directory = slash == std::string::npos
+                                ? "."
+                                : path.substr(0, std::max<size_t>(slash, 1));
+  const int fd = open(directory.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  const bool is_synced = fsync(fd) == 0;
+  close(fd);
+  return is_synced;
+#endif
+}
+
+bool WriteFileAtomically(const std::string& path, const std::string& data) {
+  const std::string temp_path = path + ".tmp";
+  std::FILE* temp = std::fopen(temp_path.c_str(), "wb");
+  if (temp == nullptr) {
+    return false;
+  }
+
+  bool is_written = std::fwrite(data.data(), 1, data.size(), temp)
+                    == data.size()
+                    && std::fflush(temp) == 0;
+#ifdef _WIN32
+  is_written = is_written && _commit(_fileno(temp)) == 0;
+#else
+  is_written = is_written && fsync(fileno(temp)) == 0;
+#endif
+  is_written = std::fclose(temp) == 0 && is_written;
+
+  if (!is_written || !ReplaceFile(temp_path, path)) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+}  // namespace sudoku
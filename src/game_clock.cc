@@ -0,0 +1,87 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/game_clock.h>
+
+#include <chrono>
+#include <vector>
+
+namespace sudoku {
+
+using std::chrono::duration_cast;
+
+GameClock::GameClock() : accumulated_{Clock::duration::zero()},
+                         resumed_at_{Clock::now()},
+                         is_paused_{true},
+                         last_split_{Clock::duration::zero()} {}
+
+void GameClock::Start() {
+  accumulated_ = Clock::duration::zero();
+  last_split_ = Clock::duration::zero();
+  splits_.clear();
+  resumed_at_ = Clock::now();
+  is_paused_ = false;
+}
+
+void GameClock::Pause() {
+  if (!is_paused_) {
+    accumulated_ += Clock::now() - resumed_at_;
+    is_paused_ = true;
+  }
+}
+
+void GameClock::Resume() {
+  if (is_paused_) {
+    resumed_at_ = Clock::now();
+    is_paused_ = false;
+  }
+}
+
+bool GameClock::IsPaused() const {
+  return is_paused_;
+}
+
+void GameClock::Split() {
+  Clock::duration elapsed = GetRawElapsed();
+  splits_.push_back(duration_cast<Milliseconds>(elapsed - last_split_));
+  last_split_ = elapsed;
+}
+
+GameClock::Milliseconds GameClock::GetElapsed() const {
+  return duration_cast<Milliseconds>(GetRawElapsed());
+}
+
+const std::vector<GameClock::Milliseconds>& GameClock::GetSplits() const {
+  return splits_;
+}
+
+void GameClock::Restore(Milliseconds elapsed,
+                        const std::vector<Milliseconds>& splits,
+                        bool paused) {
+  accumulated_ = elapsed;
+  splits_ = splits;
+
+  last_split_ = Clock::duration::zero();
+  for (const auto& split : splits_) {
+    last_split_ += split;
+  }
+
+  resumed_at_ = Clock::now();
+  is_paused_ = paused;
+}
+
+void GameClock::Reset() {
+  accumulated_ = Clock::duration::zero();
+  last_split_ = Clock::duration::zero();
+  splits_.clear();
+  is_paused_ = true;
+}
+
+GameClock::Clock::duration GameClock::GetRawElapsed() const {
+  if (is_paused_) {
+    return accumulated_;
+  }
+
+  return accumulated_ + (Clock::now() - resumed_at_);
+}
+
+}  // namespace sudoku
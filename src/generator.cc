@@ -0,0 +1,36 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/generator.h>
+
+#include <sudoku/board.h>
+#include <sudoku/solver.h>
+#include <sudoku/variant.h>
+
+#include <array>
+
+namespace sudoku {
+
+Grid RemoveGivens(const Grid& solution,
+                  const std::array<size_t, kBoardSize * kBoardSize>& cells) {
+  return RemoveGivens(solution, cells, *Variant::GetClassic());
+}
+
+Grid RemoveGivens(const Grid& solution,
+                  const std::array<size_t, kBoardSize * kBoardSize>& cells,
+                  const Variant& variant) {
+  Grid puzzle = solution;
+  for (size_t cell : cells) {
+    size_t row = cell / kBoardSize;
+    size_t col = cell % kBoardSize;
+
+    int num = puzzle[row][col];
+    puzzle[row][col] = 0;
+    if (CountSolutions(puzzle, 2, variant) != 1) {
+      puzzle[row][col] = num;
+    }
+  }
+
+  return puzzle;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,411 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/hint.h>
+
+#include <sudoku/board.h>
+#include <sudoku/variant.h>
+
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace sudoku {
+
+namespace {
+
+bool IsHarder(Technique first, Technique second) {
+  return static_cast<int>(first) > static_cast<int>(second);
+}
+
+Hint MakeHint(Technique technique, size_t row, size_t col, int num) {
+  return {technique,
+          Technique::kNone,
+          {static_cast<int>(row), static_cast<int>(col)},
+          num};
+}
+
+// Look for a box whose number can be placed directly from the candidates
+bool FindSingle(const Grid& entries,
+                const CandidateGrid& candidates,
+                Hint* hint) {
+  const auto& units = GetUnits();
+
+  for (const auto& unit : units) {
+    size_t empty_count = 0;
+    DigitMask used = 0;
+    std::pair<size_t, size_t> empty_box;
+
+    for (const auto& box : unit) {
+      if (entries[box.first][box.second] == 0) {
+        empty_count++;
+        empty_box = box;
+      } else {
+        used |= DigitBit(entries[box.first][box.second]);
+      }
+    }
+
+    if (empty_count == 1) {
+      *hint = MakeHint(Technique::kFullHouse, empty_box.first, empty_box.second,
+                       LowestDigit(static_cast<DigitMask>(kAllDigits & ~used)));
+      return true;
+    }
+  }
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (entries[row][col] == 0 && CountDigits(candidates[row][col]) == 1) {
+        *hint = MakeHint(Technique::kNakedSingle, row, col,
+                         LowestDigit(candidates[row][col]));
+        return true;
+      }
+    }
+  }
+
+  for (const auto& unit : units) {
+    // Numbers that are candidates in at least one/two boxes of the unit
+    DigitMask seen_once = 0;
+    DigitMask seen_twice = 0;
+    for (const auto& box : unit) {
+      DigitMask mask = candidates[box.first][box.second];
+      seen_twice |= seen_once & mask;
+      seen_once |= mask;
+    }
+
+    DigitMask hidden = static_cast<DigitMask>(seen_once & ~seen_twice);
+    if (hidden == 0) {
+      continue;
+    }
+
+    for (const auto& box : unit) {
+      DigitMask mask = candidates[box.first][box.second] & hidden;
+      if (mask != 0) {
+        *hint = MakeHint(Technique::kHiddenSingle, box.first, box.second,
+                         LowestDigit(mask));
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Remove the numbers in `mask` from every box of the unit that isn't
+// excluded. Returns true if anything was removed
+template <typename Excluded>
+bool RemoveFromUnit(const Unit& unit,
+                    DigitMask mask,
+                    Excluded is_excluded,
+                    CandidateGrid* candidates) {
+  bool changed = false;
+  for (const auto& box : unit) {
+    DigitMask& box_candidates = (*candidates)[box.first][box.second];
+    if (!is_excluded(box) && (box_candidates & mask) != 0) {
+      box_candidates = static_cast<DigitMask>(box_candidates & ~mask);
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+// Where a number's candidates in a 3x3 box all lie in one row or column,
+// (or the reverse), it can be removed from the rest of the other unit
+bool EliminateLockedCandidates(CandidateGrid* candidates) {
+  const auto& units = GetUnits();
+  bool changed = false;
+
+  for (size_t box_unit = 2 * kBoardSize; box_unit < kNumUnits; box_unit++) {
+    size_t box = box_unit - 2 * kBoardSize;
+
+    for (size_t line_unit = 0; line_unit < 2 * kBoardSize; line_unit++) {
+      size_t line = line_unit % kBoardSize;
+      bool is_row = line_unit < kBoardSize;
+
+      // Skip lines that don't pass through the box
+      size_t box_line = is_row ? (box / kBoxSize) * kBoxSize
+                               : (box % kBoxSize) * kBoxSize;
+      if (line < box_line || line >= box_line + kBoxSize) {
+        continue;
+      }
+
+      auto in_line = [&](const std::pair<size_t, size_t>& pos) {
+        return (is_row ? pos.first : pos.second) == line;
+      };
+      auto in_box = [&](const std::pair<size_t, size_t>& pos) {
+        return BoxIndex(pos.first, pos.second) == box;
+      };
+
+      DigitMask overlap = 0;
+      DigitMask box_rest = 0;
+      for (const auto& pos : units[box_unit]) {
+        if (in_line(pos)) {
+          overlap |= (*candidates)[pos.first][pos.second];
+        } else {
+          box_rest |= (*candidates)[pos.first][pos.second];
+        }
+      }
+
+      DigitMask line_rest = 0;
+      for (const auto& pos : units[line_unit]) {
+        if (!in_box(pos)) {
+          line_rest |= (*candidates)[pos.first][pos.second];
+        }
+      }
+
+      auto pointing = static_cast<DigitMask>(overlap & ~box_rest);
+      auto claiming = static_cast<DigitMask>(overlap & ~line_rest);
+      changed |= RemoveFromUnit(units[line_unit], pointing, in_box, candidates);
+      changed |= RemoveFromUnit(units[box_unit], claiming, in_line, candidates);
+    }
+  }
+
+  return changed;
+}
+
+// Where two boxes in a unit have the same two candidates, those numbers
+// can't go anywhere else in the unit
+bool EliminateNakedPairs(CandidateGrid* candidates) {
+  bool changed = false;
+
+  for (const auto& unit : GetUnits()) {
+    for (size_t first = 0; first < kBoardSize; first++) {
+      DigitMask pair = (*candidates)[unit[first].first][unit[first].second];
+      if (CountDigits(pair) != 2) {
+        continue;
+      }
+
+      for (size_t second = first + 1; second < kBoardSize; second++) {
+        if ((*candidates)[unit[second].first][unit[second].second] != pair) {
+          continue;
+        }
+
+        auto in_pair = [&](const std::pair<size_t, size_t>& pos) {
+          return pos == unit[first] || pos == unit[second];
+        };
+        changed |= RemoveFromUnit(unit, pair, in_pair, candidates);
+      }
+    }
+  }
+
+  return changed;
+}
+
+bool FindIncorrectEntry(const Grid& entries, const Grid& solution,
+                        Hint* hint) {
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (entries[row][col] != 0 && entries[row][col] != solution[row][col]) {
+        *hint = MakeHint(Technique::kIncorrectEntry, row, col,
+                         solution[row][col]);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Narrow down the candidates with the pencil marks. Pencil marks missing
+// the right number are mistakes, so those are ignored. Returns the empty box
+// with the fewest candidates, or kBoardSize for both if the board is full
+std::pair<size_t, size_t> ApplyPencilMarks(const Grid& entries,
+                                           const Grid& solution,
+                                           const CandidateGrid& pencil_marks,
+                                           CandidateGrid* candidates) {
+  size_t fewest_row = kBoardSize;
+  size_t fewest_col = kBoardSize;
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (entries[row][col] != 0) {
+        continue;
+      }
+
+      DigitMask marks = pencil_marks[row][col];
+      if ((marks & DigitBit(solution[row][col])) != 0) {
+        (*candidates)[row][col] &= marks;
+      }
+
+      if (fewest_row == kBoardSize
+          || CountDigits((*candidates)[row][col])
+             < CountDigits((*candidates)[fewest_row][fewest_col])) {
+        fewest_row = row;
+        fewest_col = col;
+      }
+    }
+  }
+
+  return {fewest_row, fewest_col};
+}
+
+// FindSingle with a variant's groups in place of the classic units
+bool FindVariantSingle(const Grid& entries,
+                       const CandidateGrid& candidates,
+                       const Variant& variant,
+                       Hint* hint) {
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (entries[row][col] == 0 && CountDigits(candidates[row][col]) == 1) {
+        *hint = MakeHint(Technique::kNakedSingle, row, col,
+                         LowestDigit(candidates[row][col]));
+        return true;
+      }
+    }
+  }
+
+  const auto& groups = variant.GetRules().groups;
+  for (size_t group : variant.GetFullGroups()) {
+    DigitMask seen_once = 0;
+    DigitMask seen_twice = 0;
+    for (size_t cell : groups[group]) {
+      DigitMask mask = candidates[cell / kBoardSize][cell % kBoardSize];
+      seen_twice |= seen_once & mask;
+      seen_once |= mask;
+    }
+
+    DigitMask hidden = static_cast<DigitMask>(seen_once & ~seen_twice);
+    for (size_t cell : groups[group]) {
+      size_t row = cell / kBoardSize;
+      size_t col = cell % kBoardSize;
+      DigitMask mask = candidates[row][col] & hidden;
+      if (mask != 0) {
+        *hint = MakeHint(Technique::kHiddenSingle, row, col,
+                         LowestDigit(mask));
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+Hint FindHint(const Grid& entries,
+              const Grid& solution,
+              const CandidateGrid& pencil_marks) {
+  Hint hint = MakeHint(Technique::kNone, 0, 0, 0);
+  if (FindIncorrectEntry(entries, solution, &hint)) {
+    return hint;
+  }
+
+  CandidateGrid candidates = ComputeCandidates(entries);
+  size_t fewest_row;
+  size_t fewest_col;
+  std::tie(fewest_row, fewest_col)
+      = ApplyPencilMarks(entries, solution, pencil_marks, &candidates);
+
+  // The board is already solved
+  if (fewest_row == kBoardSize) {
+    return hint;
+  }
+
+  // Try placing a number, and if that fails, rule out candidates with
+  // harder techniques and try again
+  Technique elimination = Technique::kNone;
+  while (true) {
+    if (FindSingle(entries, candidates, &hint)) {
+      hint.elimination = elimination;
+      return hint;
+    }
+
+    Technique used = Technique::kNone;
+    if (EliminateLockedCandidates(&candidates)) {
+      used = Technique::kLockedCandidates;
+    } else if (EliminateNakedPairs(&candidates)) {
+      used = Technique::kNakedPair;
+    } else {
+      break;
+    }
+
+    if (IsHarder(used, elimination)) {
+      elimination = used;
+    }
+  }
+
+  return MakeHint(Technique::kSolution, fewest_row, fewest_col,
+                  solution[fewest_row][fewest_col]);
+}
+
+Hint FindHint(const Grid& entries,
+              const Grid& solution,
+              const CandidateGrid& pencil_marks,
+              const Variant& variant) {
+  if (variant.IsClassic()) {
+    return FindHint(entries, solution, pencil_marks);
+  }
+
+  Hint hint = MakeHint(Technique::kNone, 0, 0, 0);
+  if (FindIncorrectEntry(entries, solution, &hint)) {
+    return hint;
+  }
+
+  CandidateGrid candidates = ComputeCandidates(entries, variant);
+  size_t fewest_row;
+  size_t fewest_col;
+  std::tie(fewest_row, fewest_col)
+      = ApplyPencilMarks(entries, solution, pencil_marks, &candidates);
+
+  if (fewest_row == kBoardSize) {
+    return hint;
+  }
+  if (FindVariantSingle(entries, candidates, variant, &hint)) {
+    return hint;
+  }
+
+  return MakeHint(Technique::kSolution, fewest_row, fewest_col,
+                  solution[fewest_row][fewest_col]);
+}
+
+Technique GradePuzzle(const Grid& puzzle, const Grid& solution) {
+  const CandidateGrid no_marks{};
+  Grid entries = puzzle;
+  Technique hardest = Technique::kNone;
+
+  while (true) {
+    Hint hint = FindHint(entries, solution, no_marks);
+    if (hint.technique == Technique::kNone) {
+      return hardest;
+    }
+
+    for (Technique used : {hint.technique, hint.elimination}) {
+      if (IsHarder(used, hardest)) {
+        hardest = used;
+      }
+    }
+    entries[hint.entry.first][hint.entry.second] = hint.num;
+  }
+}
+
+std::string GetTechniqueName(Technique technique) {
+  switch (technique) {
+    case Technique::kNone :
+      return "None";
+    case Technique::kIncorrectEntry :
+      return "Incorrect Entry";
+    case Technique::kFullHouse :
+      return "Full House";
+    case Technique::kNakedSingle :
+      return "Naked Single";
+    case Technique::kHiddenSingle :
+      return "Hidden Single";
+    case Technique::kLockedCandidates :
+      return "Locked Candidates";
+    case Technique::kNakedPair :
+      return "Naked Pair";
+    case Technique::kSolution :
+      return "Solution";
+  }
+
+  return "";
+}
+
+std::string DescribeHint(const Hint& hint) {
+  std::string description = GetTechniqueName(hint.technique);
+  if (hint.elimination != Technique::kNone) {
+    description += " after " + GetTechniqueName(hint.elimination);
+  }
+
+  return description;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,91 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/layout.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sudoku {
+
+constexpr float Layout::kDesignSize;
+constexpr float Layout::kGridSize;
+
+Layout::Layout() : bounds_{{0, 0}, {kDesignSize, kDesignSize}} {
+  // Whole units, so box edges land on pixel boundaries at the design size
+  tile_size_ = std::floor(kGridSize / static_cast<float>(kBoardSize));
+
+  const float grid_extent = tile_size_ * static_cast<float>(kBoardSize);
+  grid_origin_ = {(kDesignSize - grid_extent) / 2,
+                  (kDesignSize - grid_extent) / 2};
+
+  Resize({static_cast<int>(kDesignSize), static_cast<int>(kDesignSize)}, 1);
+}
+
+void Layout::Resize(const ci::ivec2& window_size, float content_scale) {
+  const auto width = static_cast<float>(window_size.x);
+  const auto height = static_cast<float>(window_size.y);
+
+  // Fit the square in the shorter side, centered along the longer one
+  scale_ = std::max(std::min(width, height), 1.0f) / kDesignSize;
+  content_scale_ = content_scale;
+  origin_ = {(width - kDesignSize * scale_) / 2,
+             (height - kDesignSize * scale_) / 2};
+}
+
+float Layout::GetScale() const {
+  return scale_;
+}
+
+ci::vec2 Layout::GetOrigin() const {
+  return origin_;
+}
+
+float Layout::GetPixelScale() const {
+  return scale_ * content_scale_;
+}
+
+ci::vec2 Layout::ToDesign(const ci::vec2& window_point) const {
+  return {(window_point.x - origin_.x) / scale_,
+          (window_point.y - origin_.y) / scale_};
+}
+
+ci::vec2 Layout::ToWindow(const ci::vec2& design_point) const {
+  return {origin_.x + design_point.x * scale_,
+          origin_.y + design_point.y * scale_};
+}
+
+const Box& Layout::GetBounds() const {
+  return bounds_;
+}
+
+ci::vec2 Layout::GetCenter() const {
+  return {kDesignSize / 2, kDesignSize / 2};
+}
+
+float Layout::GetTileSize() const {
+  return tile_size_;
+}
+
+Box Layout::GetCellBox(size_t row, size_t col) const {
+  const ci::vec2 top_left(
+      grid_origin_.x + static_cast<float>(col) * tile_size_,
+      grid_origin_.y + static_cast<float>(row) * tile_size_);
+
+  return {top_left, {top_left.x + tile_size_, top_left.y + tile_size_}};
+}
+
+bool Layout::GetCellAt(const ci::vec2& design_point,
+                       std::pair<int, int>* cell) const {
+  const float col = std::floor((design_point.x - grid_origin_.x) / tile_size_);
+  const float row = std::floor((design_point.y - grid_origin_.y) / tile_size_);
+
+  const auto board_size = static_cast<float>(kBoardSize);
+  if (row < 0 || row >= board_size || col < 0 || col >= board_size) {
+    return false;
+  }
+
+  *cell = {static_cast<int>(row), static_cast<int>(col)};
+  return true;
+}
+
+}  // namespace sudoku
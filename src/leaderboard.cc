@@ -5,7 +5,15 @@
 
 #include <sqlite_modern_cpp.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <sstream>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace sudoku {
@@ -15,55 +23,329 @@ using std::vector;
 
 // See examples: https://github.com/SqliteModernCpp/sqlite_modern_cpp/tree/dev
 
-LeaderBoard::LeaderBoard(const string& db_path) : db_{db_path} {
+// Bumped whenever existing rows need to be migrated to a new format
+// Version 1: times are stored in milliseconds instead of seconds
+// Version 2: names are kept once in the players table, and times refer to
+//            them by id
+// Version 3: each player's record is kept up to date in player_stats
+// Version 4: times have when they were submitted, and the best times of the
+//            current day and week are kept in window_best
+const int kSchemaVersion = 4;
+
+int64_t GetWindowStart(LeaderBoardWindow window, int64_t unix_time) {
+  constexpr int64_t kDay = 24 * 60 * 60;
+  constexpr int64_t kWeek = 7 * kDay;
+
+  // The epoch was a Thursday, so weeks start 4 days after a multiple of 7
+  constexpr int64_t kMondayOffset = 4 * kDay;
+
+  auto round_down = [](int64_t time, int64_t period) {
+    return time - ((time % period) + period) % period;
+  };
+
+  switch (window) {
+    case LeaderBoardWindow::kAllTime :
+      return 0;
+    case LeaderBoardWindow::kDaily :
+      return round_down(unix_time, kDay);
+    case LeaderBoardWindow::kWeekly :
+      return round_down(unix_time - kMondayOffset, kWeek) + kMondayOffset;
+  }
+
+  return 0;
+}
+
+int64_t GetUnixTime() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+namespace {
+
+// Profiles kept in memory before the caches are emptied
+constexpr size_t kMaxCachedPlayers = 10000;
+
+void PrintError(const sqlite::sqlite_exception& e) {
+  std::cerr << e.get_code() << ": " << e.what() << " during " << e.get_sql()
+            << std::endl;
+}
+
+void CreateTimesTable(sqlite::database* db, const string& table) {
+  *db << "CREATE TABLE " + table + " (\n"
+         "  player_id INTEGER NOT NULL REFERENCES players (id),\n"
+         "  time INTEGER NOT NULL,\n"
+         "  mode TEXT NOT NULL,\n"
+         "  difficulty TEXT NOT NULL,\n"
+         "  submitted_at INTEGER NOT NULL DEFAULT 0\n"
+         ");";
+}
+
+void CreateWindowTable(sqlite::database* db) {
+  *db << "CREATE TABLE window_best (\n"
+         "  window_kind INTEGER NOT NULL,\n"
+         "  window_start INTEGER NOT NULL,\n"
+         "  player_id INTEGER NOT NULL REFERENCES players (id),\n"
+         "  time INTEGER NOT NULL,\n"
+         "  submitted_at INTEGER NOT NULL,\n"
+         "  mode TEXT NOT NULL,\n"
+         "  difficulty TEXT NOT NULL\n"
+         ");";
+  *db << "CREATE INDEX window_best_by_time on window_best\n"
+         "  (window_kind, mode, difficulty, window_start, time);";
+}
+
+// A row of player_stats. The recent times are oldest first, and stored as
+// text separated by spaces
+struct StatsRow {
+  size_t games = 0;
+  size_t best_time = 0;
+  size_t total_time = 0;
+  vector<size_t> recent_times;
+};
+
+void AddToStats(StatsRow* stats, size_t time) {
+  if (stats->games == 0 || time < stats->best_time) {
+    stats->best_time = time;
+  }
+  stats->games++;
+  stats->total_time += time;
+
+  stats->recent_times.push_back(time);
+  if (stats->recent_times.size() > kRecentGames) {
+    stats->recent_times.erase(stats->recent_times.begin());
+  }
+}
+
+size_t GetMedian(vector<size_t> times) {
+  if (times.empty()) {
+    return 0;
+  }
+
+  std::sort(times.begin(), times.end());
+  const size_t middle = times.size() / 2;
+  if (times.size() % 2 == 1) {
+    return times[middle];
+  }
+
+  return (times[middle - 1] + times[middle]) / 2;
+}
+
+string JoinTimes(const vector<size_t>& times) {
+  string text;
+  for (size_t time : times) {
+    if (!text.empty()) {
+      text += " ";
+    }
+    text += std::to_string(time);
+  }
+
+  return text;
+}
+
+vector<size_t> SplitTimes(const string& text) {
+  vector<size_t> times;
+  std::istringstream stream(text);
+  size_t time;
+  while (stream >> time) {
+    times.push_back(time);
+  }
+
+  return times;
+}
+
+void CreateStatsTable(sqlite::database* db) {
+  *db << "CREATE TABLE player_stats (\n"
+         "  player_id INTEGER NOT NULL REFERENCES players (id),\n"
+         "  mode TEXT NOT NULL,\n"
+         "  difficulty TEXT NOT NULL,\n"
+         "  games INTEGER NOT NULL,\n"
+         "  best_time INTEGER NOT NULL,\n"
+         "  total_time INTEGER NOT NULL,\n"
+         "  recent_times TEXT NOT NULL,\n"
+         "  recent_median_time INTEGER NOT NULL,\n"
+         "  PRIMARY KEY (player_id, mode, difficulty)\n"
+         ");";
+}
+
+void PutStatsRow(sqlite::database* db, int64_t player_id, const string& mode,
+                 const string& difficulty, const StatsRow& stats) {
+  *db << "insert or replace into player_stats values (?,?,?,?,?,?,?,?);"
+      << player_id
+      << mode
+      << difficulty
+      << stats.games
+      << stats.best_time
+      << stats.total_time
+      << JoinTimes(stats.recent_times)
+      << GetMedian(stats.recent_times);
+}
+
+// Work out every player's record from the times already there
+void FillStatsTable(sqlite::database* db) {
+  std::map<std::tuple<int64_t, string, string>, StatsRow> all_stats;
+  *db << "select player_id, mode, difficulty, time from leaderboard "
+         "order by rowid;"
+      >> [&all_stats](int64_t player_id, string mode, string difficulty,
+                      size_t time) {
+        AddToStats(&all_stats[std::make_tuple(player_id, mode, difficulty)],
+                   time);
+      };
+
+  for (const auto& entry : all_stats) {
+    PutStatsRow(db, std::get<0>(entry.first), std::get<1>(entry.first),
+                std::get<2>(entry.first), entry.second);
+  }
+}
+
+}  // namespace
+
+SqliteLeaderBoard::SqliteLeaderBoard(const string& db_path) : db_{db_path} {
   try {
-    db_ << "CREATE TABLE if not exists leaderboard (\n"
-           "  name  TEXT NOT NULL,\n"
-           "  time INTEGER NOT NULL\n"
-           "  mode TEXT NOT NULL\n"
-           "  difficulty TEXT NOT NULL\n"
+    int version = 0;
+    db_ << "PRAGMA user_version;" >> version;
+    int tables = 0;
+    db_ << "select count(*) from sqlite_master "
+           "where type = 'table' and name = 'leaderboard';"
+        >> tables;
+
+    if (tables == 0 || version < kSchemaVersion) {
+      db_ << "begin;";
+      db_ << "CREATE TABLE if not exists players (\n"
+             "  id INTEGER PRIMARY KEY,\n"
+             "  name TEXT NOT NULL UNIQUE\n"
+             ");";
+
+      if (tables == 0) {
+        CreateTimesTable(&db_, "leaderboard");
+        CreateStatsTable(&db_);
+        CreateWindowTable(&db_);
+      } else {
+        if (version < 1) {
+          db_ << "update leaderboard set time = time * 1000;";
+        }
+        if (version < 2) {
+          db_ << "insert or ignore into players (name) "
+                 "select distinct name from leaderboard;";
+          CreateTimesTable(&db_, "leaderboard_by_id");
+          db_ << "insert into leaderboard_by_id "
+                 "  (player_id, time, mode, difficulty) "
+                 "select players.id, time, mode, difficulty "
+                 "from leaderboard join players using (name);";
+          db_ << "drop table leaderboard;";
+          db_ << "alter table leaderboard_by_id rename to leaderboard;";
+        }
+        if (version < 3) {
+          CreateStatsTable(&db_);
+          FillStatsTable(&db_);
+        }
+        if (version < 4) {
+          // Tables made by the version 2 step above already have it. Older
+          // times weren't dated, so they stay out of the windows
+          if (version >= 2) {
+            db_ << "alter table leaderboard add column "
+                   "submitted_at INTEGER NOT NULL DEFAULT 0;";
+          }
+          CreateWindowTable(&db_);
+        }
+      }
+
+      db_ << "PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";";
+      db_ << "commit;";
+    }
+
+    // Most queries are for one mode and difficulty, in order of time. A
+    // player's own times are found through the second index
+    db_ << "CREATE INDEX if not exists leaderboard_by_time\n"
+           "  on leaderboard (mode, difficulty, time);";
+    db_ << "CREATE INDEX if not exists leaderboard_by_player\n"
+           "  on leaderboard (player_id, mode, difficulty, time);";
+
+    // Only written by copies from other databases, which older versions
+    // never made
+    db_ << "CREATE TABLE if not exists copied_rows (\n"
+           "  source TEXT PRIMARY KEY,\n"
+           "  last_rowid INTEGER NOT NULL\n"
            ");";
   } catch (const sqlite::sqlite_exception& e) {
-    std::cerr  << e.get_code() << ": " << e.what() << " during "
-               << e.get_sql() << std::endl;
+    PrintError(e);
+
+    // Otherwise every later write would join the half done migration, and
+    // be lost with it when the database is closed
+    RollBackOpenTransaction();
   }
 }
 
-void LeaderBoard::AddTimeToLeaderBoard(const Player& player,
-                                       std::string mode,
-                                       std::string difficulty) {
+void SqliteLeaderBoard::AddTimeToLeaderBoard(const Player& player,
+                                             std::string mode,
+                                             std::string difficulty) {
+  // The time, the player's record and a new player's profile are written
+  // together, rather than each waiting for the disk on its own
+  const bool is_new_player = FindPlayerId(player.name) == 0;
   try {
-    db_ << "insert into leaderboard (name, time, mode, difficulty) "
-           "values (?,?,?,?);"
-        << player.name
-        << player.time
-        << mode
-        << difficulty;
+    db_ << "savepoint add_time;";
+
+    const int64_t player_id = GetPlayerId(player.name);
+    if (player_id != 0) {
+      db_ << "insert into leaderboard "
+             "  (player_id, time, mode, difficulty, submitted_at) "
+             "values (?,?,?,?,?);"
+          << player_id
+          << player.time
+          << mode
+          << difficulty
+          << player.submitted_at;
+      UpdatePlayerStats(player_id, player.time, mode, difficulty);
+      if (player.submitted_at != 0) {
+        UpdateWindowBestTimes(player_id, player.time, player.submitted_at,
+                              mode, difficulty);
+      }
+    }
+
+    db_ << "release add_time;";
   } catch (const sqlite::sqlite_exception& e) {
-    std::cerr  << e.get_code() << ": " << e.what() << " during "
-               << e.get_sql() << std::endl;
+    PrintError(e);
+    if (is_new_player) {
+      // Don't hand out the id of a profile that's being rolled back
+      player_names_.erase(player_ids_[player.name]);
+      player_ids_.erase(player.name);
+    }
+
+    try {
+      db_ << "rollback to add_time;";
+      db_ << "release add_time;";
+    } catch (const sqlite::sqlite_exception& rollback_error) {
+      PrintError(rollback_error);
+    }
   }
 }
 
-vector<Player> GetPlayers(sqlite::database_binder* rows) {
-  vector<Player> players;
-
+vector<Player> SqliteLeaderBoard::GetPlayers(sqlite::database_binder* rows) {
+  vector<std::tuple<int64_t, size_t, int64_t>> times;
   for (auto&& row : *rows) {
-    string name;
+    int64_t player_id;
     size_t time;
-    row >> name >> time;
-    Player player = {name, time};
-    players.push_back(player);
+    int64_t submitted_at;
+    row >> player_id >> time >> submitted_at;
+    times.emplace_back(player_id, time, submitted_at);
+  }
+
+  // Names are looked up after the rows are read, since that's another
+  // query on the same connection
+  vector<Player> players;
+  players.reserve(times.size());
+  for (const auto& time : times) {
+    players.emplace_back(FindPlayerName(std::get<0>(time)), std::get<1>(time),
+                         std::get<2>(time));
   }
 
   return players;
 }
 
-vector<Player> LeaderBoard::RetrieveBestTimes(const size_t limit,
-                                              std::string mode,
-                                              std::string difficulty) {
+vector<Player> SqliteLeaderBoard::RetrieveBestTimes(const size_t limit,
+                                                    std::string mode,
+                                                    std::string difficulty) {
   try {
-    auto rows = db_ << "select name,time from leaderboard "
+    auto rows = db_ << "select player_id, time, submitted_at from leaderboard "
                        "where mode = ? and difficulty = ? "
                        "order by time asc "
                        "limit ?;"
@@ -72,11 +354,424 @@ vector<Player> LeaderBoard::RetrieveBestTimes(const size_t limit,
                     << limit;
     return GetPlayers(&rows);
   } catch (const sqlite::sqlite_exception& e) {
-    std::cerr << e.get_code() << ": " << e.what() << " during " << e.get_sql()
-              << std::endl;
+    PrintError(e);
   }
 
   vector<Player> rows;
   return rows;
 }
+
+vector<Player> SqliteLeaderBoard::RetrieveWindowBestTimes(
+    LeaderBoardWindow window, const size_t limit, std::string mode,
+    std::string difficulty) {
+  if (window == LeaderBoardWindow::kAllTime) {
+    return RetrieveBestTimes(limit, mode, difficulty);
+  }
+
+  try {
+    // Rows of windows that have passed may still be there, if nothing's
+    // been submitted since, so only the current one is asked for
+    auto rows = db_ << "select player_id, time, submitted_at "
+                       "from window_best "
+                       "where window_kind = ? and mode = ? "
+                       "and difficulty = ? and window_start = ? "
+                       "order by time asc "
+                       "limit ?;"
+                    << static_cast<int>(window)
+                    << mode
+                    << difficulty
+                    << GetWindowStart(window, GetUnixTime())
+                    << limit;
+    return GetPlayers(&rows);
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return {};
+}
+
+size_t SqliteLeaderBoard::RetrieveRank(size_t time,
+                                       std::string mode,
+                                       std::string difficulty) {
+  size_t faster = 0;
+  try {
+    db_ << "select count(*) from leaderboard "
+           "where mode = ? and difficulty = ? and time <= ?;"
+        << mode
+        << difficulty
+        << time
+        >> faster;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return faster + 1;
+}
+
+void SqliteLeaderBoard::BeginBatch() {
+  try {
+    db_ << "begin;";
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+}
+
+bool SqliteLeaderBoard::EndBatch() {
+  try {
+    db_ << "commit;";
+    return true;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  // Profiles added and windows rolled over during the batch weren't saved
+  player_ids_.clear();
+  player_names_.clear();
+  window_starts_.clear();
+
+  // A commit that failed, e.g. on a busy database, leaves the transaction
+  // open
+  RollBackOpenTransaction();
+
+  return false;
+}
+
+void SqliteLeaderBoard::RollBackOpenTransaction() {
+  try {
+    if (sqlite3_get_autocommit(db_.connection().get()) == 0) {
+      db_ << "rollback;";
+    }
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+}
+
+vector<Player> SqliteLeaderBoard::RetrievePlayerBestTimes(
+    const string& name, const size_t limit, std::string mode,
+    std::string difficulty) {
+  const int64_t player_id = FindPlayerId(name);
+  if (player_id == 0) {
+    return {};
+  }
+
+  try {
+    auto rows = db_ << "select player_id, time, submitted_at from leaderboard "
+                       "where player_id = ? and mode = ? and difficulty = ? "
+                       "order by time asc "
+                       "limit ?;"
+                    << player_id
+                    << mode
+                    << difficulty
+                    << limit;
+    return GetPlayers(&rows);
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return {};
+}
+
+vector<Player> SqliteLeaderBoard::RetrievePlayerRecentTimes(
+    const string& name, const size_t limit, std::string mode,
+    std::string difficulty) {
+  const int64_t player_id = FindPlayerId(name);
+  if (player_id == 0) {
+    return {};
+  }
+
+  try {
+    // Rows are only ever added, so later ones have higher row ids
+    auto rows = db_ << "select player_id, time, submitted_at from leaderboard "
+                       "where player_id = ? and mode = ? and difficulty = ? "
+                       "order by rowid desc "
+                       "limit ?;"
+                    << player_id
+                    << mode
+                    << difficulty
+                    << limit;
+    return GetPlayers(&rows);
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return {};
+}
+
+PlayerStats SqliteLeaderBoard::RetrievePlayerStats(const string& name,
+                                                   std::string mode,
+                                                   std::string difficulty) {
+  PlayerStats stats;
+  const int64_t player_id = FindPlayerId(name);
+  if (player_id == 0) {
+    return stats;
+  }
+
+  try {
+    db_ << "select games, best_time, total_time, recent_median_time "
+           "from player_stats "
+           "where player_id = ? and mode = ? and difficulty = ?;"
+        << player_id
+        << mode
+        << difficulty
+        >> [&stats](size_t games, size_t best_time, size_t total_time,
+                    size_t recent_median_time) {
+          stats.games_played = games;
+          stats.best_time = best_time;
+          stats.mean_time = games == 0 ? 0 : total_time / games;
+          stats.recent_median_time = recent_median_time;
+        };
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return stats;
+}
+
+bool SqliteLeaderBoard::HasTime(const Player& player, const string& mode,
+                                const string& difficulty) {
+  const int64_t player_id = FindPlayerId(player.name);
+  if (player_id == 0) {
+    return false;
+  }
+
+  try {
+    int count = 0;
+    db_ << "select count(*) from leaderboard "
+           "where player_id = ? and mode = ? and difficulty = ? "
+           "  and time = ? and submitted_at = ?;"
+        << player_id
+        << mode
+        << difficulty
+        << player.time
+        << player.submitted_at
+        >> count;
+    return count > 0;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return false;
+}
+
+void SqliteLeaderBoard::CancelBatch() {
+  // Profiles added and windows rolled over during the batch are about to go
+  player_ids_.clear();
+  player_names_.clear();
+  window_starts_.clear();
+
+  try {
+    db_ << "rollback;";
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+}
+
+bool SqliteLeaderBoard::ForEachTime(const TimeVisitor& visit) {
+  try {
+    db_ << "select players.name, time, submitted_at, mode, difficulty "
+           "from leaderboard join players on players.id = player_id "
+           "order by leaderboard.rowid;"
+        >> [&visit](string name, size_t time, int64_t submitted_at,
+                    string mode, string difficulty) {
+          visit(Player(name, time, submitted_at), mode, difficulty);
+        };
+    return true;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return false;
+}
+
+int64_t SqliteLeaderBoard::GetPlayerId(const string& name) {
+  const int64_t player_id = FindPlayerId(name);
+  if (player_id != 0) {
+    return player_id;
+  }
+
+  try {
+    db_ << "insert into players (name) values (?);" << name;
+    const int64_t added_id = db_.last_insert_rowid();
+    CachePlayer(name, added_id);
+    return added_id;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return 0;
+}
+
+string SqliteLeaderBoard::GetPlayerName(const int64_t id) {
+  return FindPlayerName(id);
+}
+
+PlayerName SqliteLeaderBoard::FindPlayerName(const int64_t id) {
+  auto cached = player_names_.find(id);
+  if (cached != player_names_.end()) {
+    return cached->second;
+  }
+
+  try {
+    string name;
+    bool is_found = false;
+    db_ << "select name from players where id = ?;" << id
+        >> [&name, &is_found](string row_name) {
+          name = row_name;
+          is_found = true;
+        };
+    if (is_found) {
+      CachePlayer(name, id);
+      return player_names_.at(id);
+    }
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return "";
+}
+
+void SqliteLeaderBoard::CachePlayer(const string& name, int64_t id) {
+  if (player_ids_.size() >= kMaxCachedPlayers) {
+    player_ids_.clear();
+    player_names_.clear();
+  }
+
+  player_ids_[name] = id;
+  player_names_.emplace(id, name);
+}
+
+int64_t SqliteLeaderBoard::GetCopiedRowId(const string& source) {
+  int64_t rowid = 0;
+  try {
+    db_ << "select last_rowid from copied_rows where source = ?;" << source
+        >> [&rowid](int64_t row_rowid) { rowid = row_rowid; };
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return rowid;
+}
+
+void SqliteLeaderBoard::SetCopiedRowId(const string& source, int64_t rowid) {
+  try {
+    db_ << "insert or replace into copied_rows values (?,?);"
+        << source
+        << rowid;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+}
+
+int64_t SqliteLeaderBoard::FindPlayerId(const string& name) {
+  auto cached = player_ids_.find(name);
+  if (cached != player_ids_.end()) {
+    return cached->second;
+  }
+
+  try {
+    int64_t player_id = 0;
+    db_ << "select id from players where name = ?;" << name
+        >> [&player_id](int64_t row_id) { player_id = row_id; };
+    if (player_id != 0) {
+      CachePlayer(name, player_id);
+    }
+    return player_id;
+  } catch (const sqlite::sqlite_exception& e) {
+    PrintError(e);
+  }
+
+  return 0;
+}
+
+void SqliteLeaderBoard::UpdatePlayerStats(int64_t player_id, size_t time,
+                                          const string& mode,
+                                          const string& difficulty) {
+  StatsRow stats;
+  db_ << "select games, best_time, total_time, recent_times "
+         "from player_stats "
+         "where player_id = ? and mode = ? and difficulty = ?;"
+      << player_id
+      << mode
+      << difficulty
+      >> [&stats](size_t games, size_t best_time, size_t total_time,
+                  string recent_times) {
+        stats.games = games;
+        stats.best_time = best_time;
+        stats.total_time = total_time;
+        stats.recent_times = SplitTimes(recent_times);
+      };
+
+  AddToStats(&stats, time);
+  PutStatsRow(&db_, player_id, mode, difficulty, stats);
+}
+
+void SqliteLeaderBoard::UpdateWindowBestTimes(int64_t player_id, size_t time,
+                                              int64_t submitted_at,
+                                              const string& mode,
+                                              const string& difficulty) {
+  for (auto window : {LeaderBoardWindow::kDaily, LeaderBoardWindow::kWeekly}) {
+    const int kind = static_cast<int>(window);
+    const int64_t start = GetWindowStart(window, submitted_at);
+
+    auto latest = window_starts_.find(std::make_tuple(kind, mode, difficulty));
+    if (latest != window_starts_.end() && start < latest->second) {
+      // Too late for a window that's already over
+      continue;
+    }
+    if (latest == window_starts_.end() || start > latest->second) {
+      // A new window has begun, so the times of the last one can go
+      db_ << "delete from window_best "
+             "where window_kind = ? and mode = ? and difficulty = ? "
+             "and window_start < ?;"
+          << kind
+          << mode
+          << difficulty
+          << start;
+      window_starts_[std::make_tuple(kind, mode, difficulty)] = start;
+    }
+
+    // Once the window is full, a time has to beat its slowest to get in
+    bool is_full = false;
+    size_t slowest_time = 0;
+    db_ << "select time from window_best "
+           "where window_kind = ? and mode = ? and difficulty = ? "
+           "and window_start = ? "
+           "order by time asc limit 1 offset ?;"
+        << kind
+        << mode
+        << difficulty
+        << start
+        << kWindowBestTimes - 1
+        >> [&is_full, &slowest_time](size_t row_time) {
+          is_full = true;
+          slowest_time = row_time;
+        };
+    if (is_full && time >= slowest_time) {
+      continue;
+    }
+
+    db_ << "insert into window_best values (?,?,?,?,?,?,?);"
+        << kind
+        << start
+        << player_id
+        << time
+        << submitted_at
+        << mode
+        << difficulty;
+
+    if (is_full) {
+      // Ties go to the time that was there first
+      db_ << "delete from window_best where rowid = ("
+             "  select rowid from window_best "
+             "  where window_kind = ? and mode = ? and difficulty = ? "
+             "  and window_start = ? "
+             "  order by time desc, rowid desc limit 1);"
+          << kind
+          << mode
+          << difficulty
+          << start;
+    }
+  }
+}
+
 }  // namespace sudoku
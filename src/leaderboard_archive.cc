@@ -0,0 +1,357 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/leaderboard_archive.h>
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+const char kArchiveMagic[] = "SDKA";
+constexpr size_t kMagicSize = 4;
+// Version 2 added when each time was submitted. Version 1 archives can
+// still be read, with none of their times dated
+constexpr uint32_t kArchiveVersion = 2;
+constexpr size_t kBlockHeaderSize = 12;
+
+// Blocks bigger than this are treated as garbage, rather than read into
+// memory. A full block of 1000-character names still fits
+constexpr uint64_t kMaxBlockSize = 64 * 1024 * 1024;
+
+uint32_t Checksum(const std::string& data) {
+  uint32_t hash = 2166136261u;
+  for (char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void PutFixed(std::string* out, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; i++) {
+    out->push_back(static_cast<char>(value >> (8 * i) & 0xFF));
+  }
+}
+
+void PutVarint(std::string* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutString(std::string* out, const std::string& text) {
+  PutVarint(out, text.size());
+  out->append(text);
+}
+
+uint64_t GetFixed(const char* data, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < bytes; i++) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+  }
+
+  return value;
+}
+
+// Reads varints and strings from a block's body, remembering if it ran
+// past the end
+class BodyReader {
+ public:
+  explicit BodyReader(const std::string& data)
+      : data_(data), pos_(0), failed_(false) {}
+
+  uint64_t Varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) {
+        break;
+      }
+
+      const auto byte = static_cast<uint8_t>(data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+
+    failed_ = true;
+    return 0;
+  }
+
+  std::string String() {
+    const uint64_t length = Varint();
+    if (failed_ || length > data_.size() - pos_) {
+      failed_ = true;
+      return "";
+    }
+
+    pos_ += static_cast<size_t>(length);
+    return data_.substr(pos_ - static_cast<size_t>(length),
+                        static_cast<size_t>(length));
+  }
+
+  bool Failed() const { return failed_; }
+  bool IsDone() const { return !failed_ && pos_ == data_.size(); }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+  bool failed_;
+};
+
+}  // namespace
+
+LeaderBoardArchiveWriter::LeaderBoardArchiveWriter(std::ostream* out)
+    : out_{out} {
+  out_->write(kArchiveMagic, kMagicSize);
+  std::string version;
+  PutFixed(&version, kArchiveVersion, 2);
+  out_->write(version.data(), static_cast<std::streamsize>(version.size()));
+  block_.reserve(kArchiveBlockTimes);
+}
+
+void LeaderBoardArchiveWriter::Add(const Player& player,
+                                   const std::string& mode,
+                                   const std::string& difficulty) {
+  block_.push_back({player, mode, difficulty});
+  if (block_.size() == kArchiveBlockTimes) {
+    WriteBlock();
+  }
+}
+
+bool LeaderBoardArchiveWriter::Finish() {
+  if (!block_.empty()) {
+    WriteBlock();
+  }
+
+  std::string end;
+  PutFixed(&end, 0, kBlockHeaderSize);
+  out_->write(end.data(), static_cast<std::streamsize>(end.size()));
+  out_->flush();
+  return static_cast<bool>(*out_);
+}
+
+void LeaderBoardArchiveWriter::WriteBlock() {
+  // Every string gets an index in the order it first appears
+  std::unordered_map<std::string, uint64_t> indexes;
+  std::vector<const std::string*> strings;
+  auto get_index = [&indexes, &strings](const std::string& text) {
+    auto inserted = indexes.emplace(text, strings.size());
+    if (inserted.second) {
+      strings.push_back(&inserted.first->first);
+    }
+    return inserted.first->second;
+  };
+
+  std::string columns;
+  for (const ArchivedTime& time : block_) {
+    PutVarint(&columns, get_index(time.mode));
+  }
+  for (const ArchivedTime& time : block_) {
+    PutVarint(&columns, get_index(time.difficulty));
+  }
+  for (const ArchivedTime& time : block_) {
+    PutVarint(&columns, get_index(time.player.name));
+  }
+  for (const ArchivedTime& time : block_) {
+    PutVarint(&columns, time.player.time);
+  }
+  for (const ArchivedTime& time : block_) {
+    PutVarint(&columns, static_cast<uint64_t>(time.player.submitted_at));
+  }
+
+  std::string body;
+  PutVarint(&body, strings.size());
+  for (const std::string* text : strings) {
+    PutString(&body, *text);
+  }
+  body += columns;
+
+  std::string header;
+  PutFixed(&header, block_.size(), 4);
+  PutFixed(&header, body.size(), 4);
+  PutFixed(&header, Checksum(body), 4);
+  out_->write(header.data(), static_cast<std::streamsize>(header.size()));
+  out_->write(body.data(), static_cast<std::streamsize>(body.size()));
+
+  block_.clear();
+}
+
+LeaderBoardArchiveReader::LeaderBoardArchiveReader(std::istream* in)
+    : in_{in}, version_{0}, next_{0}, is_done_{false}, has_failed_{false} {
+  char header[kMagicSize + 2];
+  if (in_->read(header, sizeof(header))
+      && std::string(header, kMagicSize) == kArchiveMagic) {
+    version_ = static_cast<uint32_t>(GetFixed(header + kMagicSize, 2));
+  }
+
+  if (version_ < 1 || version_ > kArchiveVersion) {
+    is_done_ = true;
+    has_failed_ = true;
+  }
+}
+
+bool LeaderBoardArchiveReader::Next(ArchivedTime* time) {
+  while (next_ == block_.size()) {
+    if (is_done_ || !ReadBlock()) {
+      return false;
+    }
+  }
+
+  *time = std::move(block_[next_++]);
+  return true;
+}
+
+bool LeaderBoardArchiveReader::HasFailed() const {
+  return has_failed_;
+}
+
+bool LeaderBoardArchiveReader::ReadBlock() {
+  block_.clear();
+  next_ = 0;
+
+  char header[kBlockHeaderSize];
+  if (!in_->read(header, sizeof(header))) {
+    // Archives always end with an empty block, so this one was cut short
+    is_done_ = true;
+    has_failed_ = true;
+    return false;
+  }
+
+  const uint64_t count = GetFixed(header, 4);
+  const uint64_t length = GetFixed(header + 4, 4);
+  const auto checksum = static_cast<uint32_t>(GetFixed(header + 8, 4));
+  if (count == 0) {
+    is_done_ = true;
+    return false;
+  }
+
+  std::string body;
+  if (count > kArchiveBlockTimes || length > kMaxBlockSize) {
+    has_failed_ = true;
+  } else {
+    body.resize(static_cast<size_t>(length));
+    has_failed_ = !in_->read(&body[0], static_cast<std::streamsize>(length))
+                  || Checksum(body) != checksum;
+  }
+  if (has_failed_) {
+    is_done_ = true;
+    return false;
+  }
+
+  BodyReader reader(body);
+  const uint64_t num_strings = reader.Varint();
+  std::vector<std::string> strings;
+  for (uint64_t i = 0; i < num_strings && !reader.Failed(); i++) {
+    strings.push_back(reader.String());
+  }
+
+  // Each string column points into the strings read above
+  auto read_strings = [&reader, &strings, count](
+      std::vector<const std::string*>* column) {
+    for (uint64_t i = 0; i < count; i++) {
+      const uint64_t index = reader.Varint();
+      if (reader.Failed() || index >= strings.size()) {
+        return false;
+      }
+      column->push_back(&strings[static_cast<size_t>(index)]);
+    }
+    return true;
+  };
+
+  std::vector<const std::string*> modes;
+  std::vector<const std::string*> difficulties;
+  std::vector<const std::string*> names;
+  if (!read_strings(&modes) || !read_strings(&difficulties)
+      || !read_strings(&names)) {
+    has_failed_ = true;
+  }
+
+  for (uint64_t i = 0; i < count && !has_failed_; i++) {
+    const auto time = static_cast<size_t>(reader.Varint());
+    block_.push_back({Player(*names[i], time), *modes[i], *difficulties[i]});
+  }
+  for (size_t i = 0; i < block_.size() && version_ >= 2; i++) {
+    block_[i].player.submitted_at = static_cast<int64_t>(reader.Varint());
+  }
+
+  if (has_failed_ || !reader.IsDone()) {
+    has_failed_ = true;
+    is_done_ = true;
+    block_.clear();
+    return false;
+  }
+
+  return true;
+}
+
+size_t ExportLeaderBoard(LeaderBoard* leaderboard, std::ostream* out) {
+  LeaderBoardArchiveWriter writer(out);
+  size_t num_times = 0;
+  const bool is_listed = leaderboard->ForEachTime(
+      [&writer, &num_times](const Player& player, const std::string& mode,
+                            const std::string& difficulty) {
+        writer.Add(player, mode, difficulty);
+        num_times++;
+      });
+
+  if (!is_listed) {
+    std::cerr << "This leaderboard's times can't be exported" << std::endl;
+    return 0;
+  }
+  if (!writer.Finish()) {
+    std::cerr << "Couldn't write the leaderboard archive" << std::endl;
+    return 0;
+  }
+
+  return num_times;
+}
+
+size_t ImportLeaderBoard(std::istream* in, LeaderBoard* leaderboard,
+                         size_t* num_skipped) {
+  LeaderBoardArchiveReader reader(in);
+  size_t num_times = 0;
+  size_t num_existing = 0;
+
+  leaderboard->BeginBatch();
+  ArchivedTime time{Player("", 0), "", ""};
+  while (reader.Next(&time)) {
+    if (leaderboard->HasTime(time.player, time.mode, time.difficulty)) {
+      num_existing++;
+      continue;
+    }
+
+    leaderboard->AddTimeToLeaderBoard(time.player, time.mode,
+                                      time.difficulty);
+    num_times++;
+  }
+  if (num_skipped != nullptr) {
+    *num_skipped = num_existing;
+  }
+
+  if (reader.HasFailed()) {
+    leaderboard->CancelBatch();
+    std::cerr << "Leaderboard archive is corrupt after " << num_times
+              << " times, not importing it" << std::endl;
+    return 0;
+  }
+
+  if (!leaderboard->EndBatch()) {
+    std::cerr << "Couldn't save the imported times. Importing the archive "
+                 "again adds whatever is missing"
+              << std::endl;
+    return 0;
+  }
+
+  return num_times;
+}
+
+}  // namespace sudoku
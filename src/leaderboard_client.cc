@@ -0,0 +1,300 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/leaderboard_client.h>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+#if !defined(_WIN32) && defined(MSG_NOSIGNAL)
+// A server that went away shouldn't kill the app with SIGPIPE
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+void PrintError(const std::string& what) {
+  std::cerr << "leaderboard client: " << what << ": " << std::strerror(errno)
+            << std::endl;
+}
+
+}  // namespace
+
+LeaderBoardClient::LeaderBoardClient(const LeaderBoardAddress& address,
+                                     std::chrono::milliseconds timeout)
+    : address_{address}, timeout_{timeout}, fd_{-1} {
+  Connect();
+}
+
+LeaderBoardClient::~LeaderBoardClient() {
+  Disconnect();
+}
+
+void LeaderBoardClient::AddTimeToLeaderBoard(const Player& player,
+                                             std::string mode,
+                                             std::string difficulty) {
+  LeaderBoardRequest request;
+  request.op = LeaderBoardOp::kAddTime;
+  request.mode = mode;
+  request.difficulty = difficulty;
+  request.name = player.name;
+  request.time = player.time;
+  request.limit = 0;
+
+  std::vector<LeaderBoardResponse> responses;
+  if (SendPipelined({request}, &responses) && !responses[0].ok) {
+    std::cerr << "leaderboard client: the server refused the time for "
+              << player.name << std::endl;
+  }
+}
+
+std::vector<Player> LeaderBoardClient::RetrieveBestTimes(
+    const size_t limit, std::string mode, std::string difficulty) {
+  LeaderBoardRequest request;
+  request.op = LeaderBoardOp::kBestTimes;
+  request.mode = mode;
+  request.difficulty = difficulty;
+  request.time = 0;
+  request.limit = static_cast<uint32_t>(limit);
+
+  std::vector<LeaderBoardResponse> responses;
+  if (!SendPipelined({request}, &responses)) {
+    return {};
+  }
+
+  return responses[0].players;
+}
+
+std::vector<Player> LeaderBoardClient::RetrieveWindowBestTimes(
+    LeaderBoardWindow window, const size_t limit, std::string mode,
+    std::string difficulty) {
+  LeaderBoardRequest request;
+  request.op = LeaderBoardOp::kWindowBestTimes;
+  request.mode = mode;
+  request.difficulty = difficulty;
+  request.time = 0;
+  request.limit = static_cast<uint32_t>(limit);
+  request.window = window;
+
+  std::vector<LeaderBoardResponse> responses;
+  if (!SendPipelined({request}, &responses)) {
+    return {};
+  }
+
+  return responses[0].players;
+}
+
+size_t LeaderBoardClient::RetrieveRank(size_t time,
+                                       std::string mode,
+                                       std::string difficulty) {
+  LeaderBoardRequest request;
+  request.op = LeaderBoardOp::kRank;
+  request.mode = mode;
+  request.difficulty = difficulty;
+  request.time = time;
+  request.limit = 0;
+
+  std::vector<LeaderBoardResponse> responses;
+  if (!SendPipelined({request}, &responses)) {
+    return 1;
+  }
+
+  return static_cast<size_t>(responses[0].rank);
+}
+
+PlayerStats LeaderBoardClient::RetrievePlayerStats(const std::string& name,
+                                                   std::string mode,
+                                                   std::string difficulty) {
+  LeaderBoardRequest request;
+  request.op = LeaderBoardOp::kPlayerStats;
+  request.mode = mode;
+  request.difficulty = difficulty;
+  request.name = name;
+  request.time = 0;
+  request.limit = 0;
+
+  std::vector<LeaderBoardResponse> responses;
+  if (!SendPipelined({request}, &responses)) {
+    return {};
+  }
+
+  return responses[0].stats;
+}
+
+#ifndef _WIN32
+
+bool LeaderBoardClient::SendPipelined(
+    const std::vector<LeaderBoardRequest>& requests,
+    std::vector<LeaderBoardResponse>* responses) {
+  responses->clear();
+  if (!IsConnected() && !Connect()) {
+    return false;
+  }
+
+  output_.clear();
+  for (const auto& request : requests) {
+    EncodeRequest(request, &output_);
+  }
+
+  size_t sent = 0;
+  while (sent < output_.size()) {
+    const ssize_t count = send(fd_, output_.data() + sent,
+                               output_.size() - sent, kSendFlags);
+    if (count == -1 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      PrintError("send");
+      Disconnect();
+      return false;
+    }
+    sent += static_cast<size_t>(count);
+  }
+
+  // Read until every response is in
+  size_t pos = 0;
+  LeaderBoardResponse response;
+  while (responses->size() < requests.size()) {
+    const FrameStatus status = DecodeResponse(input_, &pos, &response);
+    if (status == FrameStatus::kComplete
+        && response.op == requests[responses->size()].op) {
+      responses->push_back(response);
+      continue;
+    }
+    if (status != FrameStatus::kIncomplete) {
+      std::cerr << "leaderboard client: bad response from server"
+                << std::endl;
+      Disconnect();
+      responses->clear();
+      return false;
+    }
+
+    char buffer[16 * 1024];
+    const ssize_t count = recv(fd_, buffer, sizeof(buffer), 0);
+    if (count == -1 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      if (count == 0) {
+        std::cerr << "leaderboard client: server closed the connection"
+                  << std::endl;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        std::cerr << "leaderboard client: server didn't answer in time"
+                  << std::endl;
+      } else {
+        PrintError("recv");
+      }
+      Disconnect();
+      responses->clear();
+      return false;
+    }
+    input_.append(buffer, static_cast<size_t>(count));
+  }
+  input_.erase(0, pos);
+
+  return true;
+}
+
+bool LeaderBoardClient::Connect() {
+  if (address_.is_unix) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (address_.path.size() >= sizeof(addr.sun_path)) {
+      std::cerr << "leaderboard client: socket path is too long" << std::endl;
+      return false;
+    }
+    std::strcpy(addr.sun_path, address_.path.c_str());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ == -1 || connect(fd_, reinterpret_cast<sockaddr*>(&addr),
+                             sizeof(addr)) == -1) {
+      PrintError("connect " + address_.path);
+      Disconnect();
+      return false;
+    }
+  } else {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(address_.port);
+    if (inet_pton(AF_INET, address_.host.c_str(), &addr.sin_addr) != 1) {
+      std::cerr << "leaderboard client: bad host " << address_.host
+                << std::endl;
+      return false;
+    }
+
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ == -1 || connect(fd_, reinterpret_cast<sockaddr*>(&addr),
+                             sizeof(addr)) == -1) {
+      PrintError("connect " + address_.host);
+      Disconnect();
+      return false;
+    }
+
+    // Requests are sent whole, so don't hold them back waiting for more
+    const int no_delay = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+  }
+
+  // Don't hang the app on a server that's stopped answering
+  timeval timeout{};
+  timeout.tv_sec = static_cast<time_t>(timeout_.count() / 1000);
+  timeout.tv_usec = static_cast<suseconds_t>(timeout_.count() % 1000 * 1000);
+  setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+#ifdef SO_NOSIGPIPE
+  const int no_sigpipe = 1;
+  setsockopt(fd_, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+  return true;
+}
+
+void LeaderBoardClient::Disconnect() {
+  if (fd_ != -1) {
+    close(fd_);
+    fd_ = -1;
+  }
+  input_.clear();
+}
+
+#else
+
+// Sockets here are POSIX only, so there's never a server to talk to
+bool LeaderBoardClient::SendPipelined(
+    const std::vector<LeaderBoardRequest>&,
+    std::vector<LeaderBoardResponse>* responses) {
+  responses->clear();
+  return false;
+}
+
+bool LeaderBoardClient::Connect() {
+  std::cerr << "leaderboard client: not supported on Windows" << std::endl;
+  return false;
+}
+
+void LeaderBoardClient::Disconnect() {}
+
+#endif  // _WIN32
+
+bool LeaderBoardClient::IsConnected() const {
+  return fd_ != -1;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,351 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/leaderboard_protocol.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace sudoku {
+
+namespace {
+
+constexpr size_t kFrameHeaderSize = 4;
+
+void PutByte(std::string* out, uint64_t value) {
+  out->push_back(static_cast<char>(value & 0xFF));
+}
+
+void PutU16(std::string* out, uint64_t value) {
+  PutByte(out, value);
+  PutByte(out, value >> 8);
+}
+
+void PutU32(std::string* out, uint64_t value) {
+  PutU16(out, value);
+  PutU16(out, value >> 16);
+}
+
+void PutU64(std::string* out, uint64_t value) {
+  PutU32(out, value);
+  PutU32(out, value >> 32);
+}
+
+// Strings longer than a u16 can say are cut short
+void PutString(std::string* out, const std::string& text) {
+  const size_t length = text.size() < 0xFFFF ? text.size() : 0xFFFF;
+  PutU16(out, length);
+  out->append(text, 0, length);
+}
+
+// Reserve room for the frame's length, to be filled in by EndFrame
+size_t BeginFrame(std::string* out) {
+  const size_t start = out->size();
+  PutU32(out, 0);
+  return start;
+}
+
+void EndFrame(std::string* out, size_t start) {
+  const size_t length = out->size() - start - kFrameHeaderSize;
+  for (size_t i = 0; i < kFrameHeaderSize; i++) {
+    (*out)[start + i] = static_cast<char>(length >> (8 * i) & 0xFF);
+  }
+}
+
+// Reads the body of one frame, remembering if it ran past the end
+class FrameReader {
+ public:
+  FrameReader(const std::string& data, size_t pos, size_t end)
+      : data_(data), pos_(pos), end_(end), failed_(false) {}
+
+  uint64_t Byte() {
+    if (pos_ >= end_) {
+      failed_ = true;
+      return 0;
+    }
+
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint64_t U16() {
+    uint64_t low = Byte();
+    return low | Byte() << 8;
+  }
+
+  uint64_t U32() {
+    uint64_t low = U16();
+    return low | U16() << 16;
+  }
+
+  uint64_t U64() {
+    uint64_t low = U32();
+    return low | U32() << 32;
+  }
+
+  std::string String() {
+    const auto length = static_cast<size_t>(U16());
+    if (failed_ || length > end_ - pos_) {
+      failed_ = true;
+      return "";
+    }
+
+    pos_ += length;
+    return data_.substr(pos_ - length, length);
+  }
+
+  bool Failed() const { return failed_; }
+
+  // True if the body was read exactly, with nothing left over
+  bool IsDone() const { return !failed_ && pos_ == end_; }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+  size_t end_;
+  bool failed_;
+};
+
+// Find the body of the frame at `pos`. On success, [*body, *end) is the body
+FrameStatus FindFrame(const std::string& data, size_t pos, size_t* body,
+                      size_t* end) {
+  if (data.size() - pos < kFrameHeaderSize) {
+    return FrameStatus::kIncomplete;
+  }
+
+  size_t length = 0;
+  for (size_t i = 0; i < kFrameHeaderSize; i++) {
+    length |= static_cast<size_t>(static_cast<uint8_t>(data[pos + i]))
+              << (8 * i);
+  }
+
+  if (length > kMaxLeaderBoardFrame) {
+    return FrameStatus::kMalformed;
+  }
+  if (data.size() - pos - kFrameHeaderSize < length) {
+    return FrameStatus::kIncomplete;
+  }
+
+  *body = pos + kFrameHeaderSize;
+  *end = *body + length;
+  return FrameStatus::kComplete;
+}
+
+bool IsOp(uint64_t op) {
+  return op >= static_cast<uint64_t>(LeaderBoardOp::kAddTime)
+         && op <= static_cast<uint64_t>(LeaderBoardOp::kWindowBestTimes);
+}
+
+}  // namespace
+
+void EncodeRequest(const LeaderBoardRequest& request, std::string* out) {
+  const size_t start = BeginFrame(out);
+  PutByte(out, static_cast<uint64_t>(request.op));
+  PutString(out, request.mode);
+  PutString(out, request.difficulty);
+
+  switch (request.op) {
+    case LeaderBoardOp::kAddTime :
+      PutString(out, request.name);
+      PutU64(out, request.time);
+      break;
+    case LeaderBoardOp::kBestTimes :
+      PutU32(out, request.limit);
+      break;
+    case LeaderBoardOp::kRank :
+      PutU64(out, request.time);
+      break;
+    case LeaderBoardOp::kPlayerStats :
+      PutString(out, request.name);
+      break;
+    case LeaderBoardOp::kWindowBestTimes :
+      PutByte(out, static_cast<uint64_t>(request.window));
+      PutU32(out, request.limit);
+      break;
+  }
+
+  EndFrame(out, start);
+}
+
+void EncodeResponse(const LeaderBoardResponse& response, std::string* out) {
+  const size_t start = BeginFrame(out);
+  PutByte(out, static_cast<uint64_t>(response.op));
+  PutByte(out, response.ok ? 1 : 0);
+
+  switch (response.op) {
+    case LeaderBoardOp::kAddTime :
+      break;
+    case LeaderBoardOp::kBestTimes :
+    case LeaderBoardOp::kWindowBestTimes : {
+      // Count the players that fit before writing any of them
+      size_t length = out->size() - start - kFrameHeaderSize + 4;
+      size_t count = 0;
+      for (const Player& player : response.players) {
+        length += 2 + std::min<size_t>(player.name.size(), 0xFFFF) + 8;
+        if (length > kMaxLeaderBoardFrame) {
+          break;
+        }
+        count++;
+      }
+
+      PutU32(out, count);
+      for (size_t i = 0; i < count; i++) {
+        PutString(out, response.players[i].name);
+        PutU64(out, response.players[i].time);
+      }
+      break;
+    }
+    case LeaderBoardOp::kRank :
+      PutU64(out, response.rank);
+      break;
+    case LeaderBoardOp::kPlayerStats :
+      PutU64(out, response.stats.games_played);
+      PutU64(out, response.stats.best_time);
+      PutU64(out, response.stats.mean_time);
+      PutU64(out, response.stats.recent_median_time);
+      break;
+  }
+
+  EndFrame(out, start);
+}
+
+FrameStatus DecodeRequest(const std::string& data, size_t* pos,
+                          LeaderBoardRequest* request) {
+  size_t body;
+  size_t end;
+  const FrameStatus status = FindFrame(data, *pos, &body, &end);
+  if (status != FrameStatus::kComplete) {
+    return status;
+  }
+
+  FrameReader reader(data, body, end);
+  const uint64_t op = reader.Byte();
+  if (!IsOp(op)) {
+    return FrameStatus::kMalformed;
+  }
+
+  request->op = static_cast<LeaderBoardOp>(op);
+  request->mode = reader.String();
+  request->difficulty = reader.String();
+  request->name.clear();
+  request->time = 0;
+  request->limit = 0;
+  request->window = LeaderBoardWindow::kAllTime;
+
+  switch (request->op) {
+    case LeaderBoardOp::kAddTime :
+      request->name = reader.String();
+      request->time = reader.U64();
+      break;
+    case LeaderBoardOp::kBestTimes :
+      request->limit = static_cast<uint32_t>(reader.U32());
+      break;
+    case LeaderBoardOp::kRank :
+      request->time = reader.U64();
+      break;
+    case LeaderBoardOp::kPlayerStats :
+      request->name = reader.String();
+      break;
+    case LeaderBoardOp::kWindowBestTimes : {
+      const uint64_t window = reader.Byte();
+      if (window > static_cast<uint64_t>(LeaderBoardWindow::kWeekly)) {
+        return FrameStatus::kMalformed;
+      }
+      request->window = static_cast<LeaderBoardWindow>(window);
+      request->limit = static_cast<uint32_t>(reader.U32());
+      break;
+    }
+  }
+
+  if (!reader.IsDone()) {
+    return FrameStatus::kMalformed;
+  }
+
+  *pos = end;
+  return FrameStatus::kComplete;
+}
+
+FrameStatus DecodeResponse(const std::string& data, size_t* pos,
+                           LeaderBoardResponse* response) {
+  size_t body;
+  size_t end;
+  const FrameStatus status = FindFrame(data, *pos, &body, &end);
+  if (status != FrameStatus::kComplete) {
+    return status;
+  }
+
+  FrameReader reader(data, body, end);
+  const uint64_t op = reader.Byte();
+  if (!IsOp(op)) {
+    return FrameStatus::kMalformed;
+  }
+
+  response->op = static_cast<LeaderBoardOp>(op);
+  response->ok = reader.Byte() == 1;
+  response->players.clear();
+  response->rank = 0;
+  response->stats = PlayerStats();
+
+  switch (response->op) {
+    case LeaderBoardOp::kAddTime :
+      break;
+    case LeaderBoardOp::kBestTimes :
+    case LeaderBoardOp::kWindowBestTimes : {
+      const uint64_t count = reader.U32();
+      for (uint64_t i = 0; i < count && !reader.Failed(); i++) {
+        std::string name = reader.String();
+        const uint64_t time = reader.U64();
+        response->players.emplace_back(name, static_cast<size_t>(time));
+      }
+      break;
+    }
+    case LeaderBoardOp::kRank :
+      response->rank = reader.U64();
+      break;
+    case LeaderBoardOp::kPlayerStats :
+      response->stats.games_played = static_cast<size_t>(reader.U64());
+      response->stats.best_time = static_cast<size_t>(reader.U64());
+      response->stats.mean_time = static_cast<size_t>(reader.U64());
+      response->stats.recent_median_time = static_cast<size_t>(reader.U64());
+      break;
+  }
+
+  if (!reader.IsDone()) {
+    return FrameStatus::kMalformed;
+  }
+
+  *pos = end;
+  return FrameStatus::kComplete;
+}
+
+bool ParseLeaderBoardAddress(const std::string& text,
+                             LeaderBoardAddress* address) {
+  const std::string unix_prefix = "unix:";
+  if (text.compare(0, unix_prefix.size(), unix_prefix) == 0) {
+    if (text.size() == unix_prefix.size()) {
+      return false;
+    }
+
+    address->is_unix = true;
+    address->path = text.substr(unix_prefix.size());
+    return true;
+  }
+
+  const size_t colon = text.rfind(':');
+  if (colon == std::string::npos || colon == 0 || colon + 1 == text.size()) {
+    return false;
+  }
+
+  const std::string port = text.substr(colon + 1);
+  char* end = nullptr;
+  const unsigned long value = std::strtoul(port.c_str(), &end, 10);
+  if (*end != '\0' || value > 0xFFFF) {
+    return false;
+  }
+
+  address->is_unix = false;
+  address->host = text.substr(0, colon);
+  address->port = static_cast<uint16_t>(value);
+  return true;
+}
+
+}  // namespace sudoku
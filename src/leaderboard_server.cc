@@ -0,0 +1,483 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/leaderboard_server.h>
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace sudoku {
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadSize = 64 * 1024;
+
+// How many best times a single request can ask for
+constexpr uint32_t kMaxLimit = 1000;
+
+// Requests and responses a client can have waiting before the server stops
+// reading from it
+constexpr size_t kMaxQueued = 1024 * 1024;
+
+bool SetNonBlocking(int fd) {
+  const int flags = fcntl(fd, F_GETFL, 0);
+  return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+void PrintError(const std::string& what) {
+  std::cerr << "leaderboard server: " << what << ": " << std::strerror(errno)
+            << std::endl;
+}
+
+}  // namespace
+
+LeaderBoardServer::LeaderBoardServer(LeaderBoard* leaderboard)
+    : leaderboard_{leaderboard},
+      listen_fd_{-1},
+      epoll_fd_{epoll_create1(EPOLL_CLOEXEC)},
+      wake_fd_{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+      port_{0},
+      request_count_{0} {
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = wake_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+LeaderBoardServer::~LeaderBoardServer() {
+  for (const auto& connection : connections_) {
+    close(connection.first);
+  }
+
+  if (listen_fd_ != -1) {
+    close(listen_fd_);
+  }
+  if (!unix_path_.empty()) {
+    unlink(unix_path_.c_str());
+  }
+
+  close(wake_fd_);
+  close(epoll_fd_);
+}
+
+bool LeaderBoardServer::Listen(const LeaderBoardAddress& address) {
+  if (address.is_unix) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (address.path.size() >= sizeof(addr.sun_path)) {
+      std::cerr << "leaderboard server: socket path is too long" << std::endl;
+      return false;
+    }
+    std::strcpy(addr.sun_path, address.path.c_str());
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ == -1) {
+      PrintError("socket");
+      return false;
+    }
+
+    // A socket file left behind by a server that didn't shut down cleanly.
+    // Anything else there, or a server still listening, is left alone
+    struct stat info;
+    if (lstat(address.path.c_str(), &info) == 0) {
+      if (!S_ISSOCK(info.st_mode)) {
+        std::cerr << "leaderboard server: " << address.path
+                  << " isn't a socket" << std::endl;
+        return false;
+      }
+
+      const int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      const bool is_live = probe != -1
+                           && connect(probe, reinterpret_cast<sockaddr*>(&addr),
+                                      sizeof(addr)) == 0;
+      if (probe != -1) {
+        close(probe);
+      }
+      if (is_live) {
+        std::cerr << "leaderboard server: another server is listening on "
+                  << address.path << std::endl;
+        return false;
+      }
+      unlink(address.path.c_str());
+    }
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+             sizeof(addr)) == -1) {
+      PrintError("bind " + address.path);
+      return false;
+    }
+    unix_path_ = address.path;
+  } else {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(address.port);
+    if (inet_pton(AF_INET, address.host.c_str(), &addr.sin_addr) != 1
+        || (ntohl(addr.sin_addr.s_addr) >> 24) != 127) {
+      std::cerr << "leaderboard server: " << address.host
+                << " isn't a loopback address" << std::endl;
+      return false;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ == -1) {
+      PrintError("socket");
+      return false;
+    }
+
+    const int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr),
+             sizeof(addr)) == -1) {
+      PrintError("bind " + address.host);
+      return false;
+    }
+
+    socklen_t length = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+    port_ = ntohs(addr.sin_port);
+  }
+
+  if (listen(listen_fd_, SOMAXCONN) == -1 || !SetNonBlocking(listen_fd_)) {
+    PrintError("listen");
+    return false;
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = listen_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event) == -1) {
+    PrintError("epoll_ctl");
+    return false;
+  }
+
+  return true;
+}
+
+uint16_t LeaderBoardServer::GetPort() const {
+  return port_;
+}
+
+void LeaderBoardServer::Run() {
+  epoll_event events[kMaxEvents];
+  bool is_stopping = false;
+
+  while (!is_stopping) {
+    const int count = epoll_wait(epoll_fd_, events, kMaxEvents,
+                                 backlogged_.empty() ? -1 : 0);
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      PrintError("epoll_wait");
+      return;
+    }
+
+    // Writes from every request in this pass go in together, and are done
+    // before any of them is answered
+    leaderboard_->BeginBatch();
+    std::vector<int> backlogged;
+    backlogged.swap(backlogged_);
+    for (int fd : backlogged) {
+      auto connection = connections_.find(fd);
+      if (connection != connections_.end()
+          && !HandleRequests(fd, &connection->second)) {
+        Close(fd);
+      }
+    }
+
+    for (int i = 0; i < count; i++) {
+      const int fd = events[i].data.fd;
+      if (fd == wake_fd_) {
+        is_stopping = true;
+        continue;
+      }
+      if (fd == listen_fd_) {
+        Accept();
+        continue;
+      }
+
+      auto connection = connections_.find(fd);
+      if (connection == connections_.end()) {
+        continue;
+      }
+
+      bool is_open = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0
+                     || (events[i].events & EPOLLIN) != 0;
+      if (is_open && (events[i].events & EPOLLIN) != 0) {
+        is_open = ReadRequests(fd, &connection->second);
+      }
+      if (!is_open) {
+        Close(fd);
+      } else if ((events[i].events & EPOLLOUT) != 0) {
+        // Written once this pass's writes are in, with its responses
+        pending_.push_back(fd);
+      }
+    }
+    if (!leaderboard_->EndBatch()) {
+      RefuseAddedTimes();
+    }
+    for (int fd : adding_) {
+      auto connection = connections_.find(fd);
+      if (connection != connections_.end()) {
+        connection->second.added_times.clear();
+      }
+    }
+    adding_.clear();
+
+    for (int fd : pending_) {
+      auto connection = connections_.find(fd);
+      if (connection != connections_.end()
+          && !WriteResponses(fd, &connection->second)) {
+        Close(fd);
+      }
+    }
+    pending_.clear();
+  }
+
+  uint64_t value;
+  while (read(wake_fd_, &value, sizeof(value)) > 0) {}
+}
+
+void LeaderBoardServer::Stop() {
+  const uint64_t value = 1;
+  ssize_t written = write(wake_fd_, &value, sizeof(value));
+  static_cast<void>(written);
+}
+
+uint64_t LeaderBoardServer::GetRequestCount() const {
+  return request_count_;
+}
+
+void LeaderBoardServer::Accept() {
+  while (true) {
+    const int fd = accept4(listen_fd_, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        PrintError("accept");
+      }
+      return;
+    }
+
+    // Responses are small and already batched, so send them right away
+    const int no_delay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+      PrintError("epoll_ctl");
+      close(fd);
+      continue;
+    }
+
+    connections_[fd] = Connection();
+  }
+}
+
+bool LeaderBoardServer::ReadRequests(int fd, Connection* connection) {
+  char buffer[kReadSize];
+
+  while (connection->input.size() < kMaxQueued) {
+    const ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count > 0) {
+      connection->input.append(buffer, static_cast<size_t>(count));
+      continue;
+    }
+
+    // Requests sent before the client hung up are still carried out
+    if (count == 0) {
+      connection->is_closing = true;
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      return false;
+    }
+    break;
+  }
+
+  return HandleRequests(fd, connection);
+}
+
+bool LeaderBoardServer::HandleRequests(int fd, Connection* connection) {
+  // Answer every complete request, leaving a partial one for next time, and
+  // the rest for when the client has read enough of the answers
+  const size_t had_output = connection->output.size();
+  size_t pos = 0;
+  LeaderBoardRequest request;
+  while (connection->output.size() - connection->output_sent < kMaxQueued) {
+    const FrameStatus status = DecodeRequest(connection->input, &pos,
+                                             &request);
+    if (status == FrameStatus::kMalformed) {
+      return false;
+    }
+    if (status == FrameStatus::kIncomplete) {
+      break;
+    }
+
+    const LeaderBoardResponse response = Handle(request);
+    if (response.op == LeaderBoardOp::kAddTime && response.ok) {
+      if (connection->added_times.empty()) {
+        adding_.push_back(fd);
+      }
+      connection->added_times.push_back(connection->output.size());
+    }
+    EncodeResponse(response, &connection->output);
+  }
+  connection->input.erase(0, pos);
+
+  if (connection->output.size() > had_output && had_output == 0) {
+    pending_.push_back(fd);
+  }
+  UpdateEvents(fd, connection);
+
+  return !connection->is_closing || !connection->output.empty();
+}
+
+bool LeaderBoardServer::WriteResponses(int fd, Connection* connection) {
+  while (connection->output_sent < connection->output.size()) {
+    const ssize_t count = send(
+        fd, connection->output.data() + connection->output_sent,
+        connection->output.size() - connection->output_sent, MSG_NOSIGNAL);
+    if (count > 0) {
+      connection->output_sent += static_cast<size_t>(count);
+      continue;
+    }
+
+    if (count == -1 && errno == EINTR) {
+      continue;
+    }
+    if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    return false;
+  }
+
+  const bool is_done = connection->output_sent == connection->output.size();
+  if (is_done) {
+    connection->output.clear();
+    connection->output_sent = 0;
+  }
+  connection->is_send_blocked = !is_done;
+  UpdateEvents(fd, connection);
+
+  // Requests held back while the client was behind are answered next pass
+  if (is_done && !connection->input.empty()) {
+    backlogged_.push_back(fd);
+    return true;
+  }
+
+  return !is_done || !connection->is_closing;
+}
+
+void LeaderBoardServer::UpdateEvents(int fd, Connection* connection) {
+  const bool is_reading
+      = !connection->is_closing
+        && connection->output.size() - connection->output_sent < kMaxQueued;
+  const bool is_writing = connection->is_send_blocked;
+  if (is_reading == connection->is_reading
+      && is_writing == connection->is_writing) {
+    return;
+  }
+  connection->is_reading = is_reading;
+  connection->is_writing = is_writing;
+
+  epoll_event event{};
+  event.events = (is_reading ? EPOLLIN : 0u) | (is_writing ? EPOLLOUT : 0u);
+  event.data.fd = fd;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event);
+}
+
+LeaderBoardResponse LeaderBoardServer::Handle(
+    const LeaderBoardRequest& request) {
+  request_count_++;
+
+  LeaderBoardResponse response;
+  response.op = request.op;
+  response.ok = true;
+  response.rank = 0;
+
+  switch (request.op) {
+    case LeaderBoardOp::kAddTime :
+      if (request.name.size() > kMaxLeaderBoardName) {
+        response.ok = false;
+        break;
+      }
+
+      // Dated by the server, so every client's times share one clock
+      leaderboard_->AddTimeToLeaderBoard(
+          Player(request.name, static_cast<size_t>(request.time),
+                 GetUnixTime()),
+          request.mode, request.difficulty);
+      break;
+    case LeaderBoardOp::kBestTimes :
+      response.players = leaderboard_->RetrieveBestTimes(
+          std::min(request.limit, kMaxLimit), request.mode,
+          request.difficulty);
+      break;
+    case LeaderBoardOp::kRank :
+      response.rank = leaderboard_->RetrieveRank(
+          static_cast<size_t>(request.time), request.mode,
+          request.difficulty);
+      break;
+    case LeaderBoardOp::kPlayerStats :
+      response.stats = leaderboard_->RetrievePlayerStats(
+          request.name, request.mode, request.difficulty);
+      break;
+    case LeaderBoardOp::kWindowBestTimes :
+      response.players = leaderboard_->RetrieveWindowBestTimes(
+          request.window, std::min(request.limit, kMaxLimit), request.mode,
+          request.difficulty);
+      break;
+  }
+
+  return response;
+}
+
+void LeaderBoardServer::RefuseAddedTimes() {
+  LeaderBoardResponse refused;
+  refused.op = LeaderBoardOp::kAddTime;
+  refused.ok = false;
+  refused.rank = 0;
+  std::string frame;
+  EncodeResponse(refused, &frame);
+
+  // Nothing has been sent since the pass began, and an added time's answer
+  // is the same size either way, so it's written over in place
+  for (int fd : adding_) {
+    auto connection = connections_.find(fd);
+    if (connection == connections_.end()) {
+      continue;
+    }
+
+    for (size_t start : connection->second.added_times) {
+      connection->second.output.replace(start, frame.size(), frame);
+    }
+  }
+}
+
+void LeaderBoardServer::Close(int fd) {
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  connections_.erase(fd);
+}
+
+}  // namespace sudoku
+
+#endif  // __linux__
@@ -0,0 +1,554 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/log_leaderboard.h>
+
+#include <sudoku/file_util.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+// Log layout (all integers little endian):
+//   magic "SDKL", u16 version, then records of
+//   u32 body length, u32 FNV-1a checksum of the body, body
+// where the body is one of
+//   u8 kBucketRecord, u16 bucket id, mode, difficulty
+//   u8 kTimeRecord, u16 bucket id, u64 time, i64 submitted at, name
+// and strings are a u16 length and their bytes. A bucket's record comes
+// before any of its times
+const char kLogMagic[] = "SDKL";
+constexpr size_t kMagicSize = 4;
+constexpr uint32_t kLogVersion = 2;
+
+// Logs from before times were dated, whose time records have no submission
+// date. They're still read, and rewritten in the current version
+constexpr uint32_t kUndatedLogVersion = 1;
+constexpr size_t kHeaderSize = kMagicSize + 2;
+constexpr size_t kRecordHeaderSize = 8;
+
+constexpr uint32_t kBucketRecord = 1;
+constexpr uint32_t kTimeRecord = 2;
+
+uint32_t Checksum(const std::string& data, size_t start, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = start; i < start + length; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void PutByte(std::string* out, uint64_t value) {
+  out->push_back(static_cast<char>(value & 0xFF));
+}
+
+void PutU16(std::string* out, uint64_t value) {
+  PutByte(out, value);
+  PutByte(out, value >> 8);
+}
+
+void PutU32(std::string* out, uint64_t value) {
+  PutU16(out, value);
+  PutU16(out, value >> 16);
+}
+
+void PutU64(std::string* out, uint64_t value) {
+  PutU32(out, value);
+  PutU32(out, value >> 32);
+}
+
+void PutString(std::string* out, const std::string& text) {
+  const size_t length = std::min<size_t>(text.size(), 0xFFFF);
+  PutU16(out, length);
+  out->append(text, 0, length);
+}
+
+// Append a record with the body built by `put_body`
+template <typename PutBody>
+void PutRecord(std::string* out, PutBody put_body) {
+  const size_t start = out->size();
+  PutU32(out, 0);
+  PutU32(out, 0);
+  put_body(out);
+
+  const size_t body_start = start + kRecordHeaderSize;
+  const size_t length = out->size() - body_start;
+  const uint32_t checksum = Checksum(*out, body_start, length);
+  for (size_t i = 0; i < 4; i++) {
+    (*out)[start + i] = static_cast<char>(length >> (8 * i) & 0xFF);
+    (*out)[start + 4 + i] = static_cast<char>(checksum >> (8 * i) & 0xFF);
+  }
+}
+
+void PutBucketRecord(std::string* out, uint16_t id, const std::string& mode,
+                     const std::string& difficulty) {
+  PutRecord(out, [&](std::string* body) {
+    PutByte(body, kBucketRecord);
+    PutU16(body, id);
+    PutString(body, mode);
+    PutString(body, difficulty);
+  });
+}
+
+void PutTimeRecord(std::string* out, uint16_t id, uint64_t time,
+                   int64_t submitted_at, const std::string& name) {
+  PutRecord(out, [&](std::string* body) {
+    PutByte(body, kTimeRecord);
+    PutU16(body, id);
+    PutU64(body, time);
+    PutU64(body, static_cast<uint64_t>(submitted_at));
+    PutString(body, name);
+  });
+}
+
+std::string GetLogHeader() {
+  std::string header(kLogMagic, kMagicSize);
+  PutU16(&header, kLogVersion);
+  return header;
+}
+
+// Reads integers from a log, remembering if it ran past the end
+class LogReader {
+ public:
+  LogReader(const std::string& data, size_t pos, size_t end)
+      : data_(data), pos_(pos), end_(end), failed_(false) {}
+
+  uint64_t Byte() {
+    if (pos_ >= end_) {
+      failed_ = true;
+      return 0;
+    }
+
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint64_t U16() {
+    uint64_t low = Byte();
+    return low | Byte() << 8;
+  }
+
+  uint64_t U32() {
+    uint64_t low = U16();
+    return low | U16() << 16;
+  }
+
+  uint64_t U64() {
+    uint64_t low = U32();
+    return low | U32() << 32;
+  }
+
+  std::string String() {
+    const auto length = static_cast<size_t>(U16());
+    if (failed_ || length > end_ - pos_) {
+      failed_ = true;
+      return "";
+    }
+
+    pos_ += length;
+    return data_.substr(pos_ - length, length);
+  }
+
+  bool IsDone() const { return !failed_ && pos_ == end_; }
+
+ private:
+  const std::string& data_;
+  size_t pos_;
+  size_t end_;
+  bool failed_;
+};
+
+}  // namespace
+
+LogLeaderBoard::LogLeaderBoard(const std::string& log_path,
+                               const LogLeaderBoardOptions& options)
+    : log_path_{log_path},
+      options_{options},
+      log_{nullptr},
+      log_size_{0},
+      is_batching_{false} {
+  // Rewriting the log leaves out a bad tail, so new records don't end up
+  // after it where they'd never be read
+  if (!Load() || HasTimesPastLimit()) {
+    Rewrite();
+  } else {
+    OpenForAppend();
+  }
+}
+
+LogLeaderBoard::~LogLeaderBoard() {
+  if (log_ != nullptr) {
+    Sync();
+    std::fclose(log_);
+  }
+}
+
+void LogLeaderBoard::AddTimeToLeaderBoard(const Player& player,
+                                          std::string mode,
+                                          std::string difficulty) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+
+  Bucket* bucket = GetOrAddBucket(mode, difficulty);
+  if (bucket == nullptr) {
+    return;
+  }
+
+  std::string records;
+  if (bucket->times == nullptr) {
+    // First time for the bucket, so the log needs to say what it is
+    PutBucketRecord(&records, bucket->id, mode, difficulty);
+    std::lock_guard<std::mutex> buckets_lock(buckets_mutex_);
+    bucket->times = std::make_shared<TimeSkipList>();
+  }
+
+  PutTimeRecord(&records, bucket->id, player.time, player.submitted_at,
+                player.name);
+  Append(records);
+  bucket->times->Insert(player.time, player.name, player.submitted_at);
+}
+
+std::vector<Player> LogLeaderBoard::RetrieveBestTimes(const size_t limit,
+                                                      std::string mode,
+                                                      std::string difficulty) {
+  auto times = GetTimes(mode, difficulty);
+  if (times == nullptr) {
+    return {};
+  }
+
+  return times->GetFirst(limit);
+}
+
+size_t LogLeaderBoard::RetrieveRank(size_t time,
+                                    std::string mode,
+                                    std::string difficulty) {
+  auto times = GetTimes(mode, difficulty);
+  if (times == nullptr) {
+    return 1;
+  }
+
+  return times->CountUpTo(time) + 1;
+}
+
+void LogLeaderBoard::BeginBatch() {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  is_batching_ = true;
+}
+
+bool LogLeaderBoard::EndBatch() {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  is_batching_ = false;
+  Sync();
+  return true;
+}
+
+bool LogLeaderBoard::HasTime(const Player& player, const std::string& mode,
+                             const std::string& difficulty) {
+  auto times = GetTimes(mode, difficulty);
+  return times != nullptr && times->Contains(player);
+}
+
+bool LogLeaderBoard::ForEachTime(const TimeVisitor& visit) {
+  std::vector<std::pair<const Bucket*, std::shared_ptr<const TimeSkipList>>>
+      buckets;
+  {
+    std::lock_guard<std::mutex> lock(buckets_mutex_);
+    for (const auto& entry : buckets_) {
+      if (entry.second->times != nullptr) {
+        buckets.emplace_back(entry.second.get(), entry.second->times);
+      }
+    }
+  }
+
+  // Buckets are never removed, and their names never change
+  for (const auto& bucket : buckets) {
+    bucket.second->ForEach([&visit, &bucket](const Player& player) {
+      visit(player, bucket.first->mode, bucket.first->difficulty);
+    });
+  }
+
+  return true;
+}
+
+void LogLeaderBoard::Compact() {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  Rewrite();
+}
+
+uint64_t LogLeaderBoard::GetLogSize() const {
+  std::lock_guard<std::mutex> lock(buckets_mutex_);
+  return log_size_;
+}
+
+bool LogLeaderBoard::Load() {
+  std::ifstream file(log_path_, std::ios::binary);
+  if (!file) {
+    return true;
+  }
+
+  const std::string data{std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>()};
+  if (data.empty()) {
+    return true;
+  }
+
+  LogReader header(data, kMagicSize, std::min(data.size(), kHeaderSize));
+  const uint64_t version = header.U16();
+  if (data.compare(0, kMagicSize, kLogMagic) != 0
+      || (version != kLogVersion && version != kUndatedLogVersion)
+      || !header.IsDone()) {
+    // Not a log this can read, so keep it out of the way rather than
+    // writing over it
+    const std::string moved_path = log_path_ + ".unreadable";
+    std::cerr << "Leaderboard log " << log_path_ << " isn't readable, moving "
+              << "it to " << moved_path << std::endl;
+    ReplaceFile(log_path_, moved_path);
+    return true;
+  }
+
+  std::map<uint64_t, Bucket*> buckets_by_id;
+  size_t pos = kHeaderSize;
+  while (pos < data.size()) {
+    LogReader record_header(data, pos, std::min(data.size(),
+                                                pos + kRecordHeaderSize));
+    const auto length = static_cast<size_t>(record_header.U32());
+    const auto checksum = static_cast<uint32_t>(record_header.U32());
+    const size_t body_start = pos + kRecordHeaderSize;
+    if (!record_header.IsDone() || length > data.size() - body_start
+        || Checksum(data, body_start, length) != checksum) {
+      break;
+    }
+
+    LogReader body(data, body_start, body_start + length);
+    const uint64_t type = body.Byte();
+    const uint64_t id = body.U16();
+    if (type == kBucketRecord) {
+      const std::string mode = body.String();
+      const std::string difficulty = body.String();
+      if (!body.IsDone() || buckets_by_id.count(id) != 0) {
+        break;
+      }
+
+      auto bucket = std::make_unique<Bucket>();
+      bucket->id = static_cast<uint16_t>(id);
+      bucket->mode = mode;
+      bucket->difficulty = difficulty;
+      bucket->times = std::make_shared<TimeSkipList>();
+      buckets_by_id[id] = bucket.get();
+      buckets_[{mode, difficulty}] = std::move(bucket);
+    } else if (type == kTimeRecord) {
+      const uint64_t time = body.U64();
+      const auto submitted_at = version == kUndatedLogVersion
+                                ? 0 : static_cast<int64_t>(body.U64());
+      const std::string name = body.String();
+      auto bucket = buckets_by_id.find(id);
+      if (!body.IsDone() || bucket == buckets_by_id.end()) {
+        break;
+      }
+
+      bucket->second->times->Insert(time, name, submitted_at);
+    } else {
+      break;
+    }
+
+    pos = body_start + length;
+  }
+
+  log_size_ = pos;
+  if (pos < data.size()) {
+    std::cerr << "Leaderboard log " << log_path_ << " has a bad record at "
+              << "byte " << pos << ", dropping the " << data.size() - pos
+              << " bytes from there on" << std::endl;
+    return false;
+  }
+
+  // Appending records in the current version needs a header that says so
+  return version == kLogVersion;
+}
+
+bool LogLeaderBoard::HasTimesPastLimit() const {
+  if (options_.max_times_per_bucket == 0) {
+    return false;
+  }
+
+  for (const auto& entry : buckets_) {
+    const Bucket& bucket = *entry.second;
+    if (bucket.times != nullptr
+        && bucket.times->GetSize() > options_.max_times_per_bucket) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::shared_ptr<const TimeSkipList> LogLeaderBoard::GetTimes(
+    const std::string& mode, const std::string& difficulty) {
+  std::lock_guard<std::mutex> lock(buckets_mutex_);
+  auto bucket = buckets_.find({mode, difficulty});
+  if (bucket == buckets_.end()) {
+    return nullptr;
+  }
+
+  return bucket->second->times;
+}
+
+void LogLeaderBoard::Rewrite() {
+  // Build the new lists before touching the file, so a failed write leaves
+  // everything as it was
+  std::string data = GetLogHeader();
+  std::vector<std::shared_ptr<TimeSkipList>> new_times;
+  const size_t limit = options_.max_times_per_bucket != 0
+                       ? options_.max_times_per_bucket
+                       : std::numeric_limits<size_t>::max();
+  for (const auto& entry : buckets_) {
+    const Bucket& bucket = *entry.second;
+    auto times = std::make_shared<TimeSkipList>();
+    new_times.push_back(times);
+    if (bucket.times == nullptr) {
+      continue;
+    }
+
+    const auto id = static_cast<uint16_t>(new_times.size() - 1);
+    PutBucketRecord(&data, id, bucket.mode, bucket.difficulty);
+    for (const Player& player : bucket.times->GetFirst(limit)) {
+      PutTimeRecord(&data, id, player.time, player.submitted_at,
+                    player.name);
+      times->Insert(player.time, player.name, player.submitted_at);
+    }
+  }
+
+  const std::string temp_path = log_path_ + ".tmp";
+  std::FILE* temp = std::fopen(temp_path.c_str(), "wb");
+  bool is_written = temp != nullptr
+                    && std::fwrite(data.data(), 1, data.size(), temp)
+                       == data.size()
+                    && std::fflush(temp) == 0;
+  if (temp != nullptr) {
+#ifdef _WIN32
+    is_written = is_written && _commit(_fileno(temp)) == 0;
+#else
+    is_written = is_written && fsync(fileno(temp)) == 0;
+#endif
+    is_written = std::fclose(temp) == 0 && is_written;
+  }
+
+  if (log_ != nullptr) {
+    std::fclose(log_);
+    log_ = nullptr;
+  }
+  if (!is_written || !ReplaceFile(temp_path, log_path_)) {
+    std::cerr << "Couldn't compact leaderboard log " << log_path_
+              << std::endl;
+    std::remove(temp_path.c_str());
+    OpenForAppend();
+    return;
+  }
+  if (!SyncDirectory(log_path_)) {
+    std::cerr << "Couldn't sync the directory of leaderboard log "
+              << log_path_ << std::endl;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(buckets_mutex_);
+    size_t index = 0;
+    for (auto& entry : buckets_) {
+      Bucket& bucket = *entry.second;
+      if (bucket.times != nullptr) {
+        bucket.times = new_times[index];
+      }
+      bucket.id = static_cast<uint16_t>(index++);
+    }
+    log_size_ = data.size();
+  }
+
+  OpenForAppend();
+}
+
+LogLeaderBoard::Bucket* LogLeaderBoard::GetOrAddBucket(
+    const std::string& mode, const std::string& difficulty) {
+  auto bucket = buckets_.find({mode, difficulty});
+  if (bucket != buckets_.end()) {
+    return bucket->second.get();
+  }
+
+  if (buckets_.size() > 0xFFFF) {
+    std::cerr << "Leaderboard log " << log_path_ << " has no room for "
+              << mode << " " << difficulty << std::endl;
+    return nullptr;
+  }
+
+  auto added = std::make_unique<Bucket>();
+  added->id = static_cast<uint16_t>(buckets_.size());
+  added->mode = mode;
+  added->difficulty = difficulty;
+
+  std::lock_guard<std::mutex> lock(buckets_mutex_);
+  Bucket* added_bucket = added.get();
+  buckets_[{mode, difficulty}] = std::move(added);
+  return added_bucket;
+}
+
+bool LogLeaderBoard::OpenForAppend() {
+  log_ = std::fopen(log_path_.c_str(), "ab");
+  if (log_ == nullptr) {
+    std::cerr << "Couldn't open leaderboard log " << log_path_ << std::endl;
+    return false;
+  }
+
+  if (log_size_ == 0) {
+    Append(GetLogHeader());
+  }
+
+  return true;
+}
+
+void LogLeaderBoard::Append(const std::string& records) {
+  if (log_ == nullptr) {
+    return;
+  }
+
+  // Records are handed to the OS whole, so a crash can only tear the last
+  if (std::fwrite(records.data(), 1, records.size(), log_) != records.size()
+      || std::fflush(log_) != 0) {
+    std::cerr << "Couldn't write to leaderboard log " << log_path_
+              << std::endl;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(buckets_mutex_);
+    log_size_ += records.size();
+  }
+
+  if (options_.sync_every_write && !is_batching_) {
+    Sync();
+  }
+}
+
+void LogLeaderBoard::Sync() {
+  if (log_ == nullptr) {
+    return;
+  }
+
+#ifdef _WIN32
+  _commit(_fileno(log_));
+#else
+  fsync(fileno(log_));
+#endif
+}
+
+}  // namespace sudoku
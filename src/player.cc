@@ -0,0 +1,61 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/player.h>
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace sudoku {
+
+PlayerName::PlayerName(const std::string& name)
+    : name_{std::make_shared<const std::string>(name)} {}
+
+PlayerName::PlayerName(const char* name)
+    : name_{std::make_shared<const std::string>(name)} {}
+
+PlayerName::operator const std::string&() const {
+  return *name_;
+}
+
+const std::string& PlayerName::str() const {
+  return *name_;
+}
+
+size_t PlayerName::size() const {
+  return name_->size();
+}
+
+bool PlayerName::empty() const {
+  return name_->empty();
+}
+
+bool PlayerName::IsShared(const PlayerName& other) const {
+  return name_ == other.name_;
+}
+
+bool operator==(const PlayerName& lhs, const PlayerName& rhs) {
+  return lhs.IsShared(rhs) || lhs.str() == rhs.str();
+}
+
+bool operator==(const PlayerName& lhs, const std::string& rhs) {
+  return lhs.str() == rhs;
+}
+
+bool operator==(const std::string& lhs, const PlayerName& rhs) {
+  return lhs == rhs.str();
+}
+
+bool operator==(const PlayerName& lhs, const char* rhs) {
+  return lhs.str() == rhs;
+}
+
+bool operator==(const char* lhs, const PlayerName& rhs) {
+  return lhs == rhs.str();
+}
+
+std::ostream& operator<<(std::ostream& out, const PlayerName& name) {
+  return out << name.str();
+}
+
+}  // namespace sudoku
@@ -0,0 +1,175 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/profiler.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <thread>
+
+namespace sudoku {
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+namespace {
+
+const double kNsPerMs = 1e6;
+const double kNsPerUs = 1e3;
+
+uint32_t GetThreadId() {
+  static thread_local const auto id = static_cast<uint32_t>(
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+  return id;
+}
+
+// Nearest rank percentile of sorted durations
+double Percentile(const std::vector<int64_t>& sorted, double fraction) {
+  auto rank = static_cast<size_t>(
+      std::ceil(fraction * static_cast<double>(sorted.size())));
+  size_t index = rank == 0 ? 0 : rank - 1;
+
+  return static_cast<double>(sorted[index]) / kNsPerMs;
+}
+
+std::atomic<size_t> draw_calls{0};
+std::atomic<size_t> texture_uploads{0};
+
+}  // namespace
+
+Profiler::Profiler(size_t capacity) : epoch_{Clock::now()},
+                                      slots_(std::max<size_t>(capacity, 1)),
+                                      next_index_{0} {}
+
+void Profiler::Record(const char* scope, Clock::time_point start,
+                      Clock::time_point end) {
+  const uint64_t index = next_index_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[index % slots_.size()];
+
+  // An odd sequence number marks the slot as being written
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.scope.store(scope, std::memory_order_relaxed);
+  slot.start_ns.store(duration_cast<nanoseconds>(start - epoch_).count(),
+                      std::memory_order_relaxed);
+  slot.duration_ns.store(duration_cast<nanoseconds>(end - start).count(),
+                         std::memory_order_relaxed);
+  slot.thread_id.store(GetThreadId(), std::memory_order_relaxed);
+
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<ProfileSample> Profiler::GetSamples() const {
+  const uint64_t end = next_index_.load(std::memory_order_acquire);
+  const uint64_t begin = end > slots_.size() ? end - slots_.size() : 0;
+
+  std::vector<ProfileSample> samples;
+  samples.reserve(static_cast<size_t>(end - begin));
+
+  for (uint64_t index = begin; index < end; index++) {
+    const Slot& slot = slots_[index % slots_.size()];
+    const uint64_t finished = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != finished) {
+      continue;
+    }
+
+    ProfileSample sample{slot.scope.load(std::memory_order_relaxed),
+                         slot.start_ns.load(std::memory_order_relaxed),
+                         slot.duration_ns.load(std::memory_order_relaxed),
+                         slot.thread_id.load(std::memory_order_relaxed)};
+
+    // Skip the sample if a writer reused the slot while it was being read
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != finished) {
+      continue;
+    }
+
+    samples.push_back(sample);
+  }
+
+  return samples;
+}
+
+std::vector<ScopeStats> Profiler::GetStats() const {
+  std::map<std::string, std::vector<int64_t>> durations;
+  for (const auto& sample : GetSamples()) {
+    durations[sample.scope].push_back(sample.duration_ns);
+  }
+
+  std::vector<ScopeStats> stats;
+  for (auto& scope : durations) {
+    auto& times = scope.second;
+    std::sort(times.begin(), times.end());
+
+    stats.push_back({scope.first,
+                     times.size(),
+                     Percentile(times, 0.5),
+                     Percentile(times, 0.99),
+                     static_cast<double>(times.back()) / kNsPerMs});
+  }
+
+  return stats;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) const {
+  nlohmann::json events = nlohmann::json::array();
+  for (const auto& sample : GetSamples()) {
+    // Complete events, with times in microseconds
+    events.push_back({{"name", sample.scope},
+                      {"ph", "X"},
+                      {"ts", static_cast<double>(sample.start_ns) / kNsPerUs},
+                      {"dur",
+                       static_cast<double>(sample.duration_ns) / kNsPerUs},
+                      {"pid", 1},
+                      {"tid", sample.thread_id}});
+  }
+
+  nlohmann::json trace = {{"traceEvents", events},
+                          {"displayTimeUnit", "ms"}};
+
+  std::ofstream outfile(path, std::ios::trunc);
+  outfile << trace.dump();
+
+  return static_cast<bool>(outfile);
+}
+
+void Profiler::Clear() {
+  // Move the window past every slot, so old samples fail the sequence check
+  next_index_.fetch_add(slots_.size(), std::memory_order_release);
+}
+
+size_t Profiler::GetCapacity() const {
+  return slots_.size();
+}
+
+Profiler& GetDefaultProfiler() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void CountDrawCall() {
+  draw_calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountTextureUpload() {
+  texture_uploads.fetch_add(1, std::memory_order_relaxed);
+}
+
+RenderCounts GetRenderCounts() {
+  return {draw_calls.load(std::memory_order_relaxed),
+          texture_uploads.load(std::memory_order_relaxed)};
+}
+
+ScopedTimer::ScopedTimer(const char* scope, Profiler* profiler)
+    : scope_{scope}, profiler_{profiler}, start_{Profiler::Clock::now()} {}
+
+ScopedTimer::~ScopedTimer() {
+  profiler_->Record(scope_, start_, Profiler::Clock::now());
+}
+
+}  // namespace sudoku
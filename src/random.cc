@@ -0,0 +1,68 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/random.h>
+
+namespace sudoku {
+
+Random::Random(uint64_t seed) {
+  for (uint64_t& word : state_) {
+    seed += 0x9E3779B97F4A7C15ull;
+    uint64_t mixed = seed;
+    mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+    word = mixed ^ (mixed >> 31);
+  }
+}
+
+Random Random::Split() {
+  Random split = *this;
+  Jump();
+
+  return split;
+}
+
+void Random::Jump() {
+  // Polynomial for 2^128 steps, from the generator's authors
+  static const uint64_t kJump[] = {0x180EC6D33CFD0ABAull,
+                                   0xD5A61266F0C9392Cull,
+                                   0xA9582618E03FC9AAull,
+                                   0x39ABDC4529B1661Cull};
+
+  uint64_t jumped[4] = {0, 0, 0, 0};
+  for (uint64_t word : kJump) {
+    for (int bit = 0; bit < 64; bit++) {
+      if ((word >> bit) & 1) {
+        for (int i = 0; i < 4; i++) {
+          jumped[i] ^= state_[i];
+        }
+      }
+      (*this)();
+    }
+  }
+
+  for (int i = 0; i < 4; i++) {
+    state_[i] = jumped[i];
+  }
+}
+
+uint64_t RandomIndex(uint64_t n, Random* rng) {
+  if (n > UINT32_MAX) {
+    return RandomIndex<Random>(n, rng);
+  }
+
+  // The top 32 bits scaled to [0, n) are the high half of the product. The
+  // low half says whether the draw landed in the few that would make some
+  // indexes more likely than others
+  const auto bound = static_cast<uint32_t>(n);
+  uint64_t product = ((*rng)() >> 32) * bound;
+  if (static_cast<uint32_t>(product) < bound) {
+    const uint32_t threshold = (0u - bound) % bound;
+    while (static_cast<uint32_t>(product) < threshold) {
+      product = ((*rng)() >> 32) * bound;
+    }
+  }
+
+  return product >> 32;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,327 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/sharded_leaderboard.h>
+
+#include <sqlite_modern_cpp.h>
+
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+// "Time Trial" -> "time_trial", for use in file names
+std::string GetFileNamePart(const std::string& name) {
+  std::string part;
+  for (char c : name) {
+    if (std::isalnum(static_cast<unsigned char>(c))) {
+      part.push_back(static_cast<char>(
+          std::tolower(static_cast<unsigned char>(c))));
+    } else if (!part.empty() && part.back() != '_') {
+      part.push_back('_');
+    }
+  }
+
+  return part;
+}
+
+}  // namespace
+
+ShardedLeaderBoard::ShardedLeaderBoard(const std::string& db_path)
+    : is_batching_{false} {
+  for (size_t mode = 0; mode < kLeaderBoardModes.size(); mode++) {
+    for (size_t difficulty = 0; difficulty < kLeaderBoardDifficulties.size();
+         difficulty++) {
+      Shard& shard = shards_[mode * kLeaderBoardDifficulties.size()
+                             + difficulty];
+      shard.leaderboard = std::make_unique<SqliteLeaderBoard>(
+          GetShardPath(db_path, kLeaderBoardModes[mode],
+                       kLeaderBoardDifficulties[difficulty]));
+    }
+  }
+
+  MoveUnshardedTimes(db_path);
+}
+
+void ShardedLeaderBoard::AddTimeToLeaderBoard(const Player& player,
+                                              std::string mode,
+                                              std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  if (is_batching_ && !shard->is_batching) {
+    shard->leaderboard->BeginBatch();
+    shard->is_batching = true;
+  }
+  shard->leaderboard->AddTimeToLeaderBoard(player, mode, difficulty);
+}
+
+std::vector<Player> ShardedLeaderBoard::RetrieveBestTimes(
+    const size_t limit, std::string mode, std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->RetrieveBestTimes(limit, mode, difficulty);
+}
+
+std::vector<Player> ShardedLeaderBoard::RetrieveWindowBestTimes(
+    LeaderBoardWindow window, const size_t limit, std::string mode,
+    std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->RetrieveWindowBestTimes(window, limit, mode,
+                                                     difficulty);
+}
+
+size_t ShardedLeaderBoard::RetrieveRank(size_t time,
+                                        std::string mode,
+                                        std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return 1;
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->RetrieveRank(time, mode, difficulty);
+}
+
+std::vector<Player> ShardedLeaderBoard::RetrievePlayerBestTimes(
+    const std::string& name, size_t limit, std::string mode,
+    std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->RetrievePlayerBestTimes(name, limit, mode,
+                                                     difficulty);
+}
+
+std::vector<Player> ShardedLeaderBoard::RetrievePlayerRecentTimes(
+    const std::string& name, size_t limit, std::string mode,
+    std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->RetrievePlayerRecentTimes(name, limit, mode,
+                                                       difficulty);
+}
+
+PlayerStats ShardedLeaderBoard::RetrievePlayerStats(const std::string& name,
+                                                    std::string mode,
+                                                    std::string difficulty) {
+  Shard* shard = GetShard(mode, difficulty);
+  if (shard == nullptr) {
+    return {};
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->RetrievePlayerStats(name, mode, difficulty);
+}
+
+bool ShardedLeaderBoard::HasTime(const Player& player, const std::string& mode,
+                                 const std::string& difficulty) {
+  Shard* shard = FindShard(mode, difficulty);
+  if (shard == nullptr) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  return shard->leaderboard->HasTime(player, mode, difficulty);
+}
+
+void ShardedLeaderBoard::BeginBatch() {
+  is_batching_ = true;
+}
+
+bool ShardedLeaderBoard::EndBatch() {
+  is_batching_ = false;
+
+  bool is_saved = true;
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.is_batching) {
+      is_saved &= shard.leaderboard->EndBatch();
+      shard.is_batching = false;
+    }
+  }
+
+  return is_saved;
+}
+
+void ShardedLeaderBoard::CancelBatch() {
+  is_batching_ = false;
+
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.is_batching) {
+      shard.leaderboard->CancelBatch();
+      shard.is_batching = false;
+    }
+  }
+}
+
+bool ShardedLeaderBoard::ForEachTime(const TimeVisitor& visit) {
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.leaderboard->ForEachTime(visit)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::string ShardedLeaderBoard::GetShardPath(const std::string& db_path,
+                                             const std::string& mode,
+                                             const std::string& difficulty) {
+  // Put the bucket before the extension, if the file has one
+  const size_t slash = db_path.find_last_of("/\\");
+  size_t dot = db_path.rfind('.');
+  if (dot == std::string::npos || dot == 0
+      || (slash != std::string::npos && dot < slash + 2)) {
+    dot = db_path.size();
+  }
+
+  return db_path.substr(0, dot) + "." + GetFileNamePart(mode) + "."
+         + GetFileNamePart(difficulty) + db_path.substr(dot);
+}
+
+ShardedLeaderBoard::Shard* ShardedLeaderBoard::FindShard(
+    const std::string& mode, const std::string& difficulty) {
+  for (size_t i = 0; i < kLeaderBoardModes.size(); i++) {
+    if (mode != kLeaderBoardModes[i]) {
+      continue;
+    }
+
+    for (size_t j = 0; j < kLeaderBoardDifficulties.size(); j++) {
+      if (difficulty == kLeaderBoardDifficulties[j]) {
+        return &shards_[i * kLeaderBoardDifficulties.size() + j];
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+ShardedLeaderBoard::Shard* ShardedLeaderBoard::GetShard(
+    const std::string& mode, const std::string& difficulty) {
+  Shard* shard = FindShard(mode, difficulty);
+  if (shard == nullptr) {
+    std::cerr << "No leaderboard for " << mode << " " << difficulty
+              << std::endl;
+  }
+
+  return shard;
+}
+
+void ShardedLeaderBoard::MoveUnshardedTimes(const std::string& db_path) {
+  if (!std::ifstream(db_path)) {
+    return;
+  }
+
+  // Brings old rows up to date, so they're in milliseconds
+  SqliteLeaderBoard unsharded(db_path);
+
+  // Each shard records the last unsharded row it took along with the rows,
+  // so if the move is cut short, the next one skips what's already there
+  const std::string source = "unsharded";
+
+  try {
+    sqlite::database db(db_path);
+    struct Row {
+      int64_t rowid;
+      Shard* shard;
+      Player player;
+      std::string mode;
+      std::string difficulty;
+    };
+
+    std::vector<Row> rows;
+    size_t num_unsharded = 0;
+    db << "select leaderboard.rowid, players.name, time, submitted_at, mode, "
+          "difficulty "
+          "from leaderboard join players on players.id = player_id "
+          "order by leaderboard.rowid;"
+       >> [this, &rows, &num_unsharded](
+              int64_t rowid, std::string name, size_t time,
+              int64_t submitted_at, std::string mode,
+              std::string difficulty) {
+         Shard* shard = FindShard(mode, difficulty);
+         if (shard == nullptr) {
+           num_unsharded++;
+         } else {
+           rows.push_back({rowid, shard, Player(name, time, submitted_at),
+                           mode, difficulty});
+         }
+       };
+
+    if (num_unsharded > 0) {
+      std::cerr << num_unsharded << " times in " << db_path
+                << " have no shard, so they were left there" << std::endl;
+    }
+    if (rows.empty()) {
+      return;
+    }
+
+    std::array<int64_t, std::tuple_size<decltype(shards_)>::value> copied;
+    for (size_t i = 0; i < shards_.size(); i++) {
+      copied[i] = shards_[i].leaderboard->GetCopiedRowId(source);
+    }
+
+    BeginBatch();
+    for (const Row& row : rows) {
+      const auto index = static_cast<size_t>(row.shard - shards_.data());
+      if (row.rowid > copied[index]) {
+        AddTimeToLeaderBoard(row.player, row.mode, row.difficulty);
+        copied[index] = row.rowid;
+      }
+    }
+    for (size_t i = 0; i < shards_.size(); i++) {
+      if (shards_[i].is_batching) {
+        shards_[i].leaderboard->SetCopiedRowId(source, copied[i]);
+      }
+    }
+    EndBatch();
+
+    // Only rows their shard has committed are deleted, so a shard that
+    // failed to commit keeps its rows here for next time
+    for (size_t i = 0; i < shards_.size(); i++) {
+      copied[i] = shards_[i].leaderboard->GetCopiedRowId(source);
+    }
+
+    db << "begin;";
+    for (const Row& row : rows) {
+      const auto index = static_cast<size_t>(row.shard - shards_.data());
+      if (row.rowid <= copied[index]) {
+        db << "delete from leaderboard where rowid = ?;" << row.rowid;
+      }
+    }
+    db << "commit;";
+  } catch (const sqlite::sqlite_exception& e) {
+    std::cerr << e.get_code() << ": " << e.what() << " during " << e.get_sql()
+              << std::endl;
+  }
+}
+
+}  // namespace sudoku
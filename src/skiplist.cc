@@ -0,0 +1,132 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/skiplist.h>
+
+#include <string>
+#include <vector>
+
+namespace sudoku {
+
+constexpr int TimeSkipList::kMaxHeight;
+
+TimeSkipList::Node::Node(uint64_t time, const PlayerName& name,
+                         int64_t submitted_at, int height)
+    : time{time},
+      name{name},
+      submitted_at{submitted_at},
+      next{new std::atomic<Node*>[height]} {
+  for (int level = 0; level < height; level++) {
+    next[level].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+TimeSkipList::TimeSkipList()
+    : head_{0, "", 0, kMaxHeight}, height_{1}, size_{0} {}
+
+TimeSkipList::~TimeSkipList() = default;
+
+void TimeSkipList::Insert(uint64_t time, const PlayerName& name,
+                          int64_t submitted_at) {
+  // The last node on each level that comes before the new one. Equal times
+  // are passed over, so the new one goes after them
+  Node* previous[kMaxHeight];
+  Node* node = &head_;
+  const int height = height_.load(std::memory_order_relaxed);
+  for (int level = height - 1; level >= 0; level--) {
+    Node* next = node->next[level].load(std::memory_order_acquire);
+    while (next != nullptr && next->time <= time) {
+      node = next;
+      next = node->next[level].load(std::memory_order_acquire);
+    }
+    previous[level] = node;
+  }
+
+  const int new_height = RandomHeight();
+  for (int level = height; level < new_height; level++) {
+    previous[level] = &head_;
+  }
+  if (new_height > height) {
+    // Readers that see the new height before the node is linked in just
+    // find null at the top of the head, which is fine
+    height_.store(new_height, std::memory_order_relaxed);
+  }
+
+  nodes_.push_back(std::unique_ptr<Node>(
+      new Node(time, name, submitted_at, new_height)));
+  Node* added = nodes_.back().get();
+
+  // Point the node at its successors before publishing it, from the bottom
+  // up, so a reader that finds it can always carry on past it
+  for (int level = 0; level < new_height; level++) {
+    added->next[level].store(
+        previous[level]->next[level].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    previous[level]->next[level].store(added, std::memory_order_release);
+  }
+
+  size_.fetch_add(1, std::memory_order_release);
+}
+
+std::vector<Player> TimeSkipList::GetFirst(size_t limit) const {
+  std::vector<Player> players;
+  const Node* node = head_.next[0].load(std::memory_order_acquire);
+  while (node != nullptr && players.size() < limit) {
+    players.emplace_back(node->name, static_cast<size_t>(node->time),
+                         node->submitted_at);
+    node = node->next[0].load(std::memory_order_acquire);
+  }
+
+  return players;
+}
+
+size_t TimeSkipList::CountUpTo(uint64_t time) const {
+  size_t count = 0;
+  const Node* node = head_.next[0].load(std::memory_order_acquire);
+  while (node != nullptr && node->time <= time) {
+    count++;
+    node = node->next[0].load(std::memory_order_acquire);
+  }
+
+  return count;
+}
+
+bool TimeSkipList::Contains(const Player& player) const {
+  // Skip down to the last node faster than the player, then look through
+  // the ones with their time
+  const uint64_t time = player.time;
+  const Node* node = &head_;
+  for (int level = height_.load(std::memory_order_relaxed) - 1; level >= 0;
+       level--) {
+    const Node* next = node->next[level].load(std::memory_order_acquire);
+    while (next != nullptr && next->time < time) {
+      node = next;
+      next = node->next[level].load(std::memory_order_acquire);
+    }
+  }
+
+  node = node->next[0].load(std::memory_order_acquire);
+  while (node != nullptr && node->time == time) {
+    if (node->submitted_at == player.submitted_at
+        && node->name == player.name) {
+      return true;
+    }
+    node = node->next[0].load(std::memory_order_acquire);
+  }
+
+  return false;
+}
+
+size_t TimeSkipList::GetSize() const {
+  return size_.load(std::memory_order_acquire);
+}
+
+int TimeSkipList::RandomHeight() {
+  int height = 1;
+  while (height < kMaxHeight && rng_() % 4 == 0) {
+    height++;
+  }
+
+  return height;
+}
+
+}  // namespace sudoku
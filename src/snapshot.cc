@@ -0,0 +1,412 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/engine.h>
+
+#include <sudoku/daily_challenge.h>
+#include <sudoku/file_util.h>
+#include <sudoku/variant.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+// Snapshot layout (all integers little endian):
+//   magic "SDKS", u16 version, u8 difficulty, u8 mode, u8 penciling,
+//   u16 games completed, u32 game time in ms, u8 clock paused,
+//   u8 split count + u32 split times in ms, u8 id length + puzzle id bytes,
+//   81 bytes of (entry | entry state << 4), 41 bytes of solution nibbles,
+//   81 u16 pencil masks, variant rules, u32 FNV-1a checksum of everything
+//   before it
+// The variant rules are a u8 that's 1 for classic rules, and otherwise 0
+// followed by u8 group count + (u8 size + cells) for each group, u8 cage
+// count + (u8 sum, u8 size + cells) for each cage and 81 u16 allowed masks.
+// Version 1 stored the game time in whole seconds and had no clock state,
+// and versions before 3 were always classic
+const char kSnapshotMagic[] = "SDKS";
+constexpr size_t kMagicSize = 4;
+constexpr uint32_t kSecondsSnapshotVersion = 1;
+constexpr uint32_t kClassicSnapshotVersion = 2;
+constexpr uint32_t kSnapshotVersion = 3;
+constexpr size_t kNumCells = kBoardSize * kBoardSize;
+
+uint32_t Checksum(const std::string& data, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void PutByte(std::string* out, uint32_t value) {
+  out->push_back(static_cast<char>(value & 0xFF));
+}
+
+void PutU16(std::string* out, uint32_t value) {
+  PutByte(out, value);
+  PutByte(out, value >> 8);
+}
+
+void PutU32(std::string* out, uint32_t value) {
+  PutU16(out, value);
+  PutU16(out, value >> 16);
+}
+
+// Reads integers from a snapshot, remembering if it ran past the end
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(const std::string& data, size_t length)
+      : data_(data), length_(length), pos_(0), failed_(false) {}
+
+  uint32_t Byte() {
+    if (pos_ >= length_) {
+      failed_ = true;
+      return 0;
+    }
+
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint32_t U16() {
+    uint32_t low = Byte();
+    return low | Byte() << 8;
+  }
+
+  uint32_t U32() {
+    uint32_t low = U16();
+    return low | U16() << 16;
+  }
+
+  void Skip(size_t count) {
+    if (count > length_ - pos_) {
+      failed_ = true;
+      pos_ = length_;
+    } else {
+      pos_ += count;
+    }
+  }
+
+  bool Failed() const { return failed_; }
+  size_t Position() const { return pos_; }
+
+ private:
+  const std::string& data_;
+  size_t length_;
+  size_t pos_;
+  bool failed_;
+};
+
+std::vector<size_t> ReadCells(SnapshotReader* reader) {
+  std::vector<size_t> cells(reader->Byte());
+  for (size_t& cell : cells) {
+    cell = reader->Byte();
+  }
+
+  return cells;
+}
+
+// Returns null if the rules are cut off or can't describe a puzzle
+std::shared_ptr<const Variant> ReadVariant(SnapshotReader* reader) {
+  uint32_t is_classic = reader->Byte();
+  if (is_classic == 1) {
+    return Variant::GetClassic();
+  }
+  if (is_classic != 0) {
+    return nullptr;
+  }
+
+  VariantRules rules;
+  rules.groups.resize(reader->Byte());
+  for (auto& group : rules.groups) {
+    group = ReadCells(reader);
+  }
+
+  rules.cages.resize(reader->Byte());
+  for (Cage& cage : rules.cages) {
+    cage.sum = static_cast<int>(reader->Byte());
+    cage.cells = ReadCells(reader);
+  }
+
+  for (DigitMask& mask : rules.allowed) {
+    mask = static_cast<DigitMask>(reader->U16());
+  }
+
+  auto variant = std::make_shared<const Variant>(std::move(rules));
+  if (reader->Failed() || !variant->IsWellFormed()) {
+    return nullptr;
+  }
+
+  return variant;
+}
+
+void PutCells(std::string* out, const std::vector<size_t>& cells) {
+  PutByte(out, static_cast<uint32_t>(cells.size()));
+  for (size_t cell : cells) {
+    PutByte(out, static_cast<uint32_t>(cell));
+  }
+}
+
+void PutVariant(std::string* out, const Variant& variant) {
+  PutByte(out, variant.IsClassic() ? 1 : 0);
+  if (variant.IsClassic()) {
+    return;
+  }
+
+  // Well formed rules have at most a few dozen groups and one cage per box,
+  // with no more than kBoardSize boxes in each
+  const VariantRules& rules = variant.GetRules();
+  PutByte(out, static_cast<uint32_t>(rules.groups.size()));
+  for (const auto& group : rules.groups) {
+    PutCells(out, group);
+  }
+
+  PutByte(out, static_cast<uint32_t>(rules.cages.size()));
+  for (const Cage& cage : rules.cages) {
+    PutByte(out, static_cast<uint32_t>(cage.sum));
+    PutCells(out, cage.cells);
+  }
+
+  for (DigitMask mask : rules.allowed) {
+    PutU16(out, mask);
+  }
+}
+
+}  // namespace
+
+std::string Engine::SerializeSnapshot() const {
+  std::string out;
+  out.reserve(kMagicSize + 15 + 4 * clock_.GetSplits().size()
+              + board_path_.size() + 3 * kNumCells + 41 + 1 + 4);
+
+  out.append(kSnapshotMagic, kMagicSize);
+  PutU16(&out, kSnapshotVersion);
+  PutByte(&out, static_cast<uint32_t>(difficulty_));
+  PutByte(&out, static_cast<uint32_t>(game_mode_));
+  PutByte(&out, is_penciling_ ? 1 : 0);
+  PutU16(&out, static_cast<uint32_t>(games_completed_));
+  PutU32(&out, static_cast<uint32_t>(clock_.GetElapsed().count()));
+  PutByte(&out, clock_.IsPaused() ? 1 : 0);
+
+  const auto& splits = clock_.GetSplits();
+  size_t split_count = std::min<size_t>(splits.size(), 0xFF);
+  PutByte(&out, static_cast<uint32_t>(split_count));
+  for (size_t i = 0; i < split_count; i++) {
+    PutU32(&out, static_cast<uint32_t>(splits[i].count()));
+  }
+
+  // The puzzle id is the board's file name, which is always short
+  size_t id_length = std::min<size_t>(board_path_.size(), 0xFF);
+  PutByte(&out, static_cast<uint32_t>(id_length));
+  out.append(board_path_, 0, id_length);
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      PutByte(&out, static_cast<uint32_t>(current_entries_[row][col])
+                    | static_cast<uint32_t>(entry_states_[row][col]) << 4);
+    }
+  }
+
+  // Pack the solution two digits per byte
+  for (size_t cell = 0; cell < kNumCells; cell += 2) {
+    uint32_t low = static_cast<uint32_t>(
+        solution_[cell / kBoardSize][cell % kBoardSize]);
+    uint32_t high = 0;
+    if (cell + 1 < kNumCells) {
+      high = static_cast<uint32_t>(
+          solution_[(cell + 1) / kBoardSize][(cell + 1) % kBoardSize]);
+    }
+    PutByte(&out, low | high << 4);
+  }
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      uint32_t mask = 0;
+      for (size_t num = 0; num < kBoardSize; num++) {
+        if (pencil_marks_[row][col][num]) {
+          mask |= 1u << num;
+        }
+      }
+      PutU16(&out, mask);
+    }
+  }
+
+  PutVariant(&out, *variant_);
+
+  PutU32(&out, Checksum(out, out.size()));
+  return out;
+}
+
+bool Engine::DeserializeSnapshot(const std::string& data) {
+  constexpr size_t kChecksumSize = 4;
+  if (data.size() < kMagicSize + kChecksumSize
+      || data.compare(0, kMagicSize, kSnapshotMagic) != 0) {
+    return false;
+  }
+
+  size_t body_length = data.size() - kChecksumSize;
+  SnapshotReader checksum_reader(data, data.size());
+  checksum_reader.Skip(body_length);
+  if (checksum_reader.U32() != Checksum(data, body_length)) {
+    return false;
+  }
+
+  SnapshotReader reader(data, body_length);
+  reader.Skip(kMagicSize);
+  uint32_t version = reader.U16();
+  if (version < kSecondsSnapshotVersion || version > kSnapshotVersion) {
+    return false;
+  }
+
+  uint32_t difficulty = reader.Byte();
+  uint32_t mode = reader.Byte();
+  uint32_t penciling = reader.Byte();
+  uint32_t games_completed = reader.U16();
+  uint32_t game_time = reader.U32();
+  uint32_t clock_paused = 0;
+  std::vector<GameClock::Milliseconds> splits;
+
+  if (version == kSecondsSnapshotVersion) {
+    game_time *= 1000;
+  } else {
+    clock_paused = reader.Byte();
+    size_t split_count = reader.Byte();
+    for (size_t i = 0; i < split_count && !reader.Failed(); i++) {
+      splits.emplace_back(reader.U32());
+    }
+  }
+
+  if (difficulty > static_cast<uint32_t>(Difficulty::kHard)
+      || mode > static_cast<uint32_t>(GameMode::kDailyChallenge)
+      || penciling > 1
+      || clock_paused > 1) {
+    return false;
+  }
+
+  size_t id_length = reader.Byte();
+  if (reader.Failed() || reader.Position() + id_length > body_length) {
+    return false;
+  }
+  std::string board_path = data.substr(reader.Position(), id_length);
+  reader.Skip(id_length);
+
+  // A daily challenge's id says which day it's from
+  int64_t challenge_day = 0;
+  if (mode == static_cast<uint32_t>(GameMode::kDailyChallenge)
+      && !ParseChallengeId(board_path, &challenge_day)) {
+    return false;
+  }
+
+  // Decode into temporaries so a bad snapshot can't leave a half loaded game
+  array<array<int, kBoardSize>, kBoardSize> entries;
+  array<array<EntryState, kBoardSize>, kBoardSize> states;
+  array<array<int, kBoardSize>, kBoardSize> solution;
+  array<array<array<bool, kBoardSize>, kBoardSize>, kBoardSize> marks;
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      uint32_t cell = reader.Byte();
+      uint32_t state = cell >> 4;
+      if ((cell & 0xF) > kBoardSize
+          || state > static_cast<uint32_t>(EntryState::kWrong)) {
+        return false;
+      }
+
+      entries[row][col] = static_cast<int>(cell & 0xF);
+      states[row][col] = static_cast<EntryState>(state);
+    }
+  }
+
+  for (size_t cell = 0; cell < kNumCells; cell += 2) {
+    uint32_t digits = reader.Byte();
+    solution[cell / kBoardSize][cell % kBoardSize]
+        = static_cast<int>(digits & 0xF);
+    if (cell + 1 < kNumCells) {
+      solution[(cell + 1) / kBoardSize][(cell + 1) % kBoardSize]
+          = static_cast<int>(digits >> 4);
+    }
+  }
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      if (solution[row][col] < 1
+          || solution[row][col] > static_cast<int>(kBoardSize)) {
+        return false;
+      }
+
+      uint32_t mask = reader.U16();
+      for (size_t num = 0; num < kBoardSize; num++) {
+        marks[row][col][num] = (mask >> num & 1u) != 0;
+      }
+    }
+  }
+
+  std::shared_ptr<const Variant> variant = Variant::GetClassic();
+  if (version > kClassicSnapshotVersion) {
+    variant = ReadVariant(&reader);
+  }
+
+  // The solution has to follow the rules, or checking the board and hints
+  // would disagree with them
+  if (reader.Failed() || reader.Position() != body_length || !variant
+      || (!variant->IsClassic() && !variant->IsSolution(solution))) {
+    return false;
+  }
+
+  board_path_ = board_path;
+  difficulty_ = static_cast<Difficulty>(difficulty);
+  game_mode_ = static_cast<GameMode>(mode);
+  challenge_day_ = challenge_day;
+  is_penciling_ = penciling == 1;
+
+  // The grade isn't saved, since the day's puzzle can be made again
+  if (game_mode_ == GameMode::kDailyChallenge) {
+    Grid puzzle;
+    Grid challenge_solution;
+    GenerateDailyChallenge(challenge_day, &puzzle, &challenge_solution);
+    challenge_difficulty_ = GradeDifficulty(puzzle, challenge_solution);
+  }
+  games_completed_ = static_cast<int>(games_completed);
+  current_entries_ = entries;
+  entry_states_ = states;
+  solution_ = solution;
+  pencil_marks_ = marks;
+  variant_ = std::move(variant);
+
+  // The next board wasn't saved, so it's prepared when it's needed
+  next_board_ = {};
+
+  // Continue the timer from where the snapshot left off
+  clock_.Restore(GameClock::Milliseconds(game_time), splits, clock_paused == 1);
+
+  return true;
+}
+
+bool Engine::SaveSnapshot(const std::string& filepath) const {
+  // Written beside the old snapshot and renamed over it, so a crash while
+  // saving still leaves the last move's game to resume
+  return WriteFileAtomically(filepath, SerializeSnapshot());
+}
+
+bool Engine::LoadSnapshot(const std::string& filepath) {
+  std::ifstream infile(filepath, std::ios::binary);
+  if (!infile) {
+    return false;
+  }
+
+  const std::string data((std::istreambuf_iterator<char>(infile)),
+                         std::istreambuf_iterator<char>());
+
+  return DeserializeSnapshot(data);
+}
+
+}  // namespace sudoku
@@ -0,0 +1,396 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/solver.h>
+
+#include <sudoku/board.h>
+#include <sudoku/candidate_kernel.h>
+#include <sudoku/variant.h>
+
+#include <array>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+// Once singles are placed, every empty box has at least two candidates, so
+// there's no point looking for a better box to guess in than one with two
+constexpr size_t kMinGuesses = 2;
+
+// Place every naked and hidden single until none are left. Returns false if
+// the board turns out to have no solution
+bool Propagate(MaskBoard* board, CandidateScan* scan) {
+  while (true) {
+    ScanCandidates(*board, scan);
+    if (scan->is_contradiction) {
+      return false;
+    }
+
+    bool placed = false;
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        DigitMask single = scan->singles.cells[row][col];
+        if (single != 0) {
+          board->cells[row][col] = single;
+          placed = true;
+        }
+      }
+    }
+
+    if (!placed) {
+      return true;
+    }
+  }
+}
+
+// Depth-first search, guessing in the box with the fewest candidates. Stops
+// once `limit` solutions are found, leaving the last one in `solution`
+void Search(const MaskBoard& board, size_t limit, size_t* count,
+            MaskBoard* solution) {
+  MaskBoard current = board;
+  CandidateScan scan;
+  if (!Propagate(&current, &scan)) {
+    return;
+  }
+
+  size_t best_row = kBoardSize;
+  size_t best_col = kBoardSize;
+  size_t fewest = kBoardSize + 1;
+  for (size_t row = 0; row < kBoardSize && fewest > kMinGuesses; row++) {
+    for (size_t col = 0; col < kBoardSize && fewest > kMinGuesses; col++) {
+      size_t count_here = CountDigits(scan.candidates.cells[row][col]);
+      if (current.cells[row][col] == 0 && count_here < fewest) {
+        best_row = row;
+        best_col = col;
+        fewest = count_here;
+      }
+    }
+  }
+
+  if (best_row == kBoardSize) {
+    (*count)++;
+    *solution = current;
+    return;
+  }
+
+  DigitMask cands = scan.candidates.cells[best_row][best_col];
+  while (cands != 0 && *count < limit) {
+    auto guess = static_cast<DigitMask>(cands & -cands);
+    cands = static_cast<DigitMask>(cands & ~guess);
+
+    current.cells[best_row][best_col] = guess;
+    Search(current, limit, count, solution);
+  }
+}
+
+constexpr size_t kNumCells = kBoardSize * kBoardSize;
+constexpr size_t kNoBoard = static_cast<size_t>(-1);
+
+// One board being solved in a lane of SolveBatch. Guesses are tried depth
+// first in the same order as Search, so both find the same solution
+struct LaneSearch {
+  // Index of the board in the batch, or kNoBoard once the batch runs out
+  size_t board = kNoBoard;
+
+  // Boards still to try, with the next one at the back
+  std::vector<CellMasks> guesses;
+
+  // Put the next unstarted board of the batch in the lane, or an empty
+  // board with nothing to do if there are none left
+  void StartNextBoard(size_t lane, const std::vector<Grid>& boards,
+                      size_t* next_board, LaneBoards* lanes) {
+    board = *next_board < boards.size() ? (*next_board)++ : kNoBoard;
+
+    for (size_t cell = 0; cell < kNumCells; cell++) {
+      int num = board == kNoBoard
+                    ? 0 : boards[board][cell / kBoardSize][cell % kBoardSize];
+      lanes->cells[cell][lane] = num == 0 ? 0 : DigitBit(num);
+    }
+    lanes->contradictions[lane] = 0;
+  }
+
+  void LoadGuess(size_t lane, LaneBoards* lanes) {
+    for (size_t cell = 0; cell < kNumCells; cell++) {
+      lanes->cells[cell][lane] = guesses.back()[cell];
+    }
+    lanes->contradictions[lane] = 0;
+    guesses.pop_back();
+  }
+
+  // Queue up a guess for each candidate of the box with the fewest. Returns
+  // true instead if the lane's board is already solved
+  bool Branch(size_t lane, const LaneBoards& lanes) {
+    size_t best_cell = kNumCells;
+    size_t fewest = kBoardSize + 1;
+    for (size_t cell = 0; cell < kNumCells && fewest > kMinGuesses; cell++) {
+      if (lanes.cells[cell][lane] != 0) {
+        continue;
+      }
+
+      size_t count = CountDigits(lanes.candidates[cell][lane]);
+      if (count < fewest) {
+        best_cell = cell;
+        fewest = count;
+      }
+    }
+
+    if (best_cell == kNumCells) {
+      return true;
+    }
+
+    CellMasks current;
+    for (size_t cell = 0; cell < kNumCells; cell++) {
+      current[cell] = lanes.cells[cell][lane];
+    }
+
+    // Pushed highest first, so the lowest is tried first
+    DigitMask cands = lanes.candidates[best_cell][lane];
+    for (int num = static_cast<int>(kBoardSize); num > 0; num--) {
+      if ((cands & DigitBit(num)) != 0) {
+        current[best_cell] = DigitBit(num);
+        guesses.push_back(current);
+      }
+    }
+
+    return false;
+  }
+};
+
+// Fill in a box, unless a peer already holds the number, which happens when
+// two singles found in the same pass rule each other out
+bool PlaceVariantSingle(const Variant& variant, size_t cell, DigitMask single,
+                        CellMasks* placed) {
+  for (uint8_t peer : variant.GetPeers(cell)) {
+    if (((*placed)[peer] & single) != 0) {
+      return false;
+    }
+  }
+
+  (*placed)[cell] = single;
+  return true;
+}
+
+// Propagate for a variant, one box at a time through its peer table. Hidden
+// singles are only looked for in groups that hold every number. Leaves the
+// candidates of the final board in `candidates`
+bool PropagateVariant(const Variant& variant, CellMasks* placed,
+                      CellMasks* candidates) {
+  const auto& groups = variant.GetRules().groups;
+
+  while (true) {
+    if (!ComputeMaskCandidates(*placed, variant, candidates)) {
+      return false;
+    }
+
+    bool is_placed = false;
+    for (size_t cell = 0; cell < kNumCells; cell++) {
+      DigitMask mask = (*candidates)[cell];
+      if ((*placed)[cell] == 0 && CountDigits(mask) == 1) {
+        if (!PlaceVariantSingle(variant, cell, mask, placed)) {
+          return false;
+        }
+        is_placed = true;
+      }
+    }
+    if (is_placed) {
+      continue;
+    }
+
+    for (size_t group : variant.GetFullGroups()) {
+      DigitMask filled = 0;
+      DigitMask seen_once = 0;
+      DigitMask seen_twice = 0;
+      for (size_t cell : groups[group]) {
+        filled |= (*placed)[cell];
+        seen_twice = static_cast<DigitMask>(
+            seen_twice | (seen_once & (*candidates)[cell]));
+        seen_once |= (*candidates)[cell];
+      }
+
+      // A number the group is missing that no box can take
+      auto missing = static_cast<DigitMask>(kAllDigits & ~filled);
+      if ((seen_once & missing) != missing) {
+        return false;
+      }
+
+      auto hidden = static_cast<DigitMask>(seen_once & ~seen_twice);
+      for (size_t cell : groups[group]) {
+        auto single = static_cast<DigitMask>((*candidates)[cell] & hidden);
+        if (single == 0 || (*placed)[cell] != 0) {
+          continue;
+        }
+        if (CountDigits(single) > 1
+            || !PlaceVariantSingle(variant, cell, single, placed)) {
+          return false;
+        }
+        is_placed = true;
+      }
+    }
+
+    if (!is_placed) {
+      return true;
+    }
+  }
+}
+
+// Search for a variant, guessing in the same order as Search
+void SearchVariant(const Variant& variant, const CellMasks& board,
+                   size_t limit, size_t* count, CellMasks* solution) {
+  CellMasks current = board;
+  CellMasks candidates;
+  if (!PropagateVariant(variant, &current, &candidates)) {
+    return;
+  }
+
+  size_t best_cell = kNumCells;
+  size_t fewest = kBoardSize + 1;
+  for (size_t cell = 0; cell < kNumCells && fewest > kMinGuesses; cell++) {
+    size_t count_here = CountDigits(candidates[cell]);
+    if (current[cell] == 0 && count_here < fewest) {
+      best_cell = cell;
+      fewest = count_here;
+    }
+  }
+
+  if (best_cell == kNumCells) {
+    (*count)++;
+    *solution = current;
+    return;
+  }
+
+  DigitMask cands = candidates[best_cell];
+  while (cands != 0 && *count < limit) {
+    auto guess = static_cast<DigitMask>(cands & -cands);
+    cands = static_cast<DigitMask>(cands & ~guess);
+
+    current[best_cell] = guess;
+    SearchVariant(variant, current, limit, count, solution);
+  }
+}
+
+// Search a board for a variant, returning the number of solutions found and
+// leaving the last in `solution`. Givens that already break a rule have none
+size_t SearchVariantBoard(const Grid& board, const Variant& variant,
+                          size_t limit, CellMasks* solution) {
+  if (limit == 0 || variant.HasConflict(board)) {
+    return 0;
+  }
+
+  CellMasks placed;
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    int num = board[cell / kBoardSize][cell % kBoardSize];
+    placed[cell] = num == 0 ? 0 : DigitBit(num);
+  }
+
+  size_t count = 0;
+  SearchVariant(variant, placed, limit, &count, solution);
+  return count;
+}
+
+}  // namespace
+
+bool Solve(Grid* board) {
+  size_t count = 0;
+  MaskBoard solution;
+  Search(ToMaskBoard(*board), 1, &count, &solution);
+  if (count == 0) {
+    return false;
+  }
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      (*board)[row][col] = LowestDigit(solution.cells[row][col]);
+    }
+  }
+
+  return true;
+}
+
+size_t CountSolutions(const Grid& board, size_t limit) {
+  size_t count = 0;
+  MaskBoard solution;
+  if (limit > 0) {
+    Search(ToMaskBoard(board), limit, &count, &solution);
+  }
+
+  return count;
+}
+
+bool Solve(Grid* board, const Variant& variant) {
+  if (variant.IsClassic()) {
+    return Solve(board);
+  }
+
+  CellMasks solution;
+  if (SearchVariantBoard(*board, variant, 1, &solution) == 0) {
+    return false;
+  }
+
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    (*board)[cell / kBoardSize][cell % kBoardSize]
+        = LowestDigit(solution[cell]);
+  }
+
+  return true;
+}
+
+size_t CountSolutions(const Grid& board, size_t limit,
+                      const Variant& variant) {
+  if (variant.IsClassic()) {
+    return CountSolutions(board, limit);
+  }
+
+  CellMasks solution;
+  return SearchVariantBoard(board, variant, limit, &solution);
+}
+
+size_t SolveBatch(std::vector<Grid>* boards) {
+  LaneBoards lanes = LaneBoards{};
+  std::array<LaneSearch, kMaskLanes> searches;
+  size_t next_board = 0;
+  size_t num_solved = 0;
+
+  for (size_t lane = 0; lane < kMaskLanes; lane++) {
+    searches[lane].StartNextBoard(lane, *boards, &next_board, &lanes);
+  }
+
+  while (true) {
+    bool is_searching = false;
+    for (const auto& search : searches) {
+      is_searching |= search.board != kNoBoard;
+    }
+    if (!is_searching) {
+      break;
+    }
+
+    PropagateLanes(&lanes);
+
+    for (size_t lane = 0; lane < kMaskLanes; lane++) {
+      LaneSearch& search = searches[lane];
+      if (search.board == kNoBoard) {
+        continue;
+      }
+
+      if (lanes.contradictions[lane] == 0 && search.Branch(lane, lanes)) {
+        Grid& board = (*boards)[search.board];
+        for (size_t cell = 0; cell < kNumCells; cell++) {
+          board[cell / kBoardSize][cell % kBoardSize]
+              = LowestDigit(lanes.cells[cell][lane]);
+        }
+
+        num_solved++;
+        search.guesses.clear();
+      }
+
+      if (search.guesses.empty()) {
+        search.StartNextBoard(lane, *boards, &next_board, &lanes);
+      } else {
+        search.LoadGuess(lane, &lanes);
+      }
+    }
+  }
+
+  return num_solved;
+}
+
+}  // namespace sudoku
@@ -0,0 +1,38 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/transform.h>
+
+#include <sudoku/board.h>
+
+#include <numeric>
+
+namespace sudoku {
+
+BoardTransform IdentityTransform() {
+  BoardTransform transform;
+  std::iota(transform.num_map.begin(), transform.num_map.end(), 0);
+  std::iota(transform.row_order.begin(), transform.row_order.end(), 0);
+  std::iota(transform.col_order.begin(), transform.col_order.end(), 0);
+  transform.transpose = false;
+
+  return transform;
+}
+
+Grid ApplyTransform(const Grid& board, const BoardTransform& transform) {
+  Grid result;
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      int num = board[transform.row_order[row]][transform.col_order[col]];
+
+      if (transform.transpose) {
+        result[col][row] = transform.num_map[num];
+      } else {
+        result[row][col] = transform.num_map[num];
+      }
+    }
+  }
+
+  return result;
+}
+
+}  // namespace sudoku
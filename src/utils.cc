@@ -15,6 +15,8 @@
 
 #include "sudoku/utils.h"
 
+#include "sudoku/profiler.h"
+
 namespace sudoku {
 
 void DrawBox(std::pair<ci::vec2, ci::vec2> bounds, const ci::Color& color) {
@@ -28,6 +30,7 @@ void DrawBox(std::pair<ci::vec2, ci::vec2> bounds, const ci::Color& color) {
 
   box.close();
   ci::gl::draw(box);
+  CountDrawCall();
 }
 
 void DrawLine(float x1, float y1, float x2, float y2, const ci::Color& color) {
@@ -38,6 +41,7 @@ void DrawLine(float x1, float y1, float x2, float y2, const ci::Color& color) {
   line.lineTo(x2, y2);
   line.close();
   ci::gl::draw(line);
+  CountDrawCall();
 }
 
 ci::vec2 GetMiddleOfBox(std::pair<ci::vec2, ci::vec2> box) {
@@ -56,4 +60,11 @@ bool IsMouseInBox(const ci::vec2& mouse_pos,
          && mouse_pos.y < box_bounds.second.y;
 }
 
+std::string FormatGameTime(size_t milliseconds) {
+  std::string millis = std::to_string(milliseconds % 1000);
+  millis.insert(0, 3 - millis.length(), '0');
+
+  return std::to_string(milliseconds / 1000) + "." + millis;
+}
+
 }
\ No newline at end of file
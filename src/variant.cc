@@ -0,0 +1,408 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+#include <sudoku/variant.h>
+
+#include <sudoku/board.h>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <utility>
+#include <vector>
+
+namespace sudoku {
+
+namespace {
+
+constexpr size_t kNumCells = kBoardSize * kBoardSize;
+
+// Sum of the numbers in each set
+std::array<int, kAllDigits + 1> MakeDigitSums() {
+  std::array<int, kAllDigits + 1> sums{};
+  for (size_t mask = 1; mask <= kAllDigits; mask++) {
+    for (int num = 1; num <= static_cast<int>(kBoardSize); num++) {
+      if ((mask & DigitBit(num)) != 0) {
+        sums[mask] += num;
+      }
+    }
+  }
+
+  return sums;
+}
+
+const std::array<int, kAllDigits + 1>& GetDigitSums() {
+  static const std::array<int, kAllDigits + 1> sums = MakeDigitSums();
+  return sums;
+}
+
+// Groups with their boxes in order, themselves in order, so the same rules
+// compare equal however they were written
+std::vector<std::vector<size_t>> SortGroups(
+    std::vector<std::vector<size_t>> groups) {
+  for (auto& group : groups) {
+    std::sort(group.begin(), group.end());
+  }
+  std::sort(groups.begin(), groups.end());
+
+  return groups;
+}
+
+bool AreCellsValid(const std::vector<size_t>& cells) {
+  std::bitset<kNumCells> seen;
+  for (size_t cell : cells) {
+    if (cell >= kNumCells || seen[cell]) {
+      return false;
+    }
+    seen[cell] = true;
+  }
+
+  return cells.size() <= kBoardSize;
+}
+
+bool AreRulesValid(const VariantRules& rules) {
+  for (const auto& group : rules.groups) {
+    if (!AreCellsValid(group)) {
+      return false;
+    }
+  }
+
+  for (const Cage& cage : rules.cages) {
+    if (cage.cells.empty() || !AreCellsValid(cage.cells)
+        || GetCageDigits(cage.cells.size(), cage.sum, kAllDigits) == 0) {
+      return false;
+    }
+  }
+
+  return std::all_of(rules.allowed.begin(), rules.allowed.end(),
+                     [](DigitMask mask) {
+                       return mask != 0 && (mask & ~kAllDigits) == 0;
+                     });
+}
+
+}  // namespace
+
+VariantRules ClassicRules() {
+  VariantRules rules;
+  for (const Unit& unit : GetUnits()) {
+    std::vector<size_t> group;
+    for (const auto& box : unit) {
+      group.push_back(box.first * kBoardSize + box.second);
+    }
+    rules.groups.push_back(group);
+  }
+  rules.allowed.fill(kAllDigits);
+
+  return rules;
+}
+
+VariantRules DiagonalRules() {
+  VariantRules rules = ClassicRules();
+  std::vector<size_t> down;
+  std::vector<size_t> up;
+  for (size_t i = 0; i < kBoardSize; i++) {
+    down.push_back(i * kBoardSize + i);
+    up.push_back(i * kBoardSize + (kBoardSize - 1 - i));
+  }
+  rules.groups.push_back(down);
+  rules.groups.push_back(up);
+
+  return rules;
+}
+
+VariantRules JigsawRules(const std::array<size_t, kNumCells>& regions) {
+  VariantRules rules = ClassicRules();
+
+  // Rows and columns come first in the classic units
+  rules.groups.resize(2 * kBoardSize);
+  std::vector<std::vector<size_t>> region_groups(kBoardSize);
+  bool has_stray = false;
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    if (regions[cell] < kBoardSize) {
+      region_groups[regions[cell]].push_back(cell);
+    } else {
+      has_stray = true;
+    }
+  }
+  rules.groups.insert(rules.groups.end(), region_groups.begin(),
+                      region_groups.end());
+
+  // A group off the board, so IsWellFormed rejects a box with no region
+  if (has_stray) {
+    rules.groups.push_back({kNumCells});
+  }
+
+  return rules;
+}
+
+VariantRules KillerRules(std::vector<Cage> cages) {
+  VariantRules rules = ClassicRules();
+  rules.cages = std::move(cages);
+
+  return rules;
+}
+
+Variant::Variant(VariantRules rules) : rules_{std::move(rules)} {
+  static const std::vector<std::vector<size_t>> classic_groups
+      = SortGroups(ClassicRules().groups);
+
+  is_classic_ = rules_.cages.empty()
+                && std::all_of(rules_.allowed.begin(), rules_.allowed.end(),
+                               [](DigitMask mask) {
+                                 return mask == kAllDigits;
+                               })
+                && SortGroups(rules_.groups) == classic_groups;
+  is_well_formed_ = AreRulesValid(rules_);
+
+  std::array<std::bitset<kNumCells>, kNumCells> peers;
+  auto add_peers = [&peers](const std::vector<size_t>& cells) {
+    for (size_t first : cells) {
+      for (size_t second : cells) {
+        if (first != second && first < kNumCells && second < kNumCells) {
+          peers[first][second] = true;
+        }
+      }
+    }
+  };
+
+  for (size_t i = 0; i < rules_.groups.size(); i++) {
+    add_peers(rules_.groups[i]);
+    if (rules_.groups[i].size() == kBoardSize) {
+      full_groups_.push_back(i);
+    }
+  }
+  for (size_t i = 0; i < rules_.cages.size(); i++) {
+    add_peers(rules_.cages[i].cells);
+    for (size_t cell : rules_.cages[i].cells) {
+      if (cell < kNumCells) {
+        cell_cages_[cell].push_back(i);
+      }
+    }
+  }
+
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    for (size_t peer = 0; peer < kNumCells; peer++) {
+      if (peers[cell][peer]) {
+        peers_[cell].push_back(static_cast<uint8_t>(peer));
+      }
+    }
+  }
+}
+
+std::shared_ptr<const Variant> Variant::GetClassic() {
+  static const std::shared_ptr<const Variant> classic
+      = std::make_shared<const Variant>(ClassicRules());
+  return classic;
+}
+
+const VariantRules& Variant::GetRules() const {
+  return rules_;
+}
+
+bool Variant::IsClassic() const {
+  return is_classic_;
+}
+
+bool Variant::IsWellFormed() const {
+  return is_well_formed_;
+}
+
+const std::vector<uint8_t>& Variant::GetPeers(size_t cell) const {
+  return peers_[cell];
+}
+
+const std::vector<size_t>& Variant::GetFullGroups() const {
+  return full_groups_;
+}
+
+const std::vector<size_t>& Variant::GetCellCages(size_t cell) const {
+  return cell_cages_[cell];
+}
+
+bool Variant::HasConflict(const Grid& entries) const {
+  if (!is_well_formed_) {
+    return true;
+  }
+
+  auto get_entry = [&entries](size_t cell) {
+    return entries[cell / kBoardSize][cell % kBoardSize];
+  };
+
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    const int num = get_entry(cell);
+    if (num == 0) {
+      continue;
+    }
+    if (num < 0 || num > static_cast<int>(kBoardSize)
+        || (rules_.allowed[cell] & DigitBit(num)) == 0) {
+      return true;
+    }
+
+    for (uint8_t peer : peers_[cell]) {
+      if (peer > cell && get_entry(peer) == num) {
+        return true;
+      }
+    }
+  }
+
+  for (const Cage& cage : rules_.cages) {
+    int sum = 0;
+    bool is_full = true;
+    for (size_t cell : cage.cells) {
+      sum += get_entry(cell);
+      is_full &= get_entry(cell) != 0;
+    }
+
+    if (sum > cage.sum || (is_full && sum != cage.sum)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Variant::IsInConflict(const Grid& entries, size_t cell) const {
+  auto get_entry = [&entries](size_t box) {
+    return entries[box / kBoardSize][box % kBoardSize];
+  };
+
+  const int num = get_entry(cell);
+  if (num == 0) {
+    return false;
+  }
+  if (!is_well_formed_ || num < 0 || num > static_cast<int>(kBoardSize)
+      || (rules_.allowed[cell] & DigitBit(num)) == 0) {
+    return true;
+  }
+
+  for (uint8_t peer : peers_[cell]) {
+    if (get_entry(peer) == num) {
+      return true;
+    }
+  }
+
+  for (size_t index : cell_cages_[cell]) {
+    const Cage& cage = rules_.cages[index];
+    int sum = 0;
+    bool is_full = true;
+    for (size_t box : cage.cells) {
+      sum += get_entry(box);
+      is_full &= get_entry(box) != 0;
+    }
+
+    if (sum > cage.sum || (is_full && sum != cage.sum)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Variant::IsSolution(const Grid& board) const {
+  for (const auto& row : board) {
+    for (int num : row) {
+      if (num == 0) {
+        return false;
+      }
+    }
+  }
+
+  return !HasConflict(board);
+}
+
+CandidateGrid ComputeCandidates(const Grid& entries, const Variant& variant) {
+  if (variant.IsClassic()) {
+    return ComputeCandidates(entries);
+  }
+
+  CellMasks placed;
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    const int num = entries[cell / kBoardSize][cell % kBoardSize];
+    placed[cell] = num == 0 ? 0 : DigitBit(num);
+  }
+
+  CellMasks masks;
+  ComputeMaskCandidates(placed, variant, &masks);
+
+  CandidateGrid candidates;
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    candidates[cell / kBoardSize][cell % kBoardSize] = masks[cell];
+  }
+
+  return candidates;
+}
+
+bool ComputeMaskCandidates(const CellMasks& placed, const Variant& variant,
+                           CellMasks* candidates) {
+  const VariantRules& rules = variant.GetRules();
+  if (!variant.IsWellFormed()) {
+    candidates->fill(0);
+    return false;
+  }
+
+  bool is_possible = true;
+
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    if (placed[cell] != 0) {
+      (*candidates)[cell] = 0;
+      continue;
+    }
+
+    DigitMask used = 0;
+    for (uint8_t peer : variant.GetPeers(cell)) {
+      used |= placed[peer];
+    }
+    (*candidates)[cell] = static_cast<DigitMask>(rules.allowed[cell] & ~used);
+  }
+
+  // Each cage's empty boxes can only hold numbers that make up what's left
+  // of its sum
+  const auto& sums = GetDigitSums();
+  for (const Cage& cage : rules.cages) {
+    DigitMask used = 0;
+    size_t empty_count = 0;
+    for (size_t cell : cage.cells) {
+      used |= placed[cell];
+      empty_count += placed[cell] == 0 ? 1 : 0;
+    }
+
+    const int left = cage.sum - sums[used];
+    if (empty_count == 0) {
+      is_possible &= left == 0;
+      continue;
+    }
+
+    const DigitMask digits = GetCageDigits(
+        empty_count, left, static_cast<DigitMask>(kAllDigits & ~used));
+    for (size_t cell : cage.cells) {
+      (*candidates)[cell] &= digits;
+    }
+  }
+
+  for (size_t cell = 0; cell < kNumCells; cell++) {
+    is_possible &= placed[cell] != 0 || (*candidates)[cell] != 0;
+  }
+
+  return is_possible;
+}
+
+DigitMask GetCageDigits(size_t count, int sum, DigitMask available) {
+  const auto& sums = GetDigitSums();
+  DigitMask digits = 0;
+
+  // Every subset of the available numbers, down to the empty one
+  available &= kAllDigits;
+  DigitMask subset = available;
+  while (true) {
+    if (sums[subset] == sum && CountDigits(subset) == count) {
+      digits |= subset;
+    }
+    if (subset == 0) {
+      break;
+    }
+    subset = static_cast<DigitMask>((subset - 1) & available);
+  }
+
+  return digits;
+}
+
+}  // namespace sudoku
@@ -4,16 +4,57 @@
 
 #include <cinder/Vector.h>
 
+#include <sudoku/board_bank.h>
+#include <sudoku/candidate_kernel.h>
+#include <sudoku/canonical.h>
+#include <sudoku/daily_challenge.h>
 #include <sudoku/engine.h>
+#include <sudoku/generator.h>
+#include <sudoku/layout.h>
+#include <sudoku/leaderboard.h>
+#include <sudoku/leaderboard_archive.h>
+#include <sudoku/leaderboard_client.h>
+#include <sudoku/leaderboard_protocol.h>
+#include <sudoku/leaderboard_server.h>
+#include <sudoku/log_leaderboard.h>
+#include <sudoku/profiler.h>
+#include <sudoku/random.h>
+#include <sudoku/sharded_leaderboard.h>
+#include <sudoku/skiplist.h>
+#include <sudoku/solver.h>
+#include <sudoku/transform.h>
 #include <sudoku/utils.h>
+#include <sudoku/variant.h>
 
 #include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using Difficulty = sudoku::Engine::Difficulty;
 using EntryState = sudoku::Engine::EntryState;
 using GameMode = sudoku::Engine::GameMode;
 using sudoku::kBoardSize;
 
+using sudoku::FormatGameTime;
+using sudoku::GameClock;
 using sudoku::GetMiddleOfBox;
 using sudoku::IsMouseInBox;
 
@@ -41,6 +82,67 @@ TEST_CASE("Check if mouse is in a given box", "[utils]") {
   }
 }
 
+TEST_CASE("Format game times", "[utils]") {
+  REQUIRE(FormatGameTime(0) == "0.000");
+  REQUIRE(FormatGameTime(61025) == "61.025");
+  REQUIRE(FormatGameTime(1500) == "1.500");
+}
+
+TEST_CASE("Game clock", "[clock]") {
+  GameClock clock;
+
+  SECTION("Stopped until started") {
+    REQUIRE(clock.IsPaused());
+    REQUIRE(clock.GetElapsed().count() == 0);
+  }
+
+  SECTION("Counts while running") {
+    clock.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    REQUIRE(clock.GetElapsed().count() >= 20);
+  }
+
+  SECTION("Doesn't count while paused") {
+    clock.Start();
+    clock.Pause();
+    GameClock::Milliseconds paused_at = clock.GetElapsed();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    REQUIRE(clock.GetElapsed() == paused_at);
+
+    clock.Resume();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    REQUIRE(clock.GetElapsed() > paused_at);
+  }
+
+  SECTION("Split times add up to the elapsed time") {
+    clock.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    clock.Split();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    clock.Split();
+    clock.Pause();
+
+    REQUIRE(clock.GetSplits().size() == 2);
+    REQUIRE(clock.GetSplits()[0].count() >= 5);
+    REQUIRE((clock.GetSplits()[0] + clock.GetSplits()[1]).count()
+            <= clock.GetElapsed().count());
+  }
+
+  SECTION("Restore") {
+    clock.Restore(GameClock::Milliseconds(5000),
+                  {GameClock::Milliseconds(2000)},
+                  true);
+    clock.Resume();
+    clock.Split();
+
+    REQUIRE(clock.GetElapsed().count() >= 5000);
+    REQUIRE(clock.GetSplits()[1].count() >= 3000);
+  }
+}
+
 TEST_CASE("Check if a number is penciled in a box", "[engine][pencil]") {
   sudoku::Engine engine;
   engine.CreateGame("test_board.json");
@@ -175,10 +277,21 @@ TEST_CASE("Check board", "[engine]") {
 
   SECTION("Wrong entry") {
     engine.SetEntry({0, 0}, 1);
+    engine.SetEntry({0, 4}, 1);
 
     engine.CheckBoard();
 
+    // Both sides of a clash are marked
     REQUIRE(engine.GetEntryState({0, 0}) == EntryState::kWrong);
+    REQUIRE(engine.GetEntryState({0, 4}) == EntryState::kWrong);
+  }
+
+  SECTION("Entries are checked against the rules, not one solution") {
+    engine.SetEntry({0, 0}, 1);
+
+    engine.CheckBoard();
+
+    REQUIRE(engine.GetEntryState({0, 0}) == EntryState::kCorrect);
   }
 
   SECTION("Correct entry") {
@@ -213,4 +326,2820 @@ TEST_CASE("Check if game is over", "[engine]") {
 
     REQUIRE(engine.IsGameOver());
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Save and restore snapshots", "[engine][snapshot]") {
+  sudoku::Engine engine;
+  engine.CreateGame("test_board.json");
+  engine.StartClock();
+  engine.SetGameMode(GameMode::kTimeTrial);
+  engine.SetDifficulty(Difficulty::kHard);
+  engine.IncreaseGamesCompleted();
+  engine.SetEntry({0, 0}, 1);
+  engine.SetEntry({8, 0}, 1);
+  engine.CheckBoard();
+  engine.ChangePencilMark({0, 1}, 3);
+  engine.ChangePencilMark({0, 1}, 9);
+  engine.SwitchEntryMode();
+  engine.PauseClock();
+
+  SECTION("Round trip") {
+    sudoku::Engine restored;
+    REQUIRE(restored.DeserializeSnapshot(engine.SerializeSnapshot()));
+
+    REQUIRE(restored.GetGameMode() == GameMode::kTimeTrial);
+    REQUIRE(restored.GetDifficulty() == Difficulty::kHard);
+    REQUIRE(restored.GetGamesCompleted() == 1);
+    REQUIRE(restored.IsPenciling());
+    REQUIRE(restored.GetEntry({0, 0}) == 1);
+    REQUIRE(restored.GetEntryState({0, 0}) == EntryState::kWrong);
+    REQUIRE(restored.IsPenciled({0, 1}, 3));
+    REQUIRE(restored.IsPenciled({0, 1}, 9));
+    REQUIRE(!restored.IsPenciled({0, 1}, 4));
+    REQUIRE(restored.IsClockPaused());
+    REQUIRE(restored.GetGameTime() == engine.GetGameTime());
+    REQUIRE(restored.GetSplitTimes().size() == 1);
+
+    // The solution comes back too, so the restored game can still be checked
+    restored.FillInCorrectEntry({0, 0});
+    REQUIRE(restored.GetEntry({0, 0}) == 6);
+  }
+
+  SECTION("Corrupt snapshot is rejected") {
+    std::string data = engine.SerializeSnapshot();
+    data[data.size() / 2] ^= 0x1;
+
+    sudoku::Engine restored;
+    restored.CreateGame("test_board.json");
+
+    REQUIRE(!restored.DeserializeSnapshot(data));
+    REQUIRE(restored.GetEntry({0, 0}) == 0);
+  }
+
+  SECTION("Truncated snapshot is rejected") {
+    std::string data = engine.SerializeSnapshot();
+
+    sudoku::Engine restored;
+    REQUIRE(!restored.DeserializeSnapshot(data.substr(0, data.size() - 10)));
+  }
+
+  SECTION("Saving replaces the old snapshot whole") {
+    const std::string path = "test_snapshot.bin";
+    {
+      std::ofstream old_file(path, std::ios::binary);
+      old_file << "an older, longer snapshot that should be gone";
+    }
+
+    REQUIRE(engine.SaveSnapshot(path));
+    REQUIRE(!std::ifstream(path + ".tmp"));
+    sudoku::Engine restored;
+    REQUIRE(restored.LoadSnapshot(path));
+    REQUIRE(restored.GetEntry({0, 0}) == 1);
+
+    // A save that can't be written leaves nothing behind
+    REQUIRE(!engine.SaveSnapshot("no_such_directory/" + path));
+    REQUIRE(restored.LoadSnapshot(path));
+    std::remove(path.c_str());
+  }
+}
+
+TEST_CASE("Hints", "[engine][hint]") {
+  // This board can be solved using only singles
+  sudoku::Engine engine;
+  engine.CreateGame("easy_1.json");
+
+  SECTION("Wrong entries are pointed out first") {
+    engine.SetEntry({0, 0}, 1);
+
+    sudoku::Hint hint = engine.GetHint();
+
+    REQUIRE(hint.technique == sudoku::Technique::kIncorrectEntry);
+    REQUIRE(hint.entry == std::make_pair(0, 0));
+    REQUIRE(hint.num == 6);
+  }
+
+  SECTION("Last empty box is a full house") {
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        engine.FillInCorrectEntry({row, col});
+      }
+    }
+    engine.SetEntry({8, 8}, 0);
+
+    sudoku::Hint hint = engine.GetHint();
+
+    REQUIRE(hint.technique == sudoku::Technique::kFullHouse);
+    REQUIRE(hint.entry == std::make_pair(8, 8));
+  }
+
+  SECTION("Following hints solves the board") {
+    for (size_t step = 0; step < kBoardSize * kBoardSize; step++) {
+      sudoku::Hint hint = engine.GetHint();
+      if (hint.technique == sudoku::Technique::kNone) {
+        break;
+      }
+
+      REQUIRE(hint.technique != sudoku::Technique::kIncorrectEntry);
+      REQUIRE(hint.technique != sudoku::Technique::kSolution);
+      engine.FillInCorrectEntry(hint.entry);
+    }
+    engine.CheckBoard();
+
+    REQUIRE(engine.IsGameOver());
+  }
+
+  SECTION("Pencil marks without the right number are ignored") {
+    engine.ChangePencilMark({0, 0}, 1);
+
+    sudoku::Hint hint = engine.GetHint();
+
+    REQUIRE(hint.technique != sudoku::Technique::kSolution);
+  }
+}
+
+TEST_CASE("Canonical forms", "[canonical]") {
+  sudoku::Grid board = {{{0, 0, 0, 7, 1, 0, 0, 0, 8},
+                         {1, 0, 0, 0, 5, 8, 6, 0, 9},
+                         {0, 0, 0, 0, 0, 0, 0, 2, 4},
+                         {0, 0, 0, 4, 7, 0, 8, 9, 0},
+                         {0, 5, 6, 8, 0, 1, 0, 0, 7},
+                         {0, 8, 0, 6, 0, 0, 0, 1, 5},
+                         {0, 0, 0, 9, 0, 6, 0, 8, 1},
+                         {8, 0, 1, 0, 0, 7, 0, 0, 2},
+                         {9, 6, 7, 1, 8, 0, 0, 4, 0}}};
+
+  // Relabel the numbers, swap the first two bands, swap two columns in a
+  // stack, then transpose
+  sudoku::Grid variant;
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      size_t source_row = row < 6 ? (row + 3) % 6 : row;
+      size_t source_col = col == 7 ? 8 : (col == 8 ? 7 : col);
+      int num = board[source_row][source_col];
+      variant[col][row] = num == 0 ? 0 : num % 9 + 1;
+    }
+  }
+
+  SECTION("Variants share a canonical form") {
+    REQUIRE(sudoku::GetCanonicalForm(board)
+            == sudoku::GetCanonicalForm(variant));
+  }
+
+  SECTION("Different puzzles have different forms") {
+    sudoku::Grid other = board;
+    other[0][0] = 2;
+
+    REQUIRE(sudoku::GetCanonicalForm(board)
+            != sudoku::GetCanonicalForm(other));
+  }
+
+  SECTION("Index rejects variants") {
+    sudoku::PuzzleIndex index;
+
+    REQUIRE(index.Insert(board));
+    REQUIRE(!index.Insert(variant));
+    REQUIRE(index.Contains(variant));
+    REQUIRE(index.Size() == 1);
+  }
+
+  SECTION("Empty board") {
+    sudoku::Grid empty{};
+
+    REQUIRE(sudoku::GetCanonicalForm(empty) == empty);
+  }
+}
+
+TEST_CASE("Boards aren't repeated until all have been played", "[engine]") {
+  sudoku::Engine engine;
+  sudoku::PuzzleIndex served;
+
+  for (size_t game = 0; game < 3; game++) {
+    engine.CreateGame();
+
+    sudoku::Grid board;
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        board[row][col] = engine.GetEntry({row, col});
+      }
+    }
+
+    REQUIRE(served.Insert(board));
+  }
+}
+
+TEST_CASE("Seeded engines deal the same boards", "[engine]") {
+  auto deal = [](sudoku::Engine* engine) {
+    std::vector<sudoku::Grid> boards;
+    for (size_t game = 0; game < 3; game++) {
+      engine->CreateGame();
+
+      sudoku::Grid board;
+      for (size_t row = 0; row < kBoardSize; row++) {
+        for (size_t col = 0; col < kBoardSize; col++) {
+          board[row][col] = engine->GetEntry({row, col});
+        }
+      }
+      boards.push_back(board);
+    }
+
+    return boards;
+  };
+
+  sudoku::Engine engine(7);
+  sudoku::Engine same_seed(7);
+  sudoku::Engine other_seed(8);
+  const auto boards = deal(&engine);
+  REQUIRE(deal(&same_seed) == boards);
+  REQUIRE(deal(&other_seed) != boards);
+
+  // Engines made at the same moment still get their own seeds
+  sudoku::Engine first;
+  sudoku::Engine second;
+  REQUIRE(deal(&first) != deal(&second));
+}
+
+TEST_CASE("Next boards of timed games", "[engine]") {
+  sudoku::Engine engine;
+
+  SECTION("Standard games have no next board") {
+    engine.CreateGame();
+
+    REQUIRE(!engine.HasNextBoard());
+  }
+
+  SECTION("Time Attack goes up a difficulty each board") {
+    engine.SetGameMode(sudoku::Engine::GameMode::kTimeAttack);
+    engine.CreateGame();
+    REQUIRE(engine.HasNextBoard());
+
+    sudoku::PuzzleIndex served;
+    sudoku::Grid board;
+    for (int game = 0; game < sudoku::Engine::kBoardsPerTimedGame; game++) {
+      if (game > 0) {
+        engine.IncreaseGamesCompleted();
+        engine.StartNextBoard();
+      }
+
+      for (size_t row = 0; row < kBoardSize; row++) {
+        for (size_t col = 0; col < kBoardSize; col++) {
+          board[row][col] = engine.GetEntry({row, col});
+        }
+      }
+      REQUIRE(served.Insert(board));
+    }
+
+    REQUIRE(engine.GetDifficulty() == sudoku::Engine::Difficulty::kHard);
+
+    // The last board has nothing after it
+    REQUIRE(!engine.HasNextBoard());
+  }
+
+  SECTION("Time Trial keeps the difficulty") {
+    engine.SetGameMode(sudoku::Engine::GameMode::kTimeTrial);
+    engine.SetDifficulty(sudoku::Engine::Difficulty::kMedium);
+    engine.CreateGame();
+    engine.IncreaseGamesCompleted();
+    engine.StartNextBoard();
+
+    REQUIRE(engine.GetDifficulty() == sudoku::Engine::Difficulty::kMedium);
+    REQUIRE(engine.HasNextBoard());
+  }
+
+  SECTION("Switching boards isn't timed") {
+    engine.SetGameMode(sudoku::Engine::GameMode::kTimeTrial);
+    engine.CreateGame();
+    engine.StartClock();
+    engine.PauseClock();
+    engine.IncreaseGamesCompleted();
+    engine.StartNextBoard();
+
+    // A paused clock stays paused, and a running one keeps running
+    REQUIRE(engine.IsClockPaused());
+    engine.ResumeClock();
+    engine.StartNextBoard();
+    REQUIRE(!engine.IsClockPaused());
+  }
+
+  SECTION("Abandoned next boards aren't counted as played") {
+    // Three boards of each difficulty, so a burned one would bring a
+    // repeat within three games
+    for (uint64_t seed = 0; seed < 20; seed++) {
+      sudoku::Engine seeded(seed);
+      seeded.SetGameMode(sudoku::Engine::GameMode::kTimeTrial);
+      sudoku::PuzzleIndex served;
+      sudoku::Grid board;
+      for (int game = 0; game < 3; game++) {
+        seeded.CreateGame();
+        seeded.SetGameMode(sudoku::Engine::GameMode::kStandard);
+        for (size_t row = 0; row < kBoardSize; row++) {
+          for (size_t col = 0; col < kBoardSize; col++) {
+            board[row][col] = seeded.GetEntry({row, col});
+          }
+        }
+        REQUIRE(served.Insert(board));
+      }
+    }
+  }
+
+  SECTION("Restored games prepare the next board when it's needed") {
+    engine.SetGameMode(sudoku::Engine::GameMode::kTimeAttack);
+    engine.CreateGame();
+    engine.StartClock();
+
+    sudoku::Engine restored;
+    REQUIRE(restored.DeserializeSnapshot(engine.SerializeSnapshot()));
+    REQUIRE(!restored.HasNextBoard());
+
+    restored.IncreaseGamesCompleted();
+    restored.StartNextBoard();
+    REQUIRE(restored.GetDifficulty() == sudoku::Engine::Difficulty::kMedium);
+    REQUIRE(restored.HasNextBoard());
+  }
+}
+
+TEST_CASE("Symmetry transforms", "[transform]") {
+  sudoku::Engine engine;
+  engine.CreateGame("easy_1.json");
+  engine.CheckBoard();
+
+  sudoku::Grid board;
+  sudoku::Grid solution;
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      board[row][col] = engine.GetEntry({row, col});
+      engine.FillInCorrectEntry({row, col});
+      solution[row][col] = engine.GetEntry({row, col});
+    }
+  }
+
+  std::mt19937 rng(126);
+  sudoku::BoardTransform transform = sudoku::RandomTransform(&rng);
+  sudoku::Grid new_board = sudoku::ApplyTransform(board, transform);
+  sudoku::Grid new_solution = sudoku::ApplyTransform(solution, transform);
+
+  SECTION("Identity leaves the board alone") {
+    REQUIRE(sudoku::ApplyTransform(board, sudoku::IdentityTransform())
+            == board);
+  }
+
+  SECTION("Solution is still valid") {
+    for (const auto& unit : sudoku::GetUnits()) {
+      sudoku::DigitMask seen = 0;
+      for (const auto& pos : unit) {
+        seen |= sudoku::DigitBit(new_solution[pos.first][pos.second]);
+      }
+
+      REQUIRE(seen == sudoku::kAllDigits);
+    }
+  }
+
+  SECTION("Givens still match the solution") {
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        if (new_board[row][col] != 0) {
+          REQUIRE(new_board[row][col] == new_solution[row][col]);
+        }
+      }
+    }
+  }
+
+  SECTION("Transformed board is the same puzzle") {
+    REQUIRE(sudoku::GetCanonicalForm(new_board)
+            == sudoku::GetCanonicalForm(board));
+  }
+}
+
+// The puzzle loaded into the engine, and its solution
+void GetBoards(const sudoku::Engine& engine, sudoku::Grid* board,
+               sudoku::Grid* solution) {
+  sudoku::Engine solved = engine;
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      (*board)[row][col] = engine.GetEntry({row, col});
+      solved.FillInCorrectEntry({row, col});
+      (*solution)[row][col] = solved.GetEntry({row, col});
+    }
+  }
+}
+
+TEST_CASE("Candidate kernel", "[kernel]") {
+  std::vector<sudoku::Grid> boards;
+  for (const char* file : {"easy_1.json", "easy_2.json", "medium_1.json",
+                           "hard_1.json", "hard_3.json", "test_board.json"}) {
+    sudoku::Engine engine;
+    engine.CreateGame(file);
+
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+    boards.push_back(board);
+
+    // Part way through, and with a mistake
+    for (size_t row = 0; row < 4; row++) {
+      board[row] = solution[row];
+    }
+    boards.push_back(board);
+    board[5][5] = board[5][5] % 9 + 1;
+    boards.push_back(board);
+  }
+
+  const sudoku::KernelIsa best = sudoku::GetBestKernelIsa();
+
+  SECTION("Every instruction set gives the same results") {
+    for (const auto& board : boards) {
+      sudoku::MaskBoard placed = sudoku::ToMaskBoard(board);
+
+      sudoku::SetKernelIsa(sudoku::KernelIsa::kScalar);
+      sudoku::CandidateScan expected;
+      sudoku::ScanCandidates(placed, &expected);
+
+      for (auto isa : {sudoku::KernelIsa::kSse41, sudoku::KernelIsa::kAvx2}) {
+        sudoku::SetKernelIsa(isa);
+        sudoku::CandidateScan scan;
+        sudoku::ScanCandidates(placed, &scan);
+
+        REQUIRE(scan.candidates.cells == expected.candidates.cells);
+        REQUIRE(scan.singles.cells == expected.singles.cells);
+        REQUIRE(scan.is_contradiction == expected.is_contradiction);
+      }
+    }
+  }
+
+  SECTION("Singles are placed correctly") {
+    sudoku::Engine engine;
+    engine.CreateGame("easy_1.json");
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+
+    sudoku::CandidateScan scan;
+    sudoku::ScanCandidates(sudoku::ToMaskBoard(board), &scan);
+
+    REQUIRE_FALSE(scan.is_contradiction);
+    size_t num_singles = 0;
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        sudoku::DigitMask single = scan.singles.cells[row][col];
+        if (single != 0) {
+          num_singles++;
+          REQUIRE(single == sudoku::DigitBit(solution[row][col]));
+        }
+      }
+    }
+    REQUIRE(num_singles > 0);
+  }
+
+  SECTION("Repeated numbers are contradictions") {
+    sudoku::Grid board{};
+    board[0][0] = 5;
+    board[8][0] = 5;
+
+    sudoku::CandidateScan scan;
+    sudoku::ScanCandidates(sudoku::ToMaskBoard(board), &scan);
+
+    REQUIRE(scan.is_contradiction);
+  }
+
+  SECTION("Instruction set is never higher than the CPU supports") {
+    sudoku::SetKernelIsa(sudoku::KernelIsa::kAvx2);
+
+    REQUIRE(sudoku::GetKernelIsa() == best);
+  }
+
+  sudoku::SetKernelIsa(best);
+}
+
+TEST_CASE("Solver", "[solver]") {
+  sudoku::Engine engine;
+  engine.CreateGame("easy_1.json");
+  sudoku::Grid board;
+  sudoku::Grid solution;
+  GetBoards(engine, &board, &solution);
+
+  SECTION("Solves a puzzle") {
+    REQUIRE(sudoku::Solve(&board));
+    REQUIRE(board == solution);
+  }
+
+  SECTION("Counts solutions") {
+    REQUIRE(sudoku::CountSolutions(board, 2) == 1);
+
+    sudoku::Grid empty{};
+    REQUIRE(sudoku::CountSolutions(empty, 5) == 5);
+  }
+
+  SECTION("Unsolvable boards are left alone") {
+    board[0][0] = solution[0][1];
+    sudoku::Grid unsolvable = board;
+
+    REQUIRE_FALSE(sudoku::Solve(&board));
+    REQUIRE(board == unsolvable);
+  }
+}
+
+TEST_CASE("Auto pencil", "[engine][pencil]") {
+  sudoku::Engine engine;
+  engine.CreateGame("easy_1.json");
+  engine.ChangePencilMark({0, 0}, 1);
+  engine.AutoPencil();
+
+  sudoku::Grid board;
+  sudoku::Grid solution;
+  GetBoards(engine, &board, &solution);
+  sudoku::CandidateGrid candidates = sudoku::ComputeCandidates(board);
+
+  for (size_t row = 0; row < kBoardSize; row++) {
+    for (size_t col = 0; col < kBoardSize; col++) {
+      for (int num = 1; num <= static_cast<int>(kBoardSize); num++) {
+        REQUIRE(engine.IsPenciled({row, col}, num)
+                == ((candidates[row][col] & sudoku::DigitBit(num)) != 0));
+      }
+
+      if (board[row][col] == 0) {
+        REQUIRE(engine.IsPenciled({row, col}, solution[row][col]));
+      }
+    }
+  }
+}
+
+TEST_CASE("Batch solver", "[solver]") {
+  std::vector<sudoku::Grid> boards;
+  std::vector<sudoku::Grid> solutions;
+  std::mt19937 rng(126);
+  for (size_t i = 0; i < 20; i++) {
+    sudoku::Engine engine;
+    engine.CreateGame(i % 2 == 0 ? "easy_1.json" : "hard_1.json");
+
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+    sudoku::BoardTransform transform = sudoku::RandomTransform(&rng);
+    boards.push_back(sudoku::ApplyTransform(board, transform));
+    solutions.push_back(sudoku::ApplyTransform(solution, transform));
+  }
+
+  // No solution, since the 5's clash
+  sudoku::Grid unsolvable{};
+  unsolvable[0][0] = 5;
+  unsolvable[0][8] = 5;
+  boards.push_back(unsolvable);
+
+  SECTION("Solves every board that has a solution") {
+    std::vector<sudoku::Grid> solved = boards;
+
+    REQUIRE(sudoku::SolveBatch(&solved) == boards.size() - 1);
+    REQUIRE(solved.back() == unsolvable);
+
+    for (size_t i = 0; i < solutions.size(); i++) {
+      sudoku::Grid check = solved[i];
+      for (size_t row = 0; row < kBoardSize; row++) {
+        for (size_t col = 0; col < kBoardSize; col++) {
+          REQUIRE(check[row][col] != 0);
+          if (boards[i][row][col] != 0) {
+            REQUIRE(check[row][col] == boards[i][row][col]);
+          }
+        }
+      }
+      REQUIRE(sudoku::CountSolutions(check, 2) == 1);
+    }
+
+    // This puzzle only has one solution
+    REQUIRE(solved[0] == solutions[0]);
+  }
+
+  SECTION("Finds the same solutions as solving one at a time") {
+    std::vector<sudoku::Grid> solved = boards;
+    sudoku::SolveBatch(&solved);
+
+    for (size_t i = 0; i < boards.size(); i++) {
+      sudoku::Grid board = boards[i];
+      sudoku::Solve(&board);
+
+      REQUIRE(solved[i] == board);
+    }
+  }
+
+  SECTION("Every instruction set gives the same results") {
+    const sudoku::KernelIsa best = sudoku::GetBestKernelIsa();
+    std::vector<sudoku::Grid> expected = boards;
+    sudoku::SetKernelIsa(sudoku::KernelIsa::kScalar);
+    sudoku::SolveBatch(&expected);
+
+    for (auto isa : {sudoku::KernelIsa::kSse41, sudoku::KernelIsa::kAvx2}) {
+      std::vector<sudoku::Grid> solved = boards;
+      sudoku::SetKernelIsa(isa);
+      sudoku::SolveBatch(&solved);
+
+      REQUIRE(solved == expected);
+    }
+
+    sudoku::SetKernelIsa(best);
+  }
+
+  SECTION("Boards are read from and written to lines") {
+    sudoku::Grid board;
+    std::string line = sudoku::FormatBoardLine(boards[0]);
+
+    REQUIRE(line.size() == kBoardSize * kBoardSize);
+    REQUIRE(sudoku::ParseBoardLine(line, &board));
+    REQUIRE(board == boards[0]);
+
+    std::replace(line.begin(), line.end(), '0', '.');
+    REQUIRE(sudoku::ParseBoardLine(line, &board));
+    REQUIRE(board == boards[0]);
+
+    REQUIRE_FALSE(sudoku::ParseBoardLine("12345", &board));
+  }
+}
+
+TEST_CASE("Generate puzzles", "[generator]") {
+  std::mt19937 rng(126);
+  sudoku::Grid solution = sudoku::GenerateSolution(&rng);
+  sudoku::Grid puzzle = sudoku::GeneratePuzzle(solution, &rng);
+
+  SECTION("Solution is complete and valid") {
+    for (const auto& unit : sudoku::GetUnits()) {
+      sudoku::DigitMask seen = 0;
+      for (const auto& pos : unit) {
+        seen |= sudoku::DigitBit(solution[pos.first][pos.second]);
+      }
+
+      REQUIRE(seen == sudoku::kAllDigits);
+    }
+  }
+
+  SECTION("Puzzle has exactly that solution") {
+    sudoku::Grid solved = puzzle;
+
+    REQUIRE(sudoku::CountSolutions(puzzle, 2) == 1);
+    REQUIRE(sudoku::Solve(&solved));
+    REQUIRE(solved == solution);
+  }
+
+  SECTION("No given can be removed") {
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        if (puzzle[row][col] != 0) {
+          sudoku::Grid fewer = puzzle;
+          fewer[row][col] = 0;
+
+          REQUIRE(sudoku::CountSolutions(fewer, 2) == 2);
+        }
+      }
+    }
+  }
+
+  SECTION("The same seed gives the same puzzle") {
+    std::mt19937 other_rng(126);
+    sudoku::Grid other_solution = sudoku::GenerateSolution(&other_rng);
+
+    REQUIRE(other_solution == solution);
+    REQUIRE(sudoku::GeneratePuzzle(other_solution, &other_rng) == puzzle);
+  }
+}
+
+TEST_CASE("Portable random numbers", "[generator]") {
+  SECTION("Indexes are the same on every machine") {
+    std::mt19937 rng(126);
+    std::vector<uint64_t> indexes;
+    for (size_t i = 0; i < 8; i++) {
+      indexes.push_back(sudoku::RandomIndex(10, &rng));
+    }
+    REQUIRE(indexes == std::vector<uint64_t>{2, 5, 2, 1, 5, 4, 4, 9});
+  }
+
+  SECTION("Engines that don't fill their range are still uniform") {
+    // minstd_rand makes 1 to 2^31 - 2
+    std::minstd_rand rng(1);
+    std::array<size_t, 9> counts{};
+    for (size_t i = 0; i < 9000; i++) {
+      counts[sudoku::RandomIndex(9, &rng)]++;
+    }
+    for (size_t count : counts) {
+      REQUIRE(count > 850);
+      REQUIRE(count < 1150);
+    }
+  }
+
+  SECTION("Random gives the same numbers on every machine") {
+    sudoku::Random rng(126);
+    REQUIRE(rng() == 0xAE15CD8EEDBE52B8ull);
+    REQUIRE(rng() == 0x4B81815460DE04AAull);
+    REQUIRE(rng() == 0x8FF7B8F0E884D0C3ull);
+
+    sudoku::Random index_rng(126);
+    std::vector<uint64_t> indexes;
+    for (size_t i = 0; i < 8; i++) {
+      indexes.push_back(sudoku::RandomIndex(10, &index_rng));
+    }
+    REQUIRE(indexes == std::vector<uint64_t>{6, 2, 5, 3, 1, 2, 1, 0});
+  }
+
+  SECTION("Random indexes are uniform") {
+    sudoku::Random rng(126);
+    std::array<size_t, 9> counts{};
+    for (size_t i = 0; i < 9000; i++) {
+      counts[sudoku::RandomIndex(9, &rng)]++;
+    }
+    for (size_t count : counts) {
+      REQUIRE(count > 850);
+      REQUIRE(count < 1150);
+    }
+
+    // Too big for the fast path
+    REQUIRE(sudoku::RandomIndex(uint64_t{1} << 40, &rng) < uint64_t{1} << 40);
+  }
+
+  SECTION("Split streams are independent and repeatable") {
+    sudoku::Random rng(126);
+    sudoku::Random first = rng.Split();
+    sudoku::Random second = rng.Split();
+
+    // The first split carries on from the seed
+    REQUIRE(first() == 0xAE15CD8EEDBE52B8ull);
+
+    std::vector<uint64_t> second_numbers;
+    std::vector<uint64_t> parent_numbers;
+    for (size_t i = 0; i < 100; i++) {
+      second_numbers.push_back(second());
+      parent_numbers.push_back(rng());
+    }
+    REQUIRE(second_numbers != parent_numbers);
+
+    sudoku::Random again(126);
+    again.Split();
+    sudoku::Random second_again = again.Split();
+    REQUIRE(second_again() == second_numbers[0]);
+  }
+
+  SECTION("Shuffles keep every element") {
+    std::mt19937 rng(126);
+    std::vector<int> numbers(50);
+    std::iota(numbers.begin(), numbers.end(), 0);
+    sudoku::RandomShuffle(numbers.begin(), numbers.end(), &rng);
+
+    std::vector<int> sorted = numbers;
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(sorted[0] == 0);
+    REQUIRE(sorted[49] == 49);
+    REQUIRE(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    REQUIRE(sorted != numbers);
+  }
+}
+
+TEST_CASE("Daily challenge", "[generator][daily]") {
+  // 2026-10-19
+  const int64_t day = 20745;
+  sudoku::Grid puzzle;
+  sudoku::Grid solution;
+  sudoku::GenerateDailyChallenge(day, &puzzle, &solution);
+
+  SECTION("Days are counted in UTC") {
+    REQUIRE(sudoku::GetChallengeDay(0) == 0);
+    REQUIRE(sudoku::GetChallengeDay(86399) == 0);
+    REQUIRE(sudoku::GetChallengeDay(86400) == 1);
+    REQUIRE(sudoku::GetChallengeDay(-1) == -1);
+    REQUIRE(sudoku::FormatChallengeDay(0) == "1970-01-01");
+    REQUIRE(sudoku::FormatChallengeDay(-1) == "1969-12-31");
+    REQUIRE(sudoku::FormatChallengeDay(11016) == "2000-02-29");
+    REQUIRE(sudoku::FormatChallengeDay(day) == "2026-10-19");
+  }
+
+  SECTION("Every machine gets the same puzzle") {
+    sudoku::Grid expected;
+    REQUIRE(sudoku::ParseBoardLine("08005000207000400000100009500000201010300"
+                                   "0200000908000000200140000007608006030000",
+                                   &expected));
+    REQUIRE(puzzle == expected);
+    REQUIRE(sudoku::CountSolutions(puzzle, 2) == 1);
+
+    sudoku::Grid solved = puzzle;
+    REQUIRE(sudoku::Solve(&solved));
+    REQUIRE(solved == solution);
+  }
+
+  SECTION("Each day has its own puzzle") {
+    sudoku::Grid other_puzzle;
+    sudoku::Grid other_solution;
+    sudoku::GenerateDailyChallenge(day + 1, &other_puzzle, &other_solution);
+    REQUIRE(other_puzzle != puzzle);
+  }
+
+  SECTION("Challenge ids") {
+    int64_t parsed = 0;
+    REQUIRE(sudoku::ParseChallengeId(sudoku::GetChallengeId(day), &parsed));
+    REQUIRE(parsed == day);
+    REQUIRE(sudoku::ParseChallengeId(sudoku::GetChallengeId(-3), &parsed));
+    REQUIRE(parsed == -3);
+    REQUIRE_FALSE(sudoku::ParseChallengeId("easy_1.json", &parsed));
+    REQUIRE_FALSE(sudoku::ParseChallengeId("daily_", &parsed));
+    REQUIRE_FALSE(sudoku::ParseChallengeId("daily_12x", &parsed));
+  }
+
+  SECTION("The engine plays it as a one board game") {
+    sudoku::Engine engine;
+    engine.SetDifficulty(Difficulty::kMedium);
+    engine.CreateDailyChallenge(day);
+    REQUIRE(engine.GetGameMode() == GameMode::kDailyChallenge);
+    REQUIRE(engine.GetChallengeDay() == day);
+
+    // The grade doesn't change the difficulty picked for other games
+    REQUIRE(engine.GetDifficulty() == Difficulty::kMedium);
+    REQUIRE(engine.GetChallengeDifficulty() == Difficulty::kHard);
+    REQUIRE(engine.GetBoardsPerGame() == 1);
+    REQUIRE_FALSE(engine.HasNextBoard());
+
+    sudoku::Grid board;
+    sudoku::Grid engine_solution;
+    GetBoards(engine, &board, &engine_solution);
+    REQUIRE(board == puzzle);
+    REQUIRE(engine_solution == solution);
+
+    sudoku::Engine restored;
+    REQUIRE(restored.DeserializeSnapshot(engine.SerializeSnapshot()));
+    REQUIRE(restored.GetGameMode() == GameMode::kDailyChallenge);
+    REQUIRE(restored.GetChallengeDay() == day);
+    REQUIRE(restored.GetDifficulty() == Difficulty::kMedium);
+    REQUIRE(restored.GetChallengeDifficulty()
+            == engine.GetChallengeDifficulty());
+  }
+}
+
+TEST_CASE("Grade puzzles", "[hint]") {
+  sudoku::Engine engine;
+  engine.CreateGame("easy_1.json");
+  sudoku::Grid board;
+  sudoku::Grid solution;
+  GetBoards(engine, &board, &solution);
+
+  SECTION("Singles are enough for an easy board") {
+    sudoku::Technique grade = sudoku::GradePuzzle(board, solution);
+
+    REQUIRE(grade != sudoku::Technique::kNone);
+    REQUIRE(static_cast<int>(grade)
+            <= static_cast<int>(sudoku::Technique::kHiddenSingle));
+  }
+
+  SECTION("A solved board needs nothing") {
+    REQUIRE(sudoku::GradePuzzle(solution, solution)
+            == sudoku::Technique::kNone);
+  }
+}
+
+TEST_CASE("Variant rules", "[variant]") {
+  using sudoku::DigitBit;
+  using sudoku::Grid;
+  using sudoku::Variant;
+  using sudoku::VariantRules;
+
+  sudoku::Random rng(126);
+
+  SECTION("Cage digits make up the sum") {
+    REQUIRE(sudoku::GetCageDigits(2, 3, sudoku::kAllDigits)
+            == (DigitBit(1) | DigitBit(2)));
+    REQUIRE(sudoku::GetCageDigits(2, 17, sudoku::kAllDigits)
+            == (DigitBit(8) | DigitBit(9)));
+    REQUIRE(sudoku::GetCageDigits(2, 10, sudoku::kAllDigits)
+            == (sudoku::kAllDigits & ~DigitBit(5)));
+    REQUIRE(sudoku::GetCageDigits(9, 45, sudoku::kAllDigits)
+            == sudoku::kAllDigits);
+
+    // 17 in two boxes needs a 9
+    REQUIRE(sudoku::GetCageDigits(
+                2, 17, static_cast<sudoku::DigitMask>(
+                           sudoku::kAllDigits & ~DigitBit(9))) == 0);
+  }
+
+  SECTION("Classic rules are recognised however they're written") {
+    REQUIRE(Variant::GetClassic()->IsClassic());
+    REQUIRE(Variant::GetClassic()->GetPeers(0).size() == 20);
+
+    VariantRules reordered = sudoku::ClassicRules();
+    std::reverse(reordered.groups.begin(), reordered.groups.end());
+    std::reverse(reordered.groups[0].begin(), reordered.groups[0].end());
+    REQUIRE(Variant(reordered).IsClassic());
+
+    REQUIRE_FALSE(Variant(sudoku::DiagonalRules()).IsClassic());
+    REQUIRE_FALSE(Variant(sudoku::KillerRules({{{0, 1}, 3}})).IsClassic());
+  }
+
+  SECTION("The variant solver agrees with the classic one") {
+    // A repeated row changes nothing, but isn't classic
+    VariantRules rules = sudoku::ClassicRules();
+    rules.groups.push_back(rules.groups[0]);
+    Variant variant(rules);
+    REQUIRE_FALSE(variant.IsClassic());
+
+    Grid solution = sudoku::GenerateSolution(&rng);
+    Grid puzzle = sudoku::GeneratePuzzle(solution, &rng);
+    Grid solved = puzzle;
+    REQUIRE(sudoku::Solve(&solved, variant));
+    REQUIRE(solved == solution);
+    REQUIRE(sudoku::CountSolutions(puzzle, 2, variant) == 1);
+
+    puzzle[0] = Grid{}[0];
+    REQUIRE(sudoku::CountSolutions(puzzle, 50, variant)
+            == sudoku::CountSolutions(puzzle, 50));
+  }
+
+  SECTION("Diagonal puzzles") {
+    Variant diagonal(sudoku::DiagonalRules());
+    REQUIRE(diagonal.GetPeers(0).size() == 26);
+
+    Grid solution = sudoku::GenerateSolution(&rng, diagonal);
+    REQUIRE(diagonal.IsSolution(solution));
+
+    Grid puzzle = sudoku::GeneratePuzzle(solution, &rng, diagonal);
+    Grid solved = puzzle;
+    REQUIRE(sudoku::CountSolutions(puzzle, 2, diagonal) == 1);
+    REQUIRE(sudoku::Solve(&solved, diagonal));
+    REQUIRE(solved == solution);
+
+    // Both diagonals hold every number once
+    for (size_t group = 27; group < 29; group++) {
+      sudoku::DigitMask seen = 0;
+      for (size_t cell : diagonal.GetRules().groups[group]) {
+        seen |= DigitBit(solution[cell / kBoardSize][cell % kBoardSize]);
+      }
+      REQUIRE(seen == sudoku::kAllDigits);
+    }
+  }
+
+  SECTION("Jigsaw puzzles") {
+    // Each region takes a different third of each row of its band
+    std::array<size_t, kBoardSize * kBoardSize> regions;
+    for (size_t cell = 0; cell < regions.size(); cell++) {
+      size_t row = cell / kBoardSize;
+      size_t col = cell % kBoardSize;
+      regions[cell] = 3 * (row / 3) + (col / 3 + 3 - row % 3) % 3;
+    }
+    Variant jigsaw(sudoku::JigsawRules(regions));
+    REQUIRE(jigsaw.IsWellFormed());
+    REQUIRE_FALSE(jigsaw.IsClassic());
+    REQUIRE(jigsaw.GetFullGroups().size() == 27);
+
+    Grid solution = sudoku::GenerateSolution(&rng, jigsaw);
+    Grid puzzle = sudoku::GeneratePuzzle(solution, &rng, jigsaw);
+    REQUIRE(jigsaw.IsSolution(solution));
+    REQUIRE(sudoku::CountSolutions(puzzle, 2, jigsaw) == 1);
+
+    regions[0] = kBoardSize;
+    REQUIRE_FALSE(Variant(sudoku::JigsawRules(regions)).IsWellFormed());
+  }
+
+  SECTION("Killer puzzles") {
+    Grid solution = sudoku::GenerateSolution(&rng);
+    std::vector<sudoku::Cage> cages = sudoku::RandomCages(solution, &rng);
+
+    // Every box is in one cage, with no number repeated
+    std::vector<size_t> cells;
+    for (const auto& cage : cages) {
+      REQUIRE(cage.cells.size() >= 1);
+      REQUIRE(cage.cells.size() <= sudoku::kMaxCageSize);
+      cells.insert(cells.end(), cage.cells.begin(), cage.cells.end());
+    }
+    std::sort(cells.begin(), cells.end());
+    REQUIRE(cells.size() == kBoardSize * kBoardSize);
+    REQUIRE(std::adjacent_find(cells.begin(), cells.end()) == cells.end());
+
+    Variant killer(sudoku::KillerRules(cages));
+    REQUIRE(killer.IsWellFormed());
+    REQUIRE(killer.IsSolution(solution));
+
+    // The cages give away so much that few givens are left
+    Grid puzzle = sudoku::GeneratePuzzle(solution, &rng, killer);
+    Grid solved = puzzle;
+    REQUIRE(sudoku::CountSolutions(puzzle, 2, killer) == 1);
+    REQUIRE(sudoku::Solve(&solved, killer));
+    REQUIRE(solved == solution);
+  }
+
+  SECTION("Cages narrow candidates") {
+    Variant killer(sudoku::KillerRules({{{0, 1}, 3}, {{9, 10, 11}, 24}}));
+    Grid board{};
+    sudoku::CandidateGrid candidates = sudoku::ComputeCandidates(board, killer);
+    REQUIRE(candidates[0][0] == (DigitBit(1) | DigitBit(2)));
+    REQUIRE(candidates[1][0] == (DigitBit(7) | DigitBit(8) | DigitBit(9)));
+
+    // With 2 placed, the rest of the cage has to be 1
+    board[0][1] = 2;
+    candidates = sudoku::ComputeCandidates(board, killer);
+    REQUIRE(candidates[0][0] == DigitBit(1));
+    REQUIRE(candidates[0][1] == 0);
+
+    REQUIRE_FALSE(killer.HasConflict(board));
+    board[0][0] = 3;
+    REQUIRE(killer.HasConflict(board));
+
+    // Both boxes of the cage over its sum are in conflict, and nothing else
+    board[4][4] = 3;
+    REQUIRE(killer.IsInConflict(board, 0));
+    REQUIRE(killer.IsInConflict(board, 1));
+    REQUIRE_FALSE(killer.IsInConflict(board, 4 * kBoardSize + 4));
+    REQUIRE_FALSE(killer.IsInConflict(board, 9));
+  }
+
+  SECTION("Even/odd puzzles") {
+    Grid solution = sudoku::GenerateSolution(&rng);
+    VariantRules rules = sudoku::ClassicRules();
+    for (size_t cell = 0; cell < rules.allowed.size(); cell++) {
+      rules.allowed[cell]
+          = solution[cell / kBoardSize][cell % kBoardSize] % 2 == 0
+                ? sudoku::kEvenDigits : sudoku::kOddDigits;
+    }
+    Variant even_odd(rules);
+    REQUIRE(even_odd.IsSolution(solution));
+
+    Grid puzzle = sudoku::GeneratePuzzle(solution, &rng, even_odd);
+    REQUIRE(sudoku::CountSolutions(puzzle, 2, even_odd) == 1);
+
+    // A box can only hold numbers of its own parity
+    Grid board{};
+    board[0][0] = solution[0][0] % 2 == 0 ? 1 : 2;
+    REQUIRE(even_odd.HasConflict(board));
+    REQUIRE((sudoku::ComputeCandidates(Grid{}, even_odd)[0][0]
+             & DigitBit(board[0][0])) == 0);
+  }
+
+  SECTION("Rules that can't make a puzzle") {
+    REQUIRE_FALSE(Variant(sudoku::KillerRules({{{0, 1}, 2}})).IsWellFormed());
+    REQUIRE_FALSE(Variant(sudoku::KillerRules({{{0, 0}, 3}})).IsWellFormed());
+    REQUIRE_FALSE(Variant(sudoku::KillerRules({{{}, 0}})).IsWellFormed());
+
+    VariantRules rules = sudoku::ClassicRules();
+    rules.allowed[40] = 0;
+    REQUIRE_FALSE(Variant(rules).IsWellFormed());
+
+    // Nothing reads past the board for a box off it
+    const Variant off_board(sudoku::KillerRules({{{0, 200}, 3}}));
+    REQUIRE_FALSE(off_board.IsWellFormed());
+    REQUIRE(off_board.HasConflict(Grid{}));
+    REQUIRE(sudoku::CountSolutions(Grid{}, 1, off_board) == 0);
+    Grid board{};
+    REQUIRE_FALSE(sudoku::Solve(&board, off_board));
+    REQUIRE(board == Grid{});
+  }
+}
+
+TEST_CASE("Variant games", "[engine][variant]") {
+  using sudoku::DigitBit;
+  using sudoku::Variant;
+  using sudoku::VariantRules;
+  sudoku::Engine engine(126);
+
+  SECTION("Classic games stay classic") {
+    engine.CreateGame("test_board.json");
+    REQUIRE(engine.GetVariant().IsClassic());
+
+    sudoku::Engine restored;
+    REQUIRE(restored.DeserializeSnapshot(engine.SerializeSnapshot()));
+    REQUIRE(restored.GetVariant().IsClassic());
+  }
+
+  SECTION("Diagonal game") {
+    REQUIRE(engine.CreateVariantGame(
+        std::make_shared<const sudoku::Variant>(sudoku::DiagonalRules())));
+    const sudoku::Variant& variant = engine.GetVariant();
+    REQUIRE_FALSE(variant.IsClassic());
+
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+    REQUIRE(variant.IsSolution(solution));
+    REQUIRE(sudoku::CountSolutions(board, 2, variant) == 1);
+
+    // Pencil marks leave out numbers already on a box's diagonal
+    engine.AutoPencil();
+    for (size_t i = 0; i < kBoardSize; i++) {
+      if (board[i][i] != 0) {
+        continue;
+      }
+      for (size_t j = 0; j < kBoardSize; j++) {
+        if (board[j][j] != 0) {
+          REQUIRE_FALSE(engine.IsPenciled({i, i}, board[j][j]));
+        }
+      }
+      REQUIRE(engine.IsPenciled({i, i}, solution[i][i]));
+    }
+
+    SECTION("Hints solve it") {
+      for (size_t step = 0; step < kBoardSize * kBoardSize; step++) {
+        sudoku::Hint hint = engine.GetHint();
+        if (hint.technique == sudoku::Technique::kNone) {
+          break;
+        }
+
+        REQUIRE(hint.technique != sudoku::Technique::kIncorrectEntry);
+        REQUIRE(hint.num == solution[static_cast<size_t>(hint.entry.first)]
+                                    [static_cast<size_t>(hint.entry.second)]);
+        engine.FillInCorrectEntry(hint.entry);
+      }
+      REQUIRE(engine.IsGameOver());
+    }
+
+    SECTION("Entries are checked against the diagonals") {
+      // A number from the diagonal in an empty diagonal box, where it
+      // clashes with nothing else
+      auto is_clear = [&board](size_t row, size_t col, int num) {
+        for (size_t i = 0; i < kBoardSize; i++) {
+          if (board[row][i] == num || board[i][col] == num
+              || board[row / 3 * 3 + i / 3][col / 3 * 3 + i % 3] == num) {
+            return false;
+          }
+        }
+        return true;
+      };
+
+      bool is_found = false;
+      for (size_t i = 0; i < kBoardSize && !is_found; i++) {
+        for (size_t j = 0; j < kBoardSize && !is_found; j++) {
+          if (board[i][i] == 0 && board[j][j] != 0
+              && is_clear(i, i, board[j][j])) {
+            engine.SetEntry({i, i}, board[j][j]);
+            engine.CheckBoard();
+            REQUIRE(engine.GetEntryState({i, i}) == EntryState::kWrong);
+            is_found = true;
+          }
+        }
+      }
+      REQUIRE(is_found);
+    }
+
+    SECTION("Snapshots keep the rules") {
+      sudoku::Engine restored;
+      REQUIRE(restored.DeserializeSnapshot(engine.SerializeSnapshot()));
+      REQUIRE(restored.GetVariant().GetRules().groups
+              == variant.GetRules().groups);
+      REQUIRE_FALSE(restored.GetVariant().IsClassic());
+    }
+  }
+
+  SECTION("Rules without a solution are refused") {
+    engine.CreateGame("test_board.json");
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+
+    REQUIRE_FALSE(engine.CreateVariantGame(std::make_shared<const Variant>(
+        sudoku::KillerRules({{{0, 200}, 3}}))));
+
+    // Two boxes in a row that can only hold a 1
+    VariantRules rules = sudoku::ClassicRules();
+    rules.allowed[0] = DigitBit(1);
+    rules.allowed[1] = DigitBit(1);
+    REQUIRE_FALSE(
+        engine.CreateVariantGame(std::make_shared<const Variant>(rules)));
+
+    sudoku::Grid after;
+    GetBoards(engine, &after, &solution);
+    REQUIRE(after == board);
+    REQUIRE(engine.GetVariant().IsClassic());
+  }
+
+  SECTION("Killer game") {
+    engine.CreateKillerGame();
+    const auto& cages = engine.GetVariant().GetRules().cages;
+    REQUIRE_FALSE(cages.empty());
+
+    // Over once it's full and keeps to the cages
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+    for (size_t row = 0; row < kBoardSize; row++) {
+      for (size_t col = 0; col < kBoardSize; col++) {
+        REQUIRE_FALSE(engine.IsGameOver());
+        engine.SetEntry({row, col}, solution[row][col]);
+      }
+    }
+    REQUIRE(engine.IsGameOver());
+
+    sudoku::Engine restored;
+    REQUIRE(restored.DeserializeSnapshot(engine.SerializeSnapshot()));
+    const auto& restored_cages = restored.GetVariant().GetRules().cages;
+    REQUIRE(restored_cages.size() == cages.size());
+    for (size_t i = 0; i < cages.size(); i++) {
+      REQUIRE(restored_cages[i].cells == cages[i].cells);
+      REQUIRE(restored_cages[i].sum == cages[i].sum);
+    }
+  }
+
+  SECTION("Snapshots whose solution breaks the rules are rejected") {
+    engine.CreateGame("test_board.json");
+    const std::string data = engine.SerializeSnapshot();
+
+    // The snapshot with its classic flag swapped for the rules written out,
+    // and the checksum rewritten so only the rules can be wrong
+    auto with_rules = [&data](const sudoku::VariantRules& rules) {
+      std::string changed = data.substr(0, data.size() - 5);
+      changed.push_back('\0');
+      changed.push_back(static_cast<char>(rules.groups.size()));
+      for (const auto& group : rules.groups) {
+        changed.push_back(static_cast<char>(group.size()));
+        for (size_t cell : group) {
+          changed.push_back(static_cast<char>(cell));
+        }
+      }
+      changed.push_back('\0');
+      for (sudoku::DigitMask mask : rules.allowed) {
+        changed.push_back(static_cast<char>(mask & 0xFF));
+        changed.push_back(static_cast<char>(mask >> 8));
+      }
+
+      uint32_t hash = 2166136261u;
+      for (char byte : changed) {
+        hash ^= static_cast<uint8_t>(byte);
+        hash *= 16777619u;
+      }
+      for (size_t i = 0; i < 4; i++) {
+        changed.push_back(static_cast<char>(hash >> (8 * i) & 0xFF));
+      }
+
+      return changed;
+    };
+
+    sudoku::Engine restored;
+    REQUIRE(restored.DeserializeSnapshot(with_rules(sudoku::ClassicRules())));
+    REQUIRE(restored.GetVariant().IsClassic());
+    REQUIRE_FALSE(
+        restored.DeserializeSnapshot(with_rules(sudoku::DiagonalRules())));
+  }
+}
+
+TEST_CASE("Profiler", "[profiler]") {
+  using Clock = sudoku::Profiler::Clock;
+  using std::chrono::milliseconds;
+
+  sudoku::Profiler profiler(8);
+  const Clock::time_point start = Clock::now();
+
+  // 1ms to 10ms for "draw", and one 5ms "update"
+  for (int ms = 1; ms <= 10; ms++) {
+    profiler.Record("draw", start, start + milliseconds(ms));
+  }
+  profiler.Record("update", start, start + milliseconds(5));
+
+  SECTION("Only the most recent samples are kept") {
+    auto samples = profiler.GetSamples();
+
+    REQUIRE(samples.size() == 8);
+    REQUIRE(samples.front().duration_ns == 4000000);
+    REQUIRE(std::string(samples.back().scope) == "update");
+  }
+
+  SECTION("Percentiles per scope") {
+    auto stats = profiler.GetStats();
+
+    REQUIRE(stats.size() == 2);
+    REQUIRE(stats[0].scope == "draw");
+    REQUIRE(stats[0].count == 7);
+    REQUIRE(stats[0].p50_ms == Approx(7));
+    REQUIRE(stats[0].p99_ms == Approx(10));
+    REQUIRE(stats[0].max_ms == Approx(10));
+    REQUIRE(stats[1].scope == "update");
+    REQUIRE(stats[1].p50_ms == Approx(5));
+  }
+
+  SECTION("Clear") {
+    profiler.Clear();
+    REQUIRE(profiler.GetSamples().empty());
+
+    profiler.Record("draw", start, start + milliseconds(1));
+    REQUIRE(profiler.GetSamples().size() == 1);
+  }
+
+  SECTION("Scoped timers") {
+    {
+      sudoku::ScopedTimer timer("scoped", &profiler);
+      std::this_thread::sleep_for(milliseconds(2));
+    }
+
+    auto sample = profiler.GetSamples().back();
+    REQUIRE(std::string(sample.scope) == "scoped");
+    REQUIRE(sample.duration_ns >= 2000000);
+  }
+
+  SECTION("Export a Chrome trace") {
+    const std::string path = "profiler_test_trace.json";
+    REQUIRE(profiler.ExportChromeTrace(path));
+
+    std::ifstream infile(path);
+    auto trace = nlohmann::json::parse(infile);
+    infile.close();
+    std::remove(path.c_str());
+
+    const auto& events = trace.at("traceEvents");
+    REQUIRE(events.size() == 8);
+    REQUIRE(events[7].at("name") == "update");
+    REQUIRE(events[7].at("ph") == "X");
+    REQUIRE(events[7].at("dur").get<double>() == Approx(5000));
+  }
+
+  SECTION("Recording from several threads") {
+    sudoku::Profiler shared(1024);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+      threads.emplace_back([&shared] {
+        for (int j = 0; j < 100; j++) {
+          sudoku::ScopedTimer timer("thread", &shared);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(shared.GetSamples().size() == 400);
+  }
+}
+
+TEST_CASE("Layout", "[layout]") {
+  sudoku::Layout layout;
+
+  SECTION("The design size maps one to one") {
+    REQUIRE(layout.GetScale() == Approx(1));
+    REQUIRE(layout.ToWindow({123, 456}) == ci::vec2(123, 456));
+    REQUIRE(layout.GetCellBox(0, 0).first == ci::vec2(103, 103));
+    REQUIRE(layout.GetCellBox(8, 8).second == ci::vec2(697, 697));
+  }
+
+  SECTION("A 4K window is scaled and centered") {
+    layout.Resize({3840, 2160}, 1);
+
+    REQUIRE(layout.GetScale() == Approx(2.7));
+    REQUIRE(layout.GetOrigin().x == Approx(840));
+    REQUIRE(layout.GetOrigin().y == Approx(0));
+
+    ci::vec2 corner = layout.ToWindow(sudoku::Layout().GetBounds().second);
+    REQUIRE(corner.x == Approx(3000));
+    REQUIRE(corner.y == Approx(2160));
+
+    ci::vec2 design = layout.ToDesign(corner);
+    REQUIRE(design.x == Approx(800));
+    REQUIRE(design.y == Approx(800));
+  }
+
+  SECTION("Pixel density only changes the pixel scale") {
+    layout.Resize({800, 800}, 2);
+
+    REQUIRE(layout.GetScale() == Approx(1));
+    REQUIRE(layout.GetPixelScale() == Approx(2));
+  }
+
+  SECTION("Hit test board boxes") {
+    std::pair<int, int> cell;
+
+    REQUIRE(layout.GetCellAt({104, 104}, &cell));
+    REQUIRE(cell == std::make_pair(0, 0));
+
+    sudoku::Box box = layout.GetCellBox(4, 7);
+    REQUIRE(layout.GetCellAt(GetMiddleOfBox(box), &cell));
+    REQUIRE(cell == std::make_pair(4, 7));
+
+    REQUIRE(!layout.GetCellAt({50, 400}, &cell));
+    REQUIRE(!layout.GetCellAt({400, 697}, &cell));
+    REQUIRE(!layout.GetCellAt({400, 750}, &cell));
+  }
+}
+
+TEST_CASE("Board bank", "[engine][bank]") {
+  sudoku::Engine reader;
+  const std::vector<std::string> files = reader.GetBoardFiles();
+  REQUIRE(files.size() == 9);
+
+  // Loaded on another thread, as the app does at startup, from paths found
+  // on this one
+  const auto paths = sudoku::BoardBank::FindPaths(files);
+  std::shared_ptr<const sudoku::BoardBank> bank;
+  std::thread loader([&] {
+    bank = std::make_shared<sudoku::BoardBank>(paths);
+  });
+  loader.join();
+
+  REQUIRE(bank->GetSize() == 9);
+
+  SECTION("Boards match their files") {
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    REQUIRE(bank->GetBoard("easy_1.json", &board, &solution));
+
+    sudoku::Grid file_board;
+    sudoku::Grid file_solution;
+    REQUIRE(sudoku::ReadBoardFile("easy_1.json", &file_board, &file_solution));
+    REQUIRE(board == file_board);
+    REQUIRE(solution == file_solution);
+  }
+
+  SECTION("Missing boards") {
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    REQUIRE(!bank->GetBoard("test_board.json", &board, &solution));
+    REQUIRE(!sudoku::ReadBoardFile("missing.json", &board, &solution));
+  }
+
+  SECTION("Broken board files") {
+    const std::string path = "test_broken_board.json";
+    sudoku::Grid board{};
+    sudoku::Grid solution{};
+    sudoku::Grid grid{};
+    grid[0][0] = 10;
+
+    nlohmann::json missing;
+    missing["board"] = sudoku::Grid{};
+    std::ofstream(path) << missing;
+    REQUIRE(!sudoku::ReadBoardPath(path, &board, &solution));
+
+    nlohmann::json wrong_shape;
+    wrong_shape["board"] = "no board here";
+    wrong_shape["solution"] = sudoku::Grid{};
+    std::ofstream(path) << wrong_shape;
+    REQUIRE(!sudoku::ReadBoardPath(path, &board, &solution));
+
+    nlohmann::json out_of_range;
+    out_of_range["board"] = grid;
+    out_of_range["solution"] = grid;
+    std::ofstream(path) << out_of_range;
+    REQUIRE(!sudoku::ReadBoardPath(path, &board, &solution));
+    REQUIRE(board == sudoku::Grid{});
+    std::remove(path.c_str());
+
+    // The engine keeps the board it had
+    sudoku::Engine engine;
+    REQUIRE(engine.CreateGame("easy_1.json"));
+    sudoku::Grid before;
+    GetBoards(engine, &before, &solution);
+    REQUIRE(!engine.CreateGame("missing.json"));
+    GetBoards(engine, &board, &solution);
+    REQUIRE(board == before);
+  }
+
+  SECTION("The engine uses the bank and falls back to files") {
+    sudoku::Engine engine;
+    engine.UseBoardBank(bank);
+
+    engine.CreateGame("easy_1.json");
+    sudoku::Grid board;
+    sudoku::Grid solution;
+    GetBoards(engine, &board, &solution);
+    sudoku::Grid bank_board;
+    sudoku::Grid bank_solution;
+    bank->GetBoard("easy_1.json", &bank_board, &bank_solution);
+    REQUIRE(board == bank_board);
+    REQUIRE(solution == bank_solution);
+
+    engine.CreateGame("test_board.json");
+    engine.FillInCorrectEntry({0, 0});
+    REQUIRE(engine.GetEntry({0, 0}) == 6);
+  }
+}
+
+TEST_CASE("Leaderboard protocol", "[leaderboard][protocol]") {
+  sudoku::LeaderBoardRequest request;
+  request.op = sudoku::LeaderBoardOp::kAddTime;
+  request.mode = "Time Attack";
+  request.difficulty = "Easy";
+  request.name = "ada";
+  request.time = 123456789012;
+  request.limit = 0;
+
+  SECTION("Requests round trip") {
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardRequest decoded;
+    REQUIRE(sudoku::DecodeRequest(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(pos == data.size());
+    REQUIRE(decoded.op == request.op);
+    REQUIRE(decoded.mode == request.mode);
+    REQUIRE(decoded.difficulty == request.difficulty);
+    REQUIRE(decoded.name == request.name);
+    REQUIRE(decoded.time == request.time);
+  }
+
+  SECTION("Responses round trip") {
+    sudoku::LeaderBoardResponse response;
+    response.op = sudoku::LeaderBoardOp::kBestTimes;
+    response.ok = true;
+    response.players = {{"ada", 1000}, {"bob", 2000}};
+    response.rank = 0;
+
+    std::string data;
+    sudoku::EncodeResponse(response, &data);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardResponse decoded;
+    REQUIRE(sudoku::DecodeResponse(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded.ok);
+    REQUIRE(decoded.players.size() == 2);
+    REQUIRE(decoded.players[1].name == "bob");
+    REQUIRE(decoded.players[1].time == 2000);
+  }
+
+  SECTION("Responses are cut short to fit in a frame") {
+    sudoku::LeaderBoardResponse response;
+    response.op = sudoku::LeaderBoardOp::kBestTimes;
+    response.ok = true;
+    response.rank = 0;
+    for (size_t i = 0; i < 1000; i++) {
+      response.players.push_back({std::string(100, 'a'), 1000 + i});
+    }
+
+    std::string data;
+    sudoku::EncodeResponse(response, &data);
+    REQUIRE(data.size() <= 4 + sudoku::kMaxLeaderBoardFrame);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardResponse decoded;
+    REQUIRE(sudoku::DecodeResponse(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded.players.size() > 500);
+    REQUIRE(decoded.players.size() < 1000);
+    REQUIRE(decoded.players[0].time == 1000);
+  }
+
+  SECTION("Player stats round trip") {
+    request.op = sudoku::LeaderBoardOp::kPlayerStats;
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardRequest decoded_request;
+    REQUIRE(sudoku::DecodeRequest(data, &pos, &decoded_request)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded_request.name == "ada");
+
+    sudoku::LeaderBoardResponse response;
+    response.op = sudoku::LeaderBoardOp::kPlayerStats;
+    response.ok = true;
+    response.rank = 0;
+    response.stats.games_played = 12;
+    response.stats.best_time = 1000;
+    response.stats.mean_time = 1500;
+    response.stats.recent_median_time = 1200;
+    data.clear();
+    sudoku::EncodeResponse(response, &data);
+
+    pos = 0;
+    sudoku::LeaderBoardResponse decoded;
+    REQUIRE(sudoku::DecodeResponse(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded.stats.games_played == 12);
+    REQUIRE(decoded.stats.best_time == 1000);
+    REQUIRE(decoded.stats.mean_time == 1500);
+    REQUIRE(decoded.stats.recent_median_time == 1200);
+  }
+
+  SECTION("Window best times round trip") {
+    request.op = sudoku::LeaderBoardOp::kWindowBestTimes;
+    request.window = sudoku::LeaderBoardWindow::kWeekly;
+    request.limit = 10;
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardRequest decoded;
+    REQUIRE(sudoku::DecodeRequest(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded.window == sudoku::LeaderBoardWindow::kWeekly);
+    REQUIRE(decoded.limit == 10);
+
+    // There are only three windows
+    data[data.size() - 5] = 3;
+    pos = 0;
+    REQUIRE(sudoku::DecodeRequest(data, &pos, &decoded)
+            == sudoku::FrameStatus::kMalformed);
+  }
+
+  SECTION("Pipelined frames decode one at a time") {
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+    request.op = sudoku::LeaderBoardOp::kRank;
+    sudoku::EncodeRequest(request, &data);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardRequest decoded;
+    REQUIRE(sudoku::DecodeRequest(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded.op == sudoku::LeaderBoardOp::kAddTime);
+    REQUIRE(sudoku::DecodeRequest(data, &pos, &decoded)
+            == sudoku::FrameStatus::kComplete);
+    REQUIRE(decoded.op == sudoku::LeaderBoardOp::kRank);
+    REQUIRE(pos == data.size());
+  }
+
+  SECTION("Partial frames wait for more data") {
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+
+    for (size_t length = 0; length < data.size(); length++) {
+      size_t pos = 0;
+      sudoku::LeaderBoardRequest decoded;
+      REQUIRE(sudoku::DecodeRequest(data.substr(0, length), &pos, &decoded)
+              == sudoku::FrameStatus::kIncomplete);
+      REQUIRE(pos == 0);
+    }
+  }
+
+  SECTION("Garbage is rejected") {
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+
+    std::string bad_op = data;
+    bad_op[4] = 9;
+    size_t pos = 0;
+    sudoku::LeaderBoardRequest decoded;
+    REQUIRE(sudoku::DecodeRequest(bad_op, &pos, &decoded)
+            == sudoku::FrameStatus::kMalformed);
+
+    // The length says there's more body than the request has in it
+    std::string padded = data;
+    padded[0] = static_cast<char>(padded[0] + 1);
+    padded.push_back(0);
+    REQUIRE(sudoku::DecodeRequest(padded, &pos, &decoded)
+            == sudoku::FrameStatus::kMalformed);
+
+    std::string huge("\xff\xff\xff\x7f", 4);
+    REQUIRE(sudoku::DecodeRequest(huge, &pos, &decoded)
+            == sudoku::FrameStatus::kMalformed);
+  }
+
+  SECTION("Addresses") {
+    sudoku::LeaderBoardAddress address;
+    REQUIRE(sudoku::ParseLeaderBoardAddress("unix:/tmp/sudoku.sock",
+                                            &address));
+    REQUIRE(address.is_unix);
+    REQUIRE(address.path == "/tmp/sudoku.sock");
+
+    REQUIRE(sudoku::ParseLeaderBoardAddress("127.0.0.1:7777", &address));
+    REQUIRE(!address.is_unix);
+    REQUIRE(address.host == "127.0.0.1");
+    REQUIRE(address.port == 7777);
+
+    REQUIRE(!sudoku::ParseLeaderBoardAddress("unix:", &address));
+    REQUIRE(!sudoku::ParseLeaderBoardAddress("localhost", &address));
+    REQUIRE(!sudoku::ParseLeaderBoardAddress("127.0.0.1:70000", &address));
+  }
+}
+
+TEST_CASE("SQLite leaderboard", "[leaderboard]") {
+  const std::string db_path = "test_leaderboard.db";
+  std::remove(db_path.c_str());
+
+  SECTION("Times are ranked") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.BeginBatch();
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"cy", 2000}, "Standard", "Hard");
+    leaderboard.EndBatch();
+
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "bob");
+
+    REQUIRE(leaderboard.RetrieveRank(500, "Standard", "Easy") == 1);
+    REQUIRE(leaderboard.RetrieveRank(1000, "Standard", "Easy") == 2);
+    REQUIRE(leaderboard.RetrieveRank(5000, "Standard", "Easy") == 3);
+    REQUIRE(leaderboard.RetrieveRank(5000, "Standard", "Medium") == 1);
+  }
+
+  SECTION("Players get one profile each") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"ada", 2000}, "Standard", "Hard");
+
+    const int64_t ada = leaderboard.GetPlayerId("ada");
+    REQUIRE(ada != 0);
+    REQUIRE(leaderboard.GetPlayerId("bob") != ada);
+    REQUIRE(leaderboard.GetPlayerName(ada) == "ada");
+    REQUIRE(leaderboard.GetPlayerName(ada + 100).empty());
+
+    // Another connection reads the profiles back from the database
+    sudoku::SqliteLeaderBoard reopened(db_path);
+    REQUIRE(reopened.GetPlayerName(ada) == "ada");
+    REQUIRE(reopened.GetPlayerId("ada") == ada);
+  }
+
+  SECTION("A player's own times") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"bob", 500}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"ada", 1000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"ada", 2000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"ada", 100}, "Standard", "Hard");
+
+    auto best = leaderboard.RetrievePlayerBestTimes("ada", 2, "Standard",
+                                                    "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].time == 1000);
+    REQUIRE(best[1].time == 2000);
+    REQUIRE(best[0].name == "ada");
+
+    auto recent = leaderboard.RetrievePlayerRecentTimes("ada", 10, "Standard",
+                                                        "Easy");
+    REQUIRE(recent.size() == 3);
+    REQUIRE(recent[0].time == 2000);
+    REQUIRE(recent[2].time == 3000);
+
+    REQUIRE(leaderboard.RetrievePlayerBestTimes("cy", 10, "Standard", "Easy")
+            .empty());
+  }
+
+  SECTION("A player's record is kept up to date") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    REQUIRE(leaderboard.RetrievePlayerStats("ada", "Standard", "Easy")
+            .games_played == 0);
+
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"bob", 500}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"ada", 1000}, "Standard", "Easy");
+    auto stats = leaderboard.RetrievePlayerStats("ada", "Standard", "Easy");
+    REQUIRE(stats.games_played == 2);
+    REQUIRE(stats.best_time == 1000);
+    REQUIRE(stats.mean_time == 2000);
+    REQUIRE(stats.recent_median_time == 2000);
+
+    // Only the latest games count towards the recent median
+    for (size_t i = 0; i < sudoku::kRecentGames; i++) {
+      leaderboard.AddTimeToLeaderBoard({"ada", 5000 + i}, "Standard", "Easy");
+    }
+    stats = leaderboard.RetrievePlayerStats("ada", "Standard", "Easy");
+    REQUIRE(stats.games_played == sudoku::kRecentGames + 2);
+    REQUIRE(stats.best_time == 1000);
+    REQUIRE(stats.recent_median_time == 5004);
+    REQUIRE(leaderboard.RetrievePlayerStats("ada", "Standard", "Hard")
+            .games_played == 0);
+  }
+
+  SECTION("Daily and weekly best times") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    const int64_t now = sudoku::GetUnixTime();
+    const int64_t day = 24 * 60 * 60;
+    const auto daily = sudoku::LeaderBoardWindow::kDaily;
+    const auto weekly = sudoku::LeaderBoardWindow::kWeekly;
+
+    leaderboard.AddTimeToLeaderBoard({"ada", 1000, now - 8 * day}, "Standard",
+                                     "Easy");
+    leaderboard.AddTimeToLeaderBoard({"bob", 3000, now}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"cy", 500}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"dee", 2000, now}, "Standard", "Easy");
+
+    // Old and undated times only count towards all time
+    auto best = leaderboard.RetrieveWindowBestTimes(daily, 10, "Standard",
+                                                    "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "dee");
+    REQUIRE(best[0].submitted_at == now);
+    REQUIRE(best[1].name == "bob");
+    REQUIRE(leaderboard.RetrieveWindowBestTimes(weekly, 10, "Standard",
+                                                "Easy").size() == 2);
+    REQUIRE(leaderboard.RetrieveWindowBestTimes(
+        sudoku::LeaderBoardWindow::kAllTime, 10, "Standard", "Easy").size()
+            == 4);
+    REQUIRE(leaderboard.RetrieveWindowBestTimes(daily, 10, "Standard",
+                                                "Hard").empty());
+
+    // Times from a window that's already over aren't let in late
+    leaderboard.AddTimeToLeaderBoard({"ed", 100, now - day}, "Standard",
+                                     "Easy");
+    REQUIRE(leaderboard.RetrieveWindowBestTimes(daily, 10, "Standard",
+                                                "Easy").size() == 2);
+  }
+
+  SECTION("Names read back are shared") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.BeginBatch();
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"ada", 2000}, "Standard", "Easy");
+    leaderboard.EndBatch();
+
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "ada");
+    REQUIRE(best[0].name.IsShared(best[1].name));
+  }
+
+  SECTION("Profiles are still found once the caches are emptied") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.BeginBatch();
+    for (size_t i = 0; i < 10050; i++) {
+      leaderboard.AddTimeToLeaderBoard({"p" + std::to_string(i), 1000 + i},
+                                       "Standard", "Easy");
+    }
+    leaderboard.EndBatch();
+
+    const int64_t first = leaderboard.GetPlayerId("p0");
+    REQUIRE(leaderboard.GetPlayerName(first) == "p0");
+    REQUIRE(leaderboard.GetPlayerId("p10049") != first);
+    REQUIRE(leaderboard.HasTime({"p10049", 11049}, "Standard", "Easy"));
+    REQUIRE(leaderboard.RetrieveBestTimes(1, "Standard", "Easy")[0].name
+            == "p0");
+  }
+
+  SECTION("Profiles from a batch that failed to commit are forgotten") {
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+
+    leaderboard.BeginBatch();
+    leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    const int64_t bob = leaderboard.GetPlayerId("bob");
+    {
+      // A reader in the middle of a transaction keeps the commit out
+      sqlite::database reader(db_path);
+      reader << "begin;";
+      int count = 0;
+      reader << "select count(*) from players;" >> count;
+      REQUIRE_FALSE(leaderboard.EndBatch());
+      reader << "commit;";
+    }
+
+    REQUIRE(leaderboard.GetPlayerName(bob).empty());
+    REQUIRE_FALSE(leaderboard.HasTime({"bob", 1000}, "Standard", "Easy"));
+
+    // The batch was rolled back, so the board can be written to again
+    leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size() == 2);
+  }
+
+  SECTION("Windows are trimmed and expire") {
+    const int64_t now = sudoku::GetUnixTime();
+    const int64_t day = 24 * 60 * 60;
+    const auto daily = sudoku::LeaderBoardWindow::kDaily;
+    auto count_daily_rows = [&db_path] {
+      sqlite::database db(db_path);
+      int rows = 0;
+      db << "select count(*) from window_best where window_kind = 1;" >> rows;
+      return rows;
+    };
+
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    leaderboard.BeginBatch();
+    for (size_t i = 0; i < sudoku::kWindowBestTimes + 20; i++) {
+      leaderboard.AddTimeToLeaderBoard({"ada", 5000 - i, now - day},
+                                       "Standard", "Easy");
+    }
+    leaderboard.EndBatch();
+    REQUIRE(count_daily_rows() == sudoku::kWindowBestTimes);
+
+    // Yesterday's times go once today's first time comes in
+    leaderboard.AddTimeToLeaderBoard({"bob", 9000, now}, "Standard", "Easy");
+    REQUIRE(count_daily_rows() == 1);
+
+    leaderboard.BeginBatch();
+    for (size_t i = 0; i < sudoku::kWindowBestTimes + 20; i++) {
+      leaderboard.AddTimeToLeaderBoard({"ada", 1000 + i, now}, "Standard",
+                                       "Easy");
+    }
+    leaderboard.EndBatch();
+    auto best = leaderboard.RetrieveWindowBestTimes(
+        daily, sudoku::kWindowBestTimes + 50, "Standard", "Easy");
+    REQUIRE(best.size() == sudoku::kWindowBestTimes);
+    REQUIRE(best.front().time == 1000);
+    REQUIRE(best.back().time == 1000 + sudoku::kWindowBestTimes - 1);
+  }
+
+  SECTION("Older databases are brought up to date") {
+    {
+      sqlite::database db(db_path);
+      db << "CREATE TABLE leaderboard (name TEXT NOT NULL, "
+            "time INTEGER NOT NULL, mode TEXT NOT NULL, "
+            "difficulty TEXT NOT NULL);";
+      db << "insert into leaderboard values ('ada', 3, 'Standard', 'Easy');";
+      db << "insert into leaderboard values ('bob', 1, 'Standard', 'Easy');";
+      db << "insert into leaderboard values ('ada', 2, 'Standard', 'Easy');";
+    }
+
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 3);
+    REQUIRE(best[0].name == "bob");
+    REQUIRE(best[0].time == 1000);
+    REQUIRE(best[2].name == "ada");
+    REQUIRE(leaderboard.RetrievePlayerBestTimes("ada", 10, "Standard", "Easy")
+            .size() == 2);
+
+    auto stats = leaderboard.RetrievePlayerStats("ada", "Standard", "Easy");
+    REQUIRE(stats.games_played == 2);
+    REQUIRE(stats.best_time == 2000);
+    REQUIRE(stats.recent_median_time == 2500);
+  }
+
+  SECTION("A failed migration doesn't hold the database") {
+    {
+      sqlite::database db(db_path);
+      db << "CREATE TABLE leaderboard (name TEXT NOT NULL, "
+            "time INTEGER NOT NULL, mode TEXT NOT NULL, "
+            "difficulty TEXT NOT NULL);";
+
+      // In the way of the version 2 step
+      db << "CREATE TABLE leaderboard_by_id (x INTEGER);";
+    }
+
+    sudoku::SqliteLeaderBoard leaderboard(db_path);
+    sqlite::database other(db_path);
+    REQUIRE_NOTHROW(other << "CREATE TABLE probe (x INTEGER);");
+    int tables = 0;
+    other << "select count(*) from sqlite_master where name = 'players';"
+          >> tables;
+    REQUIRE(tables == 0);
+  }
+
+  std::remove(db_path.c_str());
+}
+
+TEST_CASE("Sharded leaderboard", "[leaderboard][shard]") {
+  const std::string db_path = "test_sharded.db";
+  auto remove_files = [&db_path] {
+    std::remove(db_path.c_str());
+    for (const char* mode : sudoku::kLeaderBoardModes) {
+      for (const char* difficulty : sudoku::kLeaderBoardDifficulties) {
+        std::remove(sudoku::ShardedLeaderBoard::GetShardPath(
+            db_path, mode, difficulty).c_str());
+      }
+    }
+  };
+  remove_files();
+
+  SECTION("Shard paths") {
+    using sudoku::ShardedLeaderBoard;
+    REQUIRE(ShardedLeaderBoard::GetShardPath("leaderboard.db", "Time Trial",
+                                             "Easy")
+            == "leaderboard.time_trial.easy.db");
+    REQUIRE(ShardedLeaderBoard::GetShardPath("dir.v2/scores", "Standard",
+                                             "Hard")
+            == "dir.v2/scores.standard.hard");
+  }
+
+  SECTION("Times go to their own shard") {
+    sudoku::ShardedLeaderBoard leaderboard(db_path);
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"cy", 2000}, "Time Trial", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"dee", 500}, "Made Up", "Easy");
+
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "bob");
+    REQUIRE(leaderboard.RetrieveRank(1500, "Time Trial", "Easy") == 1);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Made Up", "Easy").empty());
+
+    // Each shard is a leaderboard of its own
+    sudoku::SqliteLeaderBoard shard(sudoku::ShardedLeaderBoard::GetShardPath(
+        db_path, "Time Trial", "Easy"));
+    REQUIRE(shard.RetrieveBestTimes(10, "Time Trial", "Easy").size() == 1);
+  }
+
+  SECTION("Shards are written to at the same time") {
+    sudoku::ShardedLeaderBoard leaderboard(db_path);
+
+    std::vector<std::thread> threads;
+    for (const char* mode : sudoku::kLeaderBoardModes) {
+      threads.emplace_back([&leaderboard, mode] {
+        for (size_t i = 0; i < 50; i++) {
+          leaderboard.AddTimeToLeaderBoard({"p", 1000 + i}, mode, "Medium");
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (const char* mode : sudoku::kLeaderBoardModes) {
+      REQUIRE(leaderboard.RetrieveRank(5000, mode, "Medium") == 51);
+    }
+  }
+
+  SECTION("Batches cover every shard") {
+    sudoku::ShardedLeaderBoard leaderboard(db_path);
+    leaderboard.BeginBatch();
+    leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Time Attack", "Easy");
+    leaderboard.EndBatch();
+
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size() == 1);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Time Attack", "Easy").size()
+            == 1);
+  }
+
+  SECTION("Unsharded times are moved into the shards") {
+    {
+      sudoku::SqliteLeaderBoard unsharded(db_path);
+      unsharded.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      unsharded.AddTimeToLeaderBoard({"bob", 1000}, "Time Trial", "Hard");
+    }
+
+    {
+      sudoku::ShardedLeaderBoard leaderboard(db_path);
+      REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size()
+              == 1);
+      REQUIRE(leaderboard.RetrieveBestTimes(10, "Time Trial", "Hard").size()
+              == 1);
+    }
+
+    // Opening it again doesn't move them twice
+    sudoku::ShardedLeaderBoard leaderboard(db_path);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size() == 1);
+    sudoku::SqliteLeaderBoard unsharded(db_path);
+    REQUIRE(unsharded.RetrieveBestTimes(10, "Standard", "Easy").empty());
+  }
+
+  SECTION("Times without a shard are left unsharded") {
+    {
+      sudoku::SqliteLeaderBoard unsharded(db_path);
+      unsharded.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      unsharded.AddTimeToLeaderBoard({"bob", 1000}, "Made Up", "Easy");
+    }
+
+    sudoku::ShardedLeaderBoard leaderboard(db_path);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size() == 1);
+
+    sudoku::SqliteLeaderBoard unsharded(db_path);
+    REQUIRE(unsharded.RetrieveBestTimes(10, "Standard", "Easy").empty());
+    REQUIRE(unsharded.RetrieveBestTimes(10, "Made Up", "Easy").size() == 1);
+  }
+
+  SECTION("A move cut short before the delete isn't repeated") {
+    {
+      sudoku::SqliteLeaderBoard unsharded(db_path);
+      unsharded.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      unsharded.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    }
+    {
+      sudoku::ShardedLeaderBoard leaderboard(db_path);
+    }
+
+    // Put the rows back, as if the move stopped after the shards committed
+    {
+      sqlite::database db(db_path);
+      db << "insert into leaderboard (rowid, player_id, time, mode, "
+            "difficulty) values (1, 1, 3000, 'Standard', 'Easy'), "
+            "(2, 2, 1000, 'Standard', 'Easy');";
+    }
+
+    sudoku::ShardedLeaderBoard leaderboard(db_path);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size() == 2);
+    REQUIRE(leaderboard.RetrievePlayerStats("ada", "Standard", "Easy")
+                .games_played == 1);
+
+    sudoku::SqliteLeaderBoard unsharded(db_path);
+    REQUIRE(unsharded.RetrieveBestTimes(10, "Standard", "Easy").empty());
+  }
+
+  remove_files();
+}
+
+TEST_CASE("Leaderboard archive", "[leaderboard][archive]") {
+  const std::string db_path = "test_archive.db";
+  const std::string other_path = "test_archive_other.db";
+  std::remove(db_path.c_str());
+  std::remove(other_path.c_str());
+
+  sudoku::SqliteLeaderBoard leaderboard(db_path);
+  leaderboard.BeginBatch();
+  for (size_t i = 0; i < 2 * sudoku::kArchiveBlockTimes + 10; i++) {
+    leaderboard.AddTimeToLeaderBoard({"p" + std::to_string(i % 50), 1000 + i},
+                                     i % 2 == 0 ? "Standard" : "Time Trial",
+                                     "Easy");
+  }
+  leaderboard.EndBatch();
+
+  std::stringstream archive;
+  REQUIRE(sudoku::ExportLeaderBoard(&leaderboard, &archive)
+          == 2 * sudoku::kArchiveBlockTimes + 10);
+
+  SECTION("Times round trip through an archive") {
+    sudoku::SqliteLeaderBoard other(other_path);
+    REQUIRE(sudoku::ImportLeaderBoard(&archive, &other)
+            == 2 * sudoku::kArchiveBlockTimes + 10);
+
+    auto best = other.RetrieveBestTimes(2, "Time Trial", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "p1");
+    REQUIRE(best[0].time == 1001);
+    REQUIRE(other.RetrievePlayerStats("p0", "Standard", "Easy").games_played
+            == leaderboard.RetrievePlayerStats("p0", "Standard", "Easy")
+               .games_played);
+  }
+
+  SECTION("Importing an archive again adds nothing") {
+    const std::string data = archive.str();
+    const std::string sharded_path = "test_archive_sharded.db";
+    auto remove_shards = [&sharded_path] {
+      std::remove(sharded_path.c_str());
+      for (const char* mode : sudoku::kLeaderBoardModes) {
+        for (const char* difficulty : sudoku::kLeaderBoardDifficulties) {
+          std::remove(sudoku::ShardedLeaderBoard::GetShardPath(
+              sharded_path, mode, difficulty).c_str());
+        }
+      }
+    };
+    remove_shards();
+
+    {
+      sudoku::ShardedLeaderBoard other(sharded_path);
+      std::stringstream first(data);
+      REQUIRE(sudoku::ImportLeaderBoard(&first, &other)
+              == 2 * sudoku::kArchiveBlockTimes + 10);
+
+      std::stringstream second(data);
+      size_t skipped = 0;
+      REQUIRE(sudoku::ImportLeaderBoard(&second, &other, &skipped) == 0);
+      REQUIRE(skipped == 2 * sudoku::kArchiveBlockTimes + 10);
+      REQUIRE(other.RetrieveRank(1000000, "Standard", "Easy")
+              == sudoku::kArchiveBlockTimes + 6);
+      REQUIRE(other.RetrievePlayerStats("p0", "Standard", "Easy").games_played
+              == leaderboard.RetrievePlayerStats("p0", "Standard", "Easy")
+                 .games_played);
+
+      // A time that differs only in when it was submitted is a new one
+      sudoku::Player player("p0", 1000, 1600000000);
+      REQUIRE(!other.HasTime(player, "Standard", "Easy"));
+      player.submitted_at = 0;
+      REQUIRE(other.HasTime(player, "Standard", "Easy"));
+    }
+    remove_shards();
+  }
+
+  SECTION("Submission times are archived") {
+    std::stringstream dated;
+    sudoku::LeaderBoardArchiveWriter writer(&dated);
+    writer.Add({"ada", 1000, 1600000000}, "Standard", "Easy");
+    writer.Add({"bob", 2000}, "Standard", "Easy");
+    REQUIRE(writer.Finish());
+
+    sudoku::LeaderBoardArchiveReader reader(&dated);
+    sudoku::ArchivedTime time{sudoku::Player("", 0), "", ""};
+    REQUIRE(reader.Next(&time));
+    REQUIRE(time.player.submitted_at == 1600000000);
+    REQUIRE(reader.Next(&time));
+    REQUIRE(time.player.submitted_at == 0);
+    REQUIRE(!reader.Next(&time));
+    REQUIRE(!reader.HasFailed());
+  }
+
+  SECTION("Archives are read a block at a time") {
+    sudoku::LeaderBoardArchiveReader reader(&archive);
+    sudoku::ArchivedTime time{sudoku::Player("", 0), "", ""};
+    size_t num_times = 0;
+    while (reader.Next(&time)) {
+      num_times++;
+    }
+    REQUIRE(!reader.HasFailed());
+    REQUIRE(num_times == 2 * sudoku::kArchiveBlockTimes + 10);
+  }
+
+  SECTION("Corrupt archives aren't imported at all") {
+    std::string data = archive.str();
+    data[data.size() - 20] ^= 0x40;
+    std::stringstream corrupt(data);
+
+    sudoku::SqliteLeaderBoard other(other_path);
+    REQUIRE(sudoku::ImportLeaderBoard(&corrupt, &other) == 0);
+    REQUIRE(other.RetrieveBestTimes(10, "Standard", "Easy").empty());
+    REQUIRE(other.GetPlayerName(other.GetPlayerId("p0")) == "p0");
+  }
+
+  SECTION("Truncated archives aren't imported at all") {
+    std::string data = archive.str();
+    data.resize(data.size() - 12);
+    std::stringstream truncated(data);
+
+    sudoku::SqliteLeaderBoard other(other_path);
+    REQUIRE(sudoku::ImportLeaderBoard(&truncated, &other) == 0);
+    REQUIRE(other.RetrieveBestTimes(10, "Standard", "Easy").empty());
+  }
+
+  SECTION("Log leaderboards can be exported") {
+    const std::string log_path = "test_archive.log";
+    std::remove(log_path.c_str());
+    {
+      sudoku::LogLeaderBoard log(log_path);
+      REQUIRE(sudoku::ImportLeaderBoard(&archive, &log)
+              == 2 * sudoku::kArchiveBlockTimes + 10);
+
+      std::stringstream exported;
+      REQUIRE(sudoku::ExportLeaderBoard(&log, &exported)
+              == 2 * sudoku::kArchiveBlockTimes + 10);
+
+      // Importing the same archive again adds nothing
+      size_t num_skipped = 0;
+      archive.clear();
+      archive.seekg(0);
+      REQUIRE(sudoku::ImportLeaderBoard(&archive, &log, &num_skipped) == 0);
+      REQUIRE(num_skipped == 2 * sudoku::kArchiveBlockTimes + 10);
+    }
+    std::remove(log_path.c_str());
+  }
+
+  std::remove(db_path.c_str());
+  std::remove(other_path.c_str());
+}
+
+TEST_CASE("Time skip list", "[leaderboard][skiplist]") {
+  sudoku::TimeSkipList times;
+
+  SECTION("Times are kept fastest first") {
+    std::mt19937 rng(126);
+    std::vector<uint64_t> added;
+    for (size_t i = 0; i < 500; i++) {
+      added.push_back(rng() % 1000);
+      times.Insert(added.back(), "p");
+    }
+    std::sort(added.begin(), added.end());
+
+    auto best = times.GetFirst(added.size() + 1);
+    REQUIRE(best.size() == added.size());
+    REQUIRE(times.GetSize() == added.size());
+    for (size_t i = 0; i < added.size(); i++) {
+      REQUIRE(best[i].time == added[i]);
+    }
+    REQUIRE(times.CountUpTo(added[100]) >= 101);
+    REQUIRE(times.CountUpTo(1000) == added.size());
+    REQUIRE(times.GetFirst(3).size() == 3);
+  }
+
+  SECTION("Equal times stay in the order they were added") {
+    times.Insert(2000, "ada");
+    times.Insert(1000, "bob");
+    times.Insert(2000, "cy");
+    times.Insert(2000, "dee");
+
+    auto best = times.GetFirst(4);
+    REQUIRE(best[0].name == "bob");
+    REQUIRE(best[1].name == "ada");
+    REQUIRE(best[2].name == "cy");
+    REQUIRE(best[3].name == "dee");
+    REQUIRE(times.CountUpTo(1999) == 1);
+    REQUIRE(times.CountUpTo(2000) == 4);
+  }
+
+  SECTION("Times are found by name, time and date") {
+    for (size_t i = 0; i < 200; i++) {
+      times.Insert(1000 + i / 4, "p" + std::to_string(i % 4), 500 + i);
+    }
+
+    REQUIRE(times.GetFirst(1)[0].submitted_at == 500);
+    REQUIRE(times.Contains({"p2", 1010, 542}));
+    REQUIRE_FALSE(times.Contains({"p2", 1010, 543}));
+    REQUIRE_FALSE(times.Contains({"p3", 1010, 542}));
+    REQUIRE_FALSE(times.Contains({"p2", 1011, 542}));
+    REQUIRE_FALSE(times.Contains({"p0", 999, 500}));
+  }
+
+  SECTION("Readers see a sorted list while it's written to") {
+    const size_t kTimes = 20000;
+    std::atomic<bool> is_done{false};
+    std::atomic<bool> is_sorted{true};
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < 2; i++) {
+      readers.emplace_back([&] {
+        while (!is_done) {
+          auto best = times.GetFirst(50);
+          if (!std::is_sorted(best.begin(), best.end(),
+                              [](const sudoku::Player& first,
+                                 const sudoku::Player& second) {
+                                return first.time < second.time;
+                              })) {
+            is_sorted = false;
+          }
+        }
+      });
+    }
+
+    std::mt19937 rng(126);
+    for (size_t i = 0; i < kTimes; i++) {
+      times.Insert(rng() % 100000, "p");
+    }
+    is_done = true;
+    for (auto& reader : readers) {
+      reader.join();
+    }
+
+    REQUIRE(is_sorted);
+    REQUIRE(times.CountUpTo(100000) == kTimes);
+  }
+}
+
+TEST_CASE("Log leaderboard", "[leaderboard][log]") {
+  const std::string log_path = "test_leaderboard.log";
+  std::remove(log_path.c_str());
+
+  SECTION("Times are read back when the log is opened again") {
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path);
+      leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+      leaderboard.AddTimeToLeaderBoard({"cy", 2000}, "Time Trial", "Hard");
+      REQUIRE(leaderboard.RetrieveRank(2000, "Standard", "Easy") == 2);
+    }
+
+    sudoku::LogLeaderBoard leaderboard(log_path);
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "bob");
+    REQUIRE(best[1].time == 3000);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Time Trial", "Hard").size()
+            == 1);
+    REQUIRE(leaderboard.RetrieveBestTimes(10, "Time Trial", "Easy").empty());
+    REQUIRE(leaderboard.RetrieveRank(500, "Made Up", "Easy") == 1);
+  }
+
+  SECTION("A torn record at the end is dropped") {
+    uint64_t good_size;
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path);
+      leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      good_size = leaderboard.GetLogSize();
+      leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    }
+
+    // Cut the last record off partway through
+    std::string data;
+    {
+      std::ifstream file(log_path, std::ios::binary);
+      data.assign(std::istreambuf_iterator<char>(file),
+                  std::istreambuf_iterator<char>());
+    }
+    data.resize(static_cast<size_t>(good_size) + 5);
+    std::ofstream(log_path, std::ios::binary) << data;
+
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path);
+      REQUIRE(leaderboard.GetLogSize() == good_size);
+      REQUIRE(leaderboard.RetrieveBestTimes(10, "Standard", "Easy").size()
+              == 1);
+      leaderboard.AddTimeToLeaderBoard({"cy", 2000}, "Standard", "Easy");
+    }
+
+    // Times added after the bad tail was dropped aren't lost behind it
+    sudoku::LogLeaderBoard leaderboard(log_path);
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "cy");
+  }
+
+  SECTION("A corrupt record and everything after it are dropped") {
+    uint64_t good_size;
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path);
+      leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      good_size = leaderboard.GetLogSize();
+      leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+      leaderboard.AddTimeToLeaderBoard({"cy", 2000}, "Standard", "Easy");
+    }
+
+    {
+      std::fstream file(log_path,
+                        std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(static_cast<std::streamoff>(good_size) + 12);
+      file.put('\x7f');
+    }
+
+    sudoku::LogLeaderBoard leaderboard(log_path);
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 1);
+    REQUIRE(best[0].name == "ada");
+  }
+
+  SECTION("Compaction keeps the best times") {
+    sudoku::LogLeaderBoardOptions options;
+    options.max_times_per_bucket = 3;
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path, options);
+      for (size_t time = 10; time > 0; time--) {
+        leaderboard.AddTimeToLeaderBoard({"p", time * 100}, "Standard",
+                                         "Medium");
+      }
+      const uint64_t size = leaderboard.GetLogSize();
+
+      leaderboard.Compact();
+      REQUIRE(leaderboard.GetLogSize() < size);
+      REQUIRE(leaderboard.RetrieveRank(1000, "Standard", "Medium") == 4);
+      leaderboard.AddTimeToLeaderBoard({"ada", 150}, "Standard", "Medium");
+    }
+
+    // Reopening trims the time added past the limit
+    sudoku::LogLeaderBoard leaderboard(log_path, options);
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Medium");
+    REQUIRE(best.size() == 3);
+    REQUIRE(best[0].time == 100);
+    REQUIRE(best[1].name == "ada");
+    REQUIRE(best[2].time == 200);
+  }
+
+  SECTION("The log is compacted when it's opened, not as times are added") {
+    sudoku::LogLeaderBoardOptions options;
+    options.max_times_per_bucket = 5;
+    uint64_t size = 0;
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path, options);
+      for (size_t i = 0; i < 100; i++) {
+        leaderboard.AddTimeToLeaderBoard({"p", 1000 + i}, "Time Attack",
+                                         "Hard");
+        REQUIRE(leaderboard.GetLogSize() > size);
+        size = leaderboard.GetLogSize();
+      }
+      REQUIRE(leaderboard.RetrieveRank(5000, "Time Attack", "Hard") == 101);
+    }
+
+    sudoku::LogLeaderBoard leaderboard(log_path, options);
+    REQUIRE(leaderboard.GetLogSize() < size);
+    REQUIRE(leaderboard.RetrieveRank(5000, "Time Attack", "Hard") == 6);
+
+    // A log with nothing to trim is left as it is
+    size = leaderboard.GetLogSize();
+    REQUIRE(sudoku::LogLeaderBoard(log_path, options).GetLogSize() == size);
+  }
+
+  SECTION("Batches and synced writes") {
+    sudoku::LogLeaderBoardOptions options;
+    options.sync_every_write = true;
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path, options);
+      leaderboard.BeginBatch();
+      leaderboard.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+      leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+      leaderboard.EndBatch();
+      leaderboard.AddTimeToLeaderBoard({"cy", 2000}, "Standard", "Easy");
+    }
+
+    sudoku::LogLeaderBoard leaderboard(log_path);
+    REQUIRE(leaderboard.RetrieveRank(5000, "Standard", "Easy") == 4);
+  }
+
+  SECTION("Times keep their submission dates") {
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path);
+      leaderboard.AddTimeToLeaderBoard({"ada", 3000, 1700000000}, "Standard",
+                                       "Easy");
+      leaderboard.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+    }
+
+    sudoku::LogLeaderBoard leaderboard(log_path);
+    std::vector<sudoku::Player> listed;
+    REQUIRE(leaderboard.ForEachTime(
+        [&listed](const sudoku::Player& player, const std::string&,
+                  const std::string&) { listed.push_back(player); }));
+    REQUIRE(listed.size() == 2);
+    REQUIRE(listed[0].submitted_at == 0);
+    REQUIRE(listed[1].submitted_at == 1700000000);
+
+    REQUIRE(leaderboard.HasTime({"ada", 3000, 1700000000}, "Standard",
+                                "Easy"));
+    REQUIRE_FALSE(leaderboard.HasTime({"ada", 3000, 1700000001}, "Standard",
+                                      "Easy"));
+    REQUIRE_FALSE(leaderboard.HasTime({"ada", 3000, 1700000000},
+                                      "Time Trial", "Easy"));
+  }
+
+  SECTION("Logs from before times were dated are still read") {
+    // A version 1 log, whose time records have no date
+    auto put_u16 = [](std::string* out, uint32_t value) {
+      out->push_back(static_cast<char>(value & 0xFF));
+      out->push_back(static_cast<char>(value >> 8 & 0xFF));
+    };
+    auto put_record = [&put_u16](std::string* out, const std::string& body) {
+      uint32_t checksum = 2166136261u;
+      for (char c : body) {
+        checksum ^= static_cast<uint8_t>(c);
+        checksum *= 16777619u;
+      }
+      put_u16(out, static_cast<uint32_t>(body.size()));
+      put_u16(out, 0);
+      put_u16(out, checksum & 0xFFFF);
+      put_u16(out, checksum >> 16);
+      out->append(body);
+    };
+    std::string data = "SDKL";
+    put_u16(&data, 1);
+    std::string bucket(1, '\x01');
+    put_u16(&bucket, 0);
+    put_u16(&bucket, 8);
+    bucket += "Standard";
+    put_u16(&bucket, 4);
+    bucket += "Easy";
+    put_record(&data, bucket);
+    std::string time(1, '\x02');
+    put_u16(&time, 0);
+    put_u16(&time, 2500);
+    time.append(6, '\0');
+    put_u16(&time, 3);
+    time += "ada";
+    put_record(&data, time);
+    std::ofstream(log_path, std::ios::binary) << data;
+
+    {
+      sudoku::LogLeaderBoard leaderboard(log_path);
+      auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+      REQUIRE(best.size() == 1);
+      REQUIRE(best[0].name == "ada");
+      REQUIRE(best[0].time == 2500);
+      REQUIRE(best[0].submitted_at == 0);
+      leaderboard.AddTimeToLeaderBoard({"bob", 1000, 1700000000}, "Standard",
+                                       "Easy");
+    }
+
+    // It's been rewritten in the current version, so later times read back
+    sudoku::LogLeaderBoard leaderboard(log_path);
+    auto best = leaderboard.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].submitted_at == 1700000000);
+    REQUIRE(best[1].name == "ada");
+  }
+
+  std::remove(log_path.c_str());
+}
+
+#ifdef __linux__
+TEST_CASE("Leaderboard server", "[leaderboard][server]") {
+  const std::string db_path = "test_server.db";
+  std::remove(db_path.c_str());
+  sudoku::SqliteLeaderBoard leaderboard(db_path);
+
+  sudoku::LeaderBoardAddress address;
+  REQUIRE(sudoku::ParseLeaderBoardAddress("unix:test_server.sock", &address));
+
+  sudoku::LeaderBoardServer server(&leaderboard);
+  REQUIRE(server.Listen(address));
+  std::thread server_thread([&server] { server.Run(); });
+
+  SECTION("Clients share one leaderboard") {
+    sudoku::LeaderBoardClient first(address);
+    sudoku::LeaderBoardClient second(address);
+    REQUIRE(first.IsConnected());
+
+    first.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+    second.AddTimeToLeaderBoard({"bob", 1000}, "Standard", "Easy");
+
+    auto best = first.RetrieveBestTimes(10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "bob");
+    REQUIRE(best[1].name == "ada");
+    REQUIRE(second.RetrieveRank(2000, "Standard", "Easy") == 2);
+
+    auto stats = second.RetrievePlayerStats("ada", "Standard", "Easy");
+    REQUIRE(stats.games_played == 1);
+    REQUIRE(stats.best_time == 3000);
+
+    // The server dates times as they come in
+    best = second.RetrieveWindowBestTimes(sudoku::LeaderBoardWindow::kDaily,
+                                          10, "Standard", "Easy");
+    REQUIRE(best.size() == 2);
+    REQUIRE(best[0].name == "bob");
+  }
+
+  SECTION("Pipelined requests are answered in order") {
+    sudoku::LeaderBoardClient client(address);
+
+    std::vector<sudoku::LeaderBoardRequest> requests;
+    for (size_t i = 0; i < 500; i++) {
+      sudoku::LeaderBoardRequest request;
+      request.op = i % 2 == 0 ? sudoku::LeaderBoardOp::kAddTime
+                              : sudoku::LeaderBoardOp::kRank;
+      request.mode = "Time Trial";
+      request.difficulty = "Medium";
+      request.name = "p" + std::to_string(i);
+      request.time = 1000 * (500 - i);
+      request.limit = 0;
+      requests.push_back(request);
+    }
+
+    std::vector<sudoku::LeaderBoardResponse> responses;
+    REQUIRE(client.SendPipelined(requests, &responses));
+    REQUIRE(responses.size() == requests.size());
+
+    // Each time is faster than every one added before it
+    for (size_t i = 1; i < responses.size(); i += 2) {
+      REQUIRE(responses[i].op == sudoku::LeaderBoardOp::kRank);
+      REQUIRE(responses[i].rank == 1);
+    }
+    REQUIRE(client.RetrieveBestTimes(3, "Time Trial", "Medium").size() == 3);
+  }
+
+  SECTION("Broken clients are disconnected") {
+    sudoku::LeaderBoardClient client(address);
+    REQUIRE(client.RetrieveRank(1, "Standard", "Easy") == 1);
+
+    // A frame too big to be real makes the server hang up
+    sudoku::LeaderBoardClient other(address);
+    std::vector<sudoku::LeaderBoardResponse> responses;
+    sudoku::LeaderBoardRequest request;
+    request.op = sudoku::LeaderBoardOp::kAddTime;
+    request.name = std::string(sudoku::kMaxLeaderBoardFrame, 'x');
+    request.time = 0;
+    request.limit = 0;
+    REQUIRE(!other.SendPipelined({request}, &responses));
+    REQUIRE(!other.IsConnected());
+
+    // Everyone else carries on
+    REQUIRE(client.RetrieveRank(1, "Standard", "Easy") == 1);
+  }
+
+  SECTION("Names that are too long are refused") {
+    sudoku::LeaderBoardClient client(address);
+    std::vector<sudoku::LeaderBoardResponse> responses;
+    sudoku::LeaderBoardRequest request;
+    request.op = sudoku::LeaderBoardOp::kAddTime;
+    request.mode = "Standard";
+    request.difficulty = "Easy";
+    request.name = std::string(sudoku::kMaxLeaderBoardName + 1, 'x');
+    request.time = 1000;
+    request.limit = 0;
+    REQUIRE(client.SendPipelined({request}, &responses));
+    REQUIRE(!responses[0].ok);
+    REQUIRE(client.RetrieveBestTimes(10, "Standard", "Easy").empty());
+  }
+
+  SECTION("Clients that fall behind get every answer") {
+    sudoku::LeaderBoardClient client(address);
+    std::vector<sudoku::LeaderBoardRequest> requests;
+    sudoku::LeaderBoardRequest request;
+    request.mode = "Standard";
+    request.difficulty = "Easy";
+    request.name = std::string(sudoku::kMaxLeaderBoardName, 'x');
+    request.limit = 100;
+    for (size_t i = 0; i < 100; i++) {
+      request.op = sudoku::LeaderBoardOp::kAddTime;
+      request.time = 1000 + i;
+      requests.push_back(request);
+    }
+
+    // Far more answers than the server holds for one client at a time
+    request.op = sudoku::LeaderBoardOp::kBestTimes;
+    requests.insert(requests.end(), 500, request);
+
+    std::vector<sudoku::LeaderBoardResponse> responses;
+    REQUIRE(client.SendPipelined(requests, &responses));
+    REQUIRE(responses.size() == requests.size());
+    REQUIRE(responses.back().players.size() == 100);
+  }
+
+  SECTION("Clients that stop sending are still answered") {
+    sudoku::LeaderBoardRequest request;
+    request.op = sudoku::LeaderBoardOp::kRank;
+    request.time = 1;
+    request.limit = 0;
+    std::string data;
+    sudoku::EncodeRequest(request, &data);
+    sudoku::EncodeRequest(request, &data);
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, address.path.c_str());
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)) == 0);
+    REQUIRE(send(fd, data.data(), data.size(), 0)
+            == static_cast<ssize_t>(data.size()));
+    shutdown(fd, SHUT_WR);
+
+    // Both answers, then the server hangs up
+    std::string received;
+    char buffer[1024];
+    ssize_t count;
+    while ((count = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+      received.append(buffer, static_cast<size_t>(count));
+    }
+    close(fd);
+    REQUIRE(count == 0);
+
+    size_t pos = 0;
+    sudoku::LeaderBoardResponse response;
+    for (size_t i = 0; i < 2; i++) {
+      REQUIRE(sudoku::DecodeResponse(received, &pos, &response)
+              == sudoku::FrameStatus::kComplete);
+      REQUIRE(response.rank == 1);
+    }
+    REQUIRE(pos == received.size());
+  }
+
+  SECTION("Sockets in use aren't taken over") {
+    sudoku::LeaderBoardServer other(&leaderboard);
+    REQUIRE(!other.Listen(address));
+
+    std::ofstream("test_server.txt") << "not a socket";
+    sudoku::LeaderBoardAddress file_address;
+    REQUIRE(sudoku::ParseLeaderBoardAddress("unix:test_server.txt",
+                                            &file_address));
+    REQUIRE(!other.Listen(file_address));
+    REQUIRE(std::ifstream("test_server.txt").good());
+    std::remove("test_server.txt");
+
+    // The server is still reachable
+    sudoku::LeaderBoardClient client(address);
+    REQUIRE(client.IsConnected());
+  }
+
+  server.Stop();
+  server_thread.join();
+  std::remove(db_path.c_str());
+}
+
+TEST_CASE("Leaderboard server over TCP", "[leaderboard][server]") {
+  const std::string db_path = "test_tcp_server.db";
+  std::remove(db_path.c_str());
+  sudoku::SqliteLeaderBoard leaderboard(db_path);
+  sudoku::LeaderBoardServer server(&leaderboard);
+
+  sudoku::LeaderBoardAddress address;
+  REQUIRE(sudoku::ParseLeaderBoardAddress("10.0.0.1:0", &address));
+  REQUIRE(!server.Listen(address));
+
+  REQUIRE(sudoku::ParseLeaderBoardAddress("127.0.0.1:0", &address));
+  REQUIRE(server.Listen(address));
+  REQUIRE(server.GetPort() != 0);
+  std::thread server_thread([&server] { server.Run(); });
+
+  address.port = server.GetPort();
+  sudoku::LeaderBoardClient client(address);
+  client.AddTimeToLeaderBoard({"ada", 3000}, "Standard", "Easy");
+  REQUIRE(client.RetrieveBestTimes(1, "Standard", "Easy")[0].name == "ada");
+
+  server.Stop();
+  server_thread.join();
+  std::remove(db_path.c_str());
+}
+
+TEST_CASE("Leaderboard server with a failing backend",
+          "[leaderboard][server]") {
+  // Takes times, but can be made to fail to save them
+  class FailingLeaderBoard : public sudoku::LeaderBoard {
+   public:
+    void AddTimeToLeaderBoard(const sudoku::Player&, std::string,
+                              std::string) override {}
+    std::vector<sudoku::Player> RetrieveBestTimes(const size_t, std::string,
+                                                  std::string) override {
+      return {};
+    }
+    size_t RetrieveRank(size_t, std::string, std::string) override {
+      return 1;
+    }
+    bool EndBatch() override { return !is_failing; }
+
+    std::atomic<bool> is_failing{true};
+  };
+  FailingLeaderBoard leaderboard;
+
+  sudoku::LeaderBoardAddress address;
+  REQUIRE(sudoku::ParseLeaderBoardAddress("unix:test_failing.sock",
+                                          &address));
+  sudoku::LeaderBoardServer server(&leaderboard);
+  REQUIRE(server.Listen(address));
+  std::thread server_thread([&server] { server.Run(); });
+
+  std::vector<sudoku::LeaderBoardRequest> requests(3);
+  for (size_t i = 0; i < requests.size(); i++) {
+    requests[i].op = i == 1 ? sudoku::LeaderBoardOp::kRank
+                            : sudoku::LeaderBoardOp::kAddTime;
+    requests[i].mode = "Standard";
+    requests[i].difficulty = "Easy";
+    requests[i].name = "ada";
+    requests[i].time = 1000;
+    requests[i].limit = 0;
+  }
+
+  sudoku::LeaderBoardClient client(address);
+  std::vector<sudoku::LeaderBoardResponse> responses;
+  REQUIRE(client.SendPipelined(requests, &responses));
+  REQUIRE(responses.size() == 3);
+  REQUIRE(!responses[0].ok);
+  REQUIRE(responses[1].ok);
+  REQUIRE(responses[1].rank == 1);
+  REQUIRE(!responses[2].ok);
+
+  leaderboard.is_failing = false;
+  REQUIRE(client.SendPipelined(requests, &responses));
+  REQUIRE(responses.size() == 3);
+  REQUIRE(responses[0].ok);
+  REQUIRE(responses[2].ok);
+
+  server.Stop();
+  server_thread.join();
+}
+
+TEST_CASE("Leaderboard client timeout", "[leaderboard][server]") {
+  // A server that takes connections but never answers
+  const std::string path = "test_silent.sock";
+  std::remove(path.c_str());
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, path.c_str());
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  REQUIRE(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+  REQUIRE(listen(fd, 1) == 0);
+
+  sudoku::LeaderBoardAddress address;
+  REQUIRE(sudoku::ParseLeaderBoardAddress("unix:" + path, &address));
+  sudoku::LeaderBoardClient client(address, std::chrono::milliseconds(100));
+  REQUIRE(client.IsConnected());
+
+  const auto start = std::chrono::steady_clock::now();
+  REQUIRE(client.RetrieveBestTimes(10, "Standard", "Easy").empty());
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+  REQUIRE(!client.IsConnected());
+
+  close(fd);
+  std::remove(path.c_str());
+}
+#endif  // __linux__
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+// Solves a file of puzzles, one per line, and reports the throughput.
+//
+//   batch_solve [--single] [--threads N] < puzzles.txt > solutions.txt
+//
+// --single solves the boards one at a time instead of side by side in vector
+// lanes, for comparison. Lines that aren't boards are skipped, and boards
+// with no solution are written back unchanged
+
+#include <sudoku/board.h>
+#include <sudoku/solver.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Solve boards [first, last) of the list. Returns how many were solved
+size_t SolveRange(std::vector<sudoku::Grid>* boards, size_t first,
+                  size_t last, bool is_single) {
+  if (is_single) {
+    size_t num_solved = 0;
+    for (size_t i = first; i < last; i++) {
+      num_solved += sudoku::Solve(&(*boards)[i]) ? 1 : 0;
+    }
+    return num_solved;
+  }
+
+  std::vector<sudoku::Grid> range(boards->begin() + first,
+                                  boards->begin() + last);
+  size_t num_solved = sudoku::SolveBatch(&range);
+  std::copy(range.begin(), range.end(), boards->begin() + first);
+  return num_solved;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bool is_single = false;
+  size_t num_threads = 1;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--single") {
+      is_single = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      num_threads = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+    } else {
+      std::cerr << "usage: batch_solve [--single] [--threads N]"
+                << " < puzzles.txt" << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<sudoku::Grid> boards;
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    sudoku::Grid board;
+    if (sudoku::ParseBoardLine(line, &board)) {
+      boards.push_back(board);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  std::vector<size_t> num_solved(num_threads, 0);
+  size_t per_thread = (boards.size() + num_threads - 1) / num_threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    size_t first = std::min(boards.size(), t * per_thread);
+    size_t last = std::min(boards.size(), first + per_thread);
+    threads.emplace_back([&, t, first, last] {
+      num_solved[t] = SolveRange(&boards, first, last, is_single);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::chrono::duration<double> elapsed
+      = std::chrono::steady_clock::now() - start;
+
+  for (const auto& board : boards) {
+    std::cout << sudoku::FormatBoardLine(board) << '\n';
+  }
+
+  size_t total_solved = 0;
+  for (size_t count : num_solved) {
+    total_solved += count;
+  }
+  std::cerr << "Solved " << total_solved << " of " << boards.size()
+            << " boards in " << elapsed.count() * 1000 << " ms ("
+            << static_cast<double>(boards.size()) / elapsed.count()
+            << " boards/s)" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+// Moves leaderboards between machines in bulk, e.g. to merge several into
+// one. Each archive is imported in a single batch, and skipped whole if
+// it's corrupt. Times already on the leaderboard aren't added again, so
+// importing an archive twice is harmless, and finishes an import whose
+// batch was only saved to some of the shards.
+//
+//   leaderboard_archive export [--db leaderboard.db | --log PATH] ARCHIVE
+//   leaderboard_archive import [--db leaderboard.db | --log PATH] ARCHIVE...
+//
+// The leaderboard is the app's sharded one by default, or the log kept by
+// leaderboard_server --log
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/leaderboard_archive.h>
+#include <sudoku/log_leaderboard.h>
+#include <sudoku/sharded_leaderboard.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "usage: leaderboard_archive export|import"
+            << " [--db leaderboard.db | --log PATH] ARCHIVE..." << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    PrintUsage();
+    return 1;
+  }
+
+  const std::string command = argv[1];
+  std::string db_path = "leaderboard.db";
+  std::string log_path;
+  std::vector<std::string> archive_paths;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--db" && i + 1 < argc) {
+      db_path = argv[++i];
+    } else if (arg == "--log" && i + 1 < argc) {
+      log_path = argv[++i];
+    } else if (arg.compare(0, 2, "--") != 0) {
+      archive_paths.push_back(arg);
+    } else {
+      archive_paths.clear();
+      break;
+    }
+  }
+
+  if ((command != "export" && command != "import") || archive_paths.empty()
+      || (command == "export" && archive_paths.size() != 1)) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::unique_ptr<sudoku::LeaderBoard> leaderboard;
+  if (log_path.empty()) {
+    leaderboard = std::make_unique<sudoku::ShardedLeaderBoard>(db_path);
+  } else {
+    leaderboard = std::make_unique<sudoku::LogLeaderBoard>(log_path);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  size_t num_times = 0;
+  bool is_ok = true;
+  if (command == "export") {
+    std::ofstream out(archive_paths[0], std::ios::binary);
+    num_times = sudoku::ExportLeaderBoard(leaderboard.get(), &out);
+    is_ok = num_times > 0 || static_cast<bool>(out);
+  } else {
+    for (const std::string& path : archive_paths) {
+      std::ifstream in(path, std::ios::binary);
+      size_t skipped = 0;
+      const size_t imported = sudoku::ImportLeaderBoard(&in, leaderboard.get(),
+                                                        &skipped);
+      if (imported == 0 && skipped == 0) {
+        std::cerr << "Nothing imported from " << path << std::endl;
+        is_ok = false;
+      } else if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " times from " << path
+                  << " already on the leaderboard" << std::endl;
+      }
+      num_times += imported;
+    }
+  }
+
+  const std::chrono::duration<double> elapsed
+      = std::chrono::steady_clock::now() - start;
+  std::cerr << command << "ed " << num_times << " times in "
+            << elapsed.count() << " s" << std::endl;
+  return is_ok ? 0 : 1;
+}
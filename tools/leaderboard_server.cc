@@ -0,0 +1,88 @@
+// Copyright (c) 2020 [Your Name]. All rights reserved.
+
+// Serves one leaderboard to every copy of the app pointed at it. The times
+// are kept in a database file per mode and difficulty, named after --db,
+// or with --log in an append-only log that's much faster to add to.
+//
+//   leaderboard_server [--db leaderboard.db | --log leaderboard.log] ADDRESS
+//
+// ADDRESS is unix:PATH for a Unix domain socket, or HOST:PORT for TCP on a
+// loopback address. Runs until interrupted
+
+#include <sudoku/leaderboard.h>
+#include <sudoku/leaderboard_protocol.h>
+#include <sudoku/leaderboard_server.h>
+#include <sudoku/log_leaderboard.h>
+#include <sudoku/sharded_leaderboard.h>
+
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace {
+
+sudoku::LeaderBoardServer* running_server = nullptr;
+
+void StopServer(int) {
+  if (running_server != nullptr) {
+    running_server->Stop();
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string db_path = "leaderboard.db";
+  std::string log_path;
+  std::string address_text;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--db" && i + 1 < argc) {
+      db_path = argv[++i];
+    } else if (arg == "--log" && i + 1 < argc) {
+      log_path = argv[++i];
+    } else if (address_text.empty() && arg.compare(0, 2, "--") != 0) {
+      address_text = arg;
+    } else {
+      address_text.clear();
+      break;
+    }
+  }
+
+  sudoku::LeaderBoardAddress address;
+  if (!sudoku::ParseLeaderBoardAddress(address_text, &address)) {
+    std::cerr << "usage: leaderboard_server"
+              << " [--db leaderboard.db | --log leaderboard.log]"
+              << " unix:PATH | HOST:PORT" << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<sudoku::LeaderBoard> leaderboard;
+  if (log_path.empty()) {
+    leaderboard = std::make_unique<sudoku::ShardedLeaderBoard>(db_path);
+  } else {
+    leaderboard = std::make_unique<sudoku::LogLeaderBoard>(log_path);
+  }
+  sudoku::LeaderBoardServer server(leaderboard.get());
+  if (!server.Listen(address)) {
+    return 1;
+  }
+
+  running_server = &server;
+  std::signal(SIGINT, StopServer);
+  std::signal(SIGTERM, StopServer);
+
+  std::cerr << "Serving " << (log_path.empty() ? db_path : log_path)
+            << " on " << address_text;
+  if (!address.is_unix) {
+    std::cerr << " (port " << server.GetPort() << ")";
+  }
+  std::cerr << std::endl;
+
+  server.Run();
+
+  std::cerr << "Answered " << server.GetRequestCount() << " requests"
+            << std::endl;
+  return 0;
+}